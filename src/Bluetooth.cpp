@@ -1,7 +1,13 @@
 #include "pch.h"
 #include "Bluetooth.h"
 #include "CircularBuffer.h"
+#include "Logger.h"
+#include "Metrics.h"
+#include "Trace.h"
+#include <cstdio>
 #include <ppltasks.h>
+#include <robuffer.h>
+#include <wrl/client.h>
 
 namespace BluetoothLE
 {
@@ -13,6 +19,13 @@ namespace BluetoothLE
 		return isConnected;
 	}
 
+	std::string BLEDevice::DeviceId() const
+	{
+		char id[17];
+		snprintf(id, sizeof(id), "%012llx", (unsigned long long)deviceAddress.load());
+		return id;
+	}
+
 	bool BLEDevice::DataTimeoutExceeded() const
 	{
 		using namespace std::chrono;
@@ -23,11 +36,19 @@ namespace BluetoothLE
 		auto msElapsed = duration_cast<milliseconds>(currentTime - lastReceivedDataTime).count();
 		if (msElapsed < DataTimeoutThresholdMs) return false;
 
-		std::cout << "Have not received data for " << msElapsed << " ms" << std::endl;
+		Logger::Warning("Have not received data for %lld ms", msElapsed);
 
 		return msElapsed >= DataTimeoutDisconnectThresholdMs;
 	}
 
+	void BLEDevice::SetConnectionState(Metrics::ConnectionState state)
+	{
+		std::lock_guard<std::mutex> lock(connectionMetricsMutex);
+		if (state == Metrics::ConnectionState::Connecting) connectionMetrics.connectionAttempts++;
+		connectionMetrics.state = state;
+		Metrics::Publish(Metrics::WriterPage()->connection, connectionMetrics);
+	}
+
 	static void PrintPairingInfo(Bluetooth::BluetoothLEDevice^ bleDevice)
 	{
 		std::cout << "Is paired: " << bleDevice->DeviceInformation->Pairing->IsPaired << std::endl;
@@ -109,14 +130,42 @@ namespace BluetoothLE
 		co_return true;
 	}
 
+	// The notification's own bytes, without a DataReader. Valid while the IBuffer is alive.
+	static const uint8_t* BufferBytes(Windows::Storage::Streams::IBuffer^ value)
+	{
+		Microsoft::WRL::ComPtr<Windows::Storage::Streams::IBufferByteAccess> byteAccess;
+		if (FAILED(reinterpret_cast<IInspectable*>(value)->QueryInterface(IID_PPV_ARGS(&byteAccess)))) return nullptr;
+
+		byte* bytes = nullptr;
+		if (FAILED(byteAccess->Buffer(&bytes))) return nullptr;
+		return bytes;
+	}
+
 	void BLEDevice::OnCharacteristicValueChanged(Bluetooth::GenericAttributeProfile::GattCharacteristic^ sender,
 		Bluetooth::GenericAttributeProfile::GattValueChangedEventArgs^ args)
 	{
-		auto reader = Windows::Storage::Streams::DataReader::FromBuffer(args->CharacteristicValue);
+		auto value = args->CharacteristicValue;
+		auto length = (int)value->Length;
+
+		Trace::Scope scope("Notification");
+		scope.Argument("bytes", length);
+
+		deviceMetrics.notifications++;
+		deviceMetrics.bytesReceived += length;
+		Metrics::Publish(Metrics::WriterPage()->device, deviceMetrics);
 
-		while (reader->UnconsumedBufferLength > 0)
+		auto bytes = BufferBytes(value);
+		if (bytes)
 		{
-			buffer.WriteBuffer(reader->ReadByte());
+			buffer.WriteBuffer(bytes, length);
+		}
+		else
+		{
+			auto reader = Windows::Storage::Streams::DataReader::FromBuffer(value);
+			while (reader->UnconsumedBufferLength > 0)
+			{
+				buffer.WriteBuffer(reader->ReadByte());
+			}
 		}
 
 		lastReceivedDataTime = std::chrono::system_clock::now();
@@ -159,6 +208,7 @@ namespace BluetoothLE
 		case Bluetooth::BluetoothConnectionStatus::Disconnected:
 		{
 			isConnected = false;
+			SetConnectionState(Metrics::ConnectionState::Disconnected);
 			customCharacteristic = nullptr;
 			bleDevice = nullptr;
 			if (Disconnected) Disconnected();
@@ -213,7 +263,7 @@ namespace BluetoothLE
 
 		auto address = eventArgs->BluetoothAddress;
 
-		printf("Received advertisement. Address: %llx\n", address);
+		Logger::Debug("Received advertisement. Address: %llx", address);
 
 		auto serviceUUIDs = eventArgs->Advertisement->ServiceUuids;
 		auto index = 0U;
@@ -223,6 +273,8 @@ namespace BluetoothLE
 		std::cout << "Found device with matching service!" << std::endl;
 
 		watcher->Stop();
+		deviceAddress = address;
+		SetConnectionState(Metrics::ConnectionState::Connecting);
 
 		using namespace Windows::Devices::Enumeration;
 
@@ -262,6 +314,7 @@ namespace BluetoothLE
 		}
 
 		isConnected = true;
+		SetConnectionState(Metrics::ConnectionState::Connected);
 		if (Connected) Connected();
 	}
 
@@ -269,14 +322,37 @@ namespace BluetoothLE
 	{
 		bleWatcher->Stop();
 		bleWatcher->Start();
+		SetConnectionState(Metrics::ConnectionState::Scanning);
 		std::cout << "Watching for BLE device advertisements..." << std::endl;
 	}
 
+	// Queues a write without response to the data characteristic. Delivery is confirmed by the
+	// remote's acknowledgement, not by the GATT layer.
+	bool BLEDevice::Write(const uint8_t* data, size_t length)
+	{
+		using namespace Bluetooth::GenericAttributeProfile;
+
+		auto characteristic = customCharacteristic;
+		if (characteristic == nullptr) return false;
+
+		auto writer = ref new Windows::Storage::Streams::DataWriter();
+		writer->WriteBytes(ref new Platform::Array<uint8_t>(const_cast<uint8_t*>(data), (unsigned int)length));
+
+		concurrency::create_task(characteristic->WriteValueWithResultAsync(writer->DetachBuffer(),
+			GattWriteOption::WriteWithoutResponse)).then([](GattWriteResult^ result) {
+				if (result->Status != GattCommunicationStatus::Success)
+					Logger::Warning("Characteristic write failed with status %lld", (int)result->Status);
+			});
+
+		return true;
+	}
+
 	void BLEDevice::Disconnect()
 	{
 		// TODO: also unsubscribe from callbacks?
 		bleWatcher->Stop();
 		isConnected = false;
+		SetConnectionState(Metrics::ConnectionState::Disconnected);
 		customCharacteristic = nullptr;
 		bleDevice = nullptr;
 	}
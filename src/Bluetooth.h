@@ -2,6 +2,10 @@
 #include "pch.h"
 #include "CircularBuffer.h"
 #include "Main.h"
+#include "Metrics.h"
+#include <atomic>
+#include <mutex>
+#include <string>
 
 namespace BluetoothLE
 {
@@ -22,15 +26,21 @@ namespace BluetoothLE
 
 		unsigned int bleDeviceInitializationTries = 0;
 		bool isConnected;
+		std::atomic<uint64_t> deviceAddress{ 0 };
 
 		std::chrono::time_point<std::chrono::system_clock> lastReceivedDataTime;
 
+		Metrics::DeviceMetrics deviceMetrics{};
+		Metrics::ConnectionMetrics connectionMetrics{};
+		std::mutex connectionMetricsMutex; // connection state changes arrive on several threads
+
 		Bluetooth::Advertisement::BluetoothLEAdvertisementWatcher^ bleWatcher;
 		Bluetooth::BluetoothLEDevice^ bleDevice;
 		Bluetooth::GenericAttributeProfile::GattCharacteristic^ customCharacteristic;
 
 		concurrency::task<bool> InitializeDevice();
 		bool DataTimeoutExceeded() const;
+		void SetConnectionState(Metrics::ConnectionState state);
 
 		void OnAdvertisementReceived(Bluetooth::Advertisement::BluetoothLEAdvertisementWatcher^ watcher,
 			Bluetooth::Advertisement::BluetoothLEAdvertisementReceivedEventArgs^ eventArgs);
@@ -52,7 +62,9 @@ namespace BluetoothLE
 
 		void AttemptConnection();
 		bool IsConnected() const;
+		std::string DeviceId() const; // Bluetooth address of the remote last found, in hex
 		void Disconnect();
+		bool Write(const uint8_t* data, size_t length);
 
 		BLEDevice(unsigned int serviceId, unsigned int characteristicId, const wchar_t* pin);
 	};
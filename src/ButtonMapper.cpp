@@ -0,0 +1,413 @@
+#include "ButtonMapper.h"
+#include "PointerOutput.h"
+#include <cstdlib>
+#include <cstring>
+
+struct KeyName
+{
+	const char* name;
+	uint16_t key;
+};
+
+// Windows virtual key codes, besides letters, digits and function keys
+static const KeyName KeyNames[] = {
+	{ "backspace", 0x08 }, { "tab", 0x09 }, { "enter", 0x0D }, { "escape", 0x1B }, { "space", 0x20 },
+	{ "pageup", 0x21 }, { "pagedown", 0x22 }, { "end", 0x23 }, { "home", 0x24 },
+	{ "left", 0x25 }, { "up", 0x26 }, { "right", 0x27 }, { "down", 0x28 },
+	{ "insert", 0x2D }, { "delete", 0x2E },
+	{ "browserback", 0xA6 }, { "browserforward", 0xA7 },
+	{ "mute", 0xAD }, { "volumedown", 0xAE }, { "volumeup", 0xAF },
+	{ "nexttrack", 0xB0 }, { "previoustrack", 0xB1 }, { "stop", 0xB2 }, { "playpause", 0xB3 },
+};
+
+static const char* const ModifierNames[ButtonMapper::ModifierCount] = { "shift", "ctrl", "alt", "win" };
+
+static const char* const ButtonNames[ButtonMapper::ButtonCount] = { "right", "left", "middle" };
+
+static bool ParseInteger(const std::string& text, int minimum, int maximum, int& result)
+{
+	char* end;
+	auto number = std::strtol(text.c_str(), &end, 10);
+	if (end == text.c_str() || *end != '\0' || number < minimum || number > maximum) return false;
+	result = (int)number;
+	return true;
+}
+
+static bool ParseKeyName(const std::string& name, uint16_t& key)
+{
+	if (name.size() == 1 && ((name[0] >= 'a' && name[0] <= 'z') || (name[0] >= '0' && name[0] <= '9')))
+	{
+		key = (uint16_t)(name[0] >= 'a' ? name[0] - 'a' + 'A' : name[0]);
+		return true;
+	}
+
+	int function;
+	if (name.size() > 1 && name[0] == 'f' && ParseInteger(name.substr(1), 1, 24, function))
+	{
+		key = (uint16_t)(0x70 + function - 1);
+		return true;
+	}
+
+	for (auto& known : KeyNames)
+	{
+		if (name != known.name) continue;
+		key = known.key;
+		return true;
+	}
+	return false;
+}
+
+// [ctrl+][alt+][shift+][win+]<name>
+static bool ParseKey(const std::string& text, ButtonMapper::Action& action)
+{
+	action = { ButtonMapper::ActionType::Key, 0, 0 };
+
+	size_t start = 0;
+	for (auto plus = text.find('+'); plus != std::string::npos; start = plus + 1, plus = text.find('+', start))
+	{
+		auto modifier = text.substr(start, plus - start);
+		auto isKnown = false;
+		for (int i = 0; i < ButtonMapper::ModifierCount; i++)
+		{
+			if (modifier != ModifierNames[i]) continue;
+			action.value |= (uint8_t)(1 << i);
+			isKnown = true;
+		}
+		if (!isKnown) return false;
+	}
+
+	return ParseKeyName(text.substr(start), action.key);
+}
+
+static bool ParseAction(const std::string& value, ButtonMapper::Action& action)
+{
+	using ActionType = ButtonMapper::ActionType;
+
+	auto space = value.find(' ');
+	auto name = value.substr(0, space);
+	auto argument = space == std::string::npos ? "" : value.substr(value.find_first_not_of(' ', space));
+
+	if (argument.empty())
+	{
+		if (name == "none") action = { ActionType::None, 0, 0 };
+		else if (name == "middle_gesture") action = { ActionType::MiddleGesture, 0, 0 };
+		else if (name == "scroll") action = { ActionType::Scroll, 0, 0 };
+		else if (name == "precision") action = { ActionType::Precision, 0, 0 };
+		else return false;
+		return true;
+	}
+
+	if (name == "key") return ParseKey(argument, action);
+
+	if (name == "mouse")
+	{
+		if (argument == "left") action = { ActionType::Mouse, (uint8_t)PointerOutput::MouseButton::Left, 0 };
+		else if (argument == "right") action = { ActionType::Mouse, (uint8_t)PointerOutput::MouseButton::Right, 0 };
+		else if (argument == "middle") action = { ActionType::Mouse, (uint8_t)PointerOutput::MouseButton::Middle, 0 };
+		else return false;
+		return true;
+	}
+
+	int mode;
+	if (name == "mode" && ParseInteger(argument, 0, ButtonMapper::ModeCount - 1, mode))
+	{
+		action = { ActionType::Mode, (uint8_t)mode, 0 };
+		return true;
+	}
+	return false;
+}
+
+// left, right, middle joined by +
+static bool ParseButtons(const std::string& text, uint8_t& buttons)
+{
+	buttons = 0;
+	size_t start = 0;
+	while (true)
+	{
+		auto plus = text.find('+', start);
+		auto name = text.substr(start, plus == std::string::npos ? std::string::npos : plus - start);
+
+		uint8_t bit = 0;
+		for (int i = 0; i < ButtonMapper::ButtonCount; i++)
+		{
+			if (name == ButtonNames[i]) bit = (uint8_t)(1 << i);
+		}
+		if (bit == 0 || (buttons & bit)) return false;
+		buttons |= bit;
+
+		if (plus == std::string::npos) return true;
+		start = plus + 1;
+	}
+}
+
+static int BitCount(uint8_t buttons)
+{
+	int count = 0;
+	for (; buttons != 0; buttons &= (uint8_t)(buttons - 1)) count++;
+	return count;
+}
+
+ButtonMapper::Table ButtonMapper::DefaultTable()
+{
+	Table table{};
+	table.chordWindowMs = DefaultChordWindowMs;
+	table.longPressMs = DefaultLongPressMs;
+	table.entries[0][LeftButton].actions[Press] = { ActionType::Mouse, (uint8_t)PointerOutput::MouseButton::Left, 0 };
+	table.entries[0][RightButton].actions[Press] = { ActionType::Mouse, (uint8_t)PointerOutput::MouseButton::Right, 0 };
+	table.entries[0][MiddleButton].actions[Press] = { ActionType::MiddleGesture, 0, 0 };
+	return table;
+}
+
+bool ButtonMapper::ParseSetting(const std::string& key, const std::string& value, Table& table)
+{
+	if (key == "chord_window_ms") return ParseInteger(value, 0, MaxChordWindowMs, table.chordWindowMs);
+	if (key == "long_press_ms") return ParseInteger(value, 1, MaxLongPressMs, table.longPressMs);
+
+	// [mode<n>.]button.<buttons>[.<gesture>]
+	int mode = 0;
+	auto rest = key;
+	if (rest.compare(0, 4, "mode") == 0)
+	{
+		auto dot = rest.find('.');
+		if (dot == std::string::npos || !ParseInteger(rest.substr(4, dot - 4), 0, ModeCount - 1, mode)) return false;
+		rest = rest.substr(dot + 1);
+	}
+
+	if (rest.compare(0, 7, "button.") != 0) return false;
+	rest = rest.substr(7);
+
+	auto gesture = Press;
+	auto dot = rest.find('.');
+	if (dot != std::string::npos)
+	{
+		auto name = rest.substr(dot + 1);
+		if (name == "tap") gesture = Tap;
+		else if (name == "hold") gesture = Hold;
+		else if (name != "press") return false;
+		rest = rest.substr(0, dot);
+	}
+
+	uint8_t buttons;
+	Action action;
+	if (!ParseButtons(rest, buttons) || !ParseAction(value, action)) return false;
+
+	table.entries[mode][buttons].actions[gesture] = action;
+	return true;
+}
+
+bool ButtonMapper::Compile(Table& table)
+{
+	for (auto& entries : table.entries)
+	{
+		for (int buttons = 1; buttons < MaskCount; buttons++)
+		{
+			auto& actions = entries[buttons].actions;
+			if (actions[Press].type != ActionType::None
+				&& (actions[Tap].type != ActionType::None || actions[Hold].type != ActionType::None)) return false;
+
+			entries[buttons].isChordPrefix = false;
+			for (int chord = 1; chord < MaskCount; chord++)
+			{
+				if (chord == buttons || (chord & buttons) != buttons) continue;
+				for (auto& action : entries[chord].actions)
+				{
+					if (action.type != ActionType::None) entries[buttons].isChordPrefix = true;
+				}
+			}
+		}
+	}
+	return true;
+}
+
+ButtonMapper::ButtonMapper(const Table& table) :
+	table(table)
+{
+}
+
+void ButtonMapper::SetTable(const Table& newTable)
+{
+	table = newTable;
+}
+
+int ButtonMapper::Mode() const
+{
+	return mode;
+}
+
+void ButtonMapper::Emit(const Action& action, bool isActive)
+{
+	if (outputCount < MaxOutputs) outputs[outputCount++] = { action, isActive };
+}
+
+// Held bindings and a latch from a tap add up: the toggle stays on while either holds it
+void ButtonMapper::UpdateToggle(int toggle)
+{
+	auto isActive = toggleHeld[toggle] > 0 || isToggleLatched[toggle];
+	if (isActive == isToggleActive[toggle]) return;
+
+	isToggleActive[toggle] = isActive;
+	Emit({ toggle == 0 ? ActionType::Scroll : ActionType::Precision, 0, 0 }, isActive);
+}
+
+void ButtonMapper::Engage(uint8_t buttons, const Action& action)
+{
+	if (action.type == ActionType::None) return;
+	engaged[engagedCount++] = { buttons, mode, action };
+
+	switch (action.type)
+	{
+	case ActionType::Scroll:
+	case ActionType::Precision:
+	{
+		auto toggle = action.type == ActionType::Scroll ? 0 : 1;
+		toggleHeld[toggle]++;
+		UpdateToggle(toggle);
+		break;
+	}
+	case ActionType::Mode:
+		mode = action.value;
+		break;
+	default:
+		Emit(action, true);
+		break;
+	}
+}
+
+void ButtonMapper::End(const Engaged& binding)
+{
+	switch (binding.action.type)
+	{
+	case ActionType::Scroll:
+	case ActionType::Precision:
+	{
+		auto toggle = binding.action.type == ActionType::Scroll ? 0 : 1;
+		toggleHeld[toggle]--;
+		UpdateToggle(toggle);
+		break;
+	}
+	case ActionType::Mode:
+		mode = binding.previousMode;
+		break;
+	default:
+		Emit(binding.action, false);
+		break;
+	}
+}
+
+void ButtonMapper::Click(const Action& action)
+{
+	switch (action.type)
+	{
+	case ActionType::None:
+		break;
+	case ActionType::Scroll:
+	case ActionType::Precision:
+	{
+		auto toggle = action.type == ActionType::Scroll ? 0 : 1;
+		isToggleLatched[toggle] = !isToggleLatched[toggle];
+		UpdateToggle(toggle);
+		break;
+	}
+	case ActionType::Mode:
+		mode = action.value;
+		break;
+	default:
+		Emit(action, true);
+		Emit(action, false);
+		break;
+	}
+}
+
+// A button of a group that was still deciding went up: a tap, or a press cut short while it
+// waited for a chord, which then still clicks
+void ButtonMapper::Release(const Group& group)
+{
+	auto& entry = table.entries[mode][group.buttons];
+	if (entry.actions[Tap].type != ActionType::None) return Click(entry.actions[Tap]);
+	if (entry.actions[Press].type != ActionType::None) return Click(entry.actions[Press]);
+	if (entry.actions[Hold].type != ActionType::None || BitCount(group.buttons) == 1) return;
+
+	for (uint8_t bit = 1; bit < MaskCount; bit <<= 1)
+	{
+		if (!(group.buttons & bit)) continue;
+		auto& actions = table.entries[mode][bit].actions;
+		Click(actions[Tap].type != ActionType::None ? actions[Tap] : actions[Press]);
+	}
+}
+
+// Returns true once the group no longer waits
+bool ButtonMapper::Decide(const Group& group, int64_t nowMs)
+{
+	auto& entry = table.entries[mode][group.buttons];
+	auto elapsedMs = nowMs - group.sinceMs;
+	if (entry.isChordPrefix && elapsedMs < table.chordWindowMs) return false;
+
+	auto& actions = entry.actions;
+	if (actions[Tap].type != ActionType::None || actions[Hold].type != ActionType::None)
+	{
+		if (elapsedMs < table.longPressMs) return false;
+		Engage(group.buttons, actions[Hold]); // too long for a tap
+		return true;
+	}
+
+	if (actions[Press].type != ActionType::None || BitCount(group.buttons) == 1)
+	{
+		Engage(group.buttons, actions[Press]);
+		return true;
+	}
+
+	for (uint8_t bit = 1; bit < MaskCount; bit <<= 1)
+	{
+		if (group.buttons & bit) Engage(bit, table.entries[mode][bit].actions[Press]);
+	}
+	return true;
+}
+
+int ButtonMapper::Update(uint8_t buttons, int64_t nowMs, Output (&result)[MaxOutputs])
+{
+	buttons &= MaskCount - 1;
+	if (buttons == down && groupCount == 0) return 0;
+
+	outputs = result;
+	outputCount = 0;
+
+	auto released = (uint8_t)(down & ~buttons);
+	auto pressed = (uint8_t)(buttons & ~down);
+	down = buttons;
+
+	// In reverse so that a momentary mode restores the mode it started from
+	for (int i = engagedCount - 1; i >= 0; i--)
+	{
+		if (!(engaged[i].buttons & released)) continue;
+		End(engaged[i]);
+		for (int j = i + 1; j < engagedCount; j++) engaged[j - 1] = engaged[j];
+		engagedCount--;
+	}
+
+	for (int i = 0; i < groupCount; i++)
+	{
+		if (!(groups[i].buttons & released)) continue;
+		Release(groups[i]);
+		for (int j = i + 1; j < groupCount; j++) groups[j - 1] = groups[j];
+		groupCount--;
+		i--;
+	}
+
+	// A press joins the newest group while its chord window is open
+	if (pressed)
+	{
+		if (groupCount > 0 && nowMs - groups[groupCount - 1].sinceMs < table.chordWindowMs) groups[groupCount - 1].buttons |= pressed;
+		else groups[groupCount++] = { pressed, nowMs };
+	}
+
+	for (int i = 0; i < groupCount; i++)
+	{
+		if (!Decide(groups[i], nowMs)) continue;
+		for (int j = i + 1; j < groupCount; j++) groups[j - 1] = groups[j];
+		groupCount--;
+		i--;
+	}
+
+	outputs = nullptr;
+	return outputCount;
+}
@@ -0,0 +1,155 @@
+#pragma once
+#include <cstdint>
+#include <string>
+
+// Maps remote button edges to outputs through a table compiled from the profile. A binding is
+// keyed by mode, the buttons involved and a gesture:
+//   press  starts when the buttons go down and lasts until one of them is released
+//   tap    the buttons are released within LongPressMs
+//   hold   the buttons stay down for LongPressMs, then lasts until one of them is released
+// Bindings of several buttons are chords, which form when all of their buttons go down within
+// ChordWindowMs of the first. Buttons only wait for a chord to form, or for a tap or hold to be
+// told apart, when the table has a binding that needs it, so bindings without chords, taps or
+// holds act on the packet that carries the edge. Buttons pressed together without a chord binding
+// fall back to their own press bindings.
+//
+// Update is a lookup into flat arrays indexed by mode and button mask, with no allocation, strings
+// or callbacks: it fills a fixed array with the outputs to perform. Time comes from the caller,
+// which drives it from the sample clock so that timing follows the packets rather than the thread.
+class ButtonMapper
+{
+public:
+	static constexpr auto ButtonCount = 3;
+	static constexpr auto MaskCount = 1 << ButtonCount;
+	static constexpr auto ModeCount = 4;
+	static constexpr auto MaxOutputs = 16; // per Update
+	static constexpr auto DefaultChordWindowMs = 50;
+	static constexpr auto DefaultLongPressMs = 500;
+	static constexpr auto MaxChordWindowMs = 200;
+	static constexpr auto MaxLongPressMs = 1500; // below Input::IdleTimeoutMs, which stops updates
+
+	// Bits of the button mask, as in the packet
+	static constexpr uint8_t RightButton = 1;
+	static constexpr uint8_t LeftButton = 2;
+	static constexpr uint8_t MiddleButton = 4;
+
+	enum Gesture
+	{
+		Press,
+		Tap,
+		Hold,
+		GestureCount
+	};
+
+	enum class ActionType : uint8_t
+	{
+		None,
+		Mouse, // a mouse button held while active, clicked on a tap
+		Key, // a key and its modifiers held while active, typed on a tap
+		MiddleGesture, // the middle button, which Input turns into scrolling once the remote rolls
+		Scroll, // the remote's roll scrolls and the cursor stays put while active, a tap toggles
+		Precision, // pointer motion is slowed while active, a tap toggles
+		Mode // switches bindings while active, a tap switches until the next mode change
+	};
+
+	// Modifier bits of a key action
+	static constexpr uint8_t ShiftModifier = 1;
+	static constexpr uint8_t ControlModifier = 2;
+	static constexpr uint8_t AltModifier = 4;
+	static constexpr uint8_t WindowsModifier = 8;
+	static constexpr auto ModifierCount = 4;
+
+	struct Action
+	{
+		ActionType type;
+		uint8_t value; // Mouse: PointerOutput::MouseButton, Key: modifier bits, Mode: mode
+		uint16_t key; // Key: Windows virtual key code
+	};
+
+	struct Output
+	{
+		Action action;
+		bool isActive; // down, or the mode turning on
+	};
+
+	struct Entry
+	{
+		Action actions[GestureCount];
+		bool isChordPrefix; // a chord of this mode includes these buttons and more
+	};
+
+	struct Table
+	{
+		Entry entries[ModeCount][MaskCount];
+		int chordWindowMs;
+		int longPressMs;
+	};
+
+	// Left, right and middle as the mouse buttons, the middle one as MiddleGesture
+	static Table DefaultTable();
+
+	// Profile keys, handled at load time. Returns false when key is not a button setting or value
+	// is not valid for it:
+	//   [mode<n>.]button.<buttons>[.press|.tap|.hold] = <action>
+	//     buttons  left, right, middle, joined by + for a chord
+	//     action   mouse left|right|middle, key [ctrl+][alt+][shift+][win+]<name>, middle_gesture,
+	//              scroll, precision, mode <n>, none
+	//   chord_window_ms = 0 .. MaxChordWindowMs
+	//   long_press_ms = 1 .. MaxLongPressMs
+	static bool ParseSetting(const std::string& key, const std::string& value, Table& table);
+
+	// Marks chord prefixes once all bindings are in. Returns false when a press is bound on the
+	// same buttons as a tap or hold, which it would always preempt.
+	static bool Compile(Table& table);
+
+	explicit ButtonMapper(const Table& table);
+
+	// Takes the buttons down in this packet and the sample clock in ms, and returns how many of
+	// outputs were filled. Call it for every packet: held buttons time out into holds.
+	int Update(uint8_t buttons, int64_t nowMs, Output (&outputs)[MaxOutputs]);
+
+	// Bindings already engaged keep their actions until released
+	void SetTable(const Table& table);
+	int Mode() const;
+private:
+	static constexpr auto ToggleCount = 2; // Scroll and Precision
+
+	struct Group
+	{
+		uint8_t buttons;
+		int64_t sinceMs;
+	};
+
+	struct Engaged
+	{
+		uint8_t buttons;
+		uint8_t previousMode;
+		Action action;
+	};
+
+	Table table;
+	uint8_t down = 0;
+	uint8_t mode = 0;
+
+	// Buttons still deciding what they are, in order of their first press
+	Group groups[ButtonCount];
+	int groupCount = 0;
+
+	Engaged engaged[ButtonCount];
+	int engagedCount = 0;
+
+	int toggleHeld[ToggleCount] = {};
+	bool isToggleLatched[ToggleCount] = {};
+	bool isToggleActive[ToggleCount] = {};
+
+	Output* outputs = nullptr;
+	int outputCount = 0;
+
+	void Emit(const Action& action, bool isActive);
+	void UpdateToggle(int toggle);
+	void Engage(uint8_t buttons, const Action& action);
+	void End(const Engaged& binding);
+	void Click(const Action& action);
+	void Release(const Group& group);
+	bool Decide(const Group& group, int64_t nowMs);
+};
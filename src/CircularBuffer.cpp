@@ -1,4 +1,6 @@
+#include <algorithm>
 #include <cstdint>
+#include <cstring>
 #include "CircularBuffer.h"
 
 void CircularBuffer::WriteBuffer(uint8_t byte)
@@ -8,6 +10,26 @@ void CircularBuffer::WriteBuffer(uint8_t byte)
 	if (writeIndex >= BufferLength)	writeIndex = 0;
 }
 
+void CircularBuffer::WriteBuffer(const uint8_t* data, int length)
+{
+	if (length <= 0) return;
+
+	// Only the last BufferLength bytes would survive a byte by byte write
+	if (length > BufferLength)
+	{
+		writeIndex = (writeIndex + length - BufferLength) % BufferLength;
+		data += length - BufferLength;
+		length = BufferLength;
+	}
+
+	auto untilWrap = std::min(length, BufferLength - writeIndex);
+	memcpy(buffer + writeIndex, data, (size_t)untilWrap);
+	memcpy(buffer, data + untilWrap, (size_t)(length - untilWrap));
+
+	writeIndex += length;
+	if (writeIndex >= BufferLength) writeIndex -= BufferLength;
+}
+
 uint8_t CircularBuffer::ReadBuffer()
 {
 	auto byte = buffer[readIndex];
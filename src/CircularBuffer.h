@@ -1,4 +1,5 @@
 #pragma once
+#include <cstdint>
 
 static constexpr auto BufferLength = 256;
 
@@ -10,6 +11,8 @@ private:
 	int writeIndex = 0;
 public:
 	void WriteBuffer(uint8_t byte);
+	// Same result as writing the bytes one at a time, in at most two copies
+	void WriteBuffer(const uint8_t* data, int length);
 	uint8_t ReadBuffer();
 	int BufferCount() const;
 };
\ No newline at end of file
@@ -0,0 +1,127 @@
+#include "ClickStabilizer.h"
+#include <cmath>
+
+ClickStabilizer::ClickStabilizer(const Parameters& parameters) :
+	parameters(parameters)
+{
+}
+
+void ClickStabilizer::SetParameters(const Parameters& newParameters)
+{
+	parameters = newParameters;
+	Reset();
+}
+
+void ClickStabilizer::Reset()
+{
+	historyCount = 0;
+	isHolding = false;
+	heldX = heldY = 0;
+	approachX = approachY = 0;
+	pressX = pressY = 0;
+	lastEdgeMs = -MaxClickMs - 1;
+}
+
+bool ClickStabilizer::IsHolding() const
+{
+	return isHolding;
+}
+
+// Motion recorded after fromMs, up to and including toMs
+void ClickStabilizer::Sum(double fromMs, double toMs, float& x, float& y) const
+{
+	x = y = 0;
+	for (int i = 0; i < historyCount; i++)
+	{
+		auto& sample = history[(historyStart + i) % MaxHistory];
+		if (sample.timeMs <= fromMs || sample.timeMs > toMs) continue;
+		x += sample.dx;
+		y += sample.dy;
+	}
+}
+
+bool ClickStabilizer::IsAlong(float x, float y, float directionX, float directionY)
+{
+	auto length = std::hypot(x, y) * std::hypot(directionX, directionY);
+	return length > 0 && (x * directionX + y * directionY) >= ContinuationCosine * length;
+}
+
+void ClickStabilizer::Record(double nowMs, float dx, float dy)
+{
+	if (historyCount == MaxHistory)
+	{
+		historyStart = (historyStart + 1) % MaxHistory;
+		historyCount--;
+	}
+	history[(historyStart + historyCount) % MaxHistory] = { nowMs, dx, dy };
+	historyCount++;
+}
+
+void ClickStabilizer::Edge(double nowMs, float& undoX, float& undoY)
+{
+	undoX = undoY = 0;
+
+	auto rewindMs = parameters.rewindMs;
+	float recentX, recentY;
+	Sum(nowMs - rewindMs, nowMs, recentX, recentY);
+	Sum(nowMs - rewindMs * (1 + ApproachFactor), nowMs - rewindMs, approachX, approachY);
+	pressX = recentX;
+	pressY = recentY;
+
+	// History starts at the last edge, so a click's release sees just what happened while it was down
+	float sinceX, sinceY;
+	Sum(lastEdgeMs, nowMs, sinceX, sinceY);
+	auto isClick = nowMs - lastEdgeMs <= MaxClickMs && std::hypot(sinceX, sinceY) <= parameters.movePixels;
+
+	// The approach carried on through the rewind window would have moved this far
+	auto expectedX = approachX / ApproachFactor, expectedY = approachY / ApproachFactor;
+	auto recent = std::hypot(recentX, recentY);
+	auto deviation = std::hypot(recentX - expectedX, recentY - expectedY);
+
+	if (rewindMs > 0 && isClick)
+	{
+		undoX = sinceX;
+		undoY = sinceY;
+	}
+	else if (rewindMs > 0 && recent > 0 && recent <= parameters.movePixels && deviation > recent / 2)
+	{
+		undoX = recentX;
+		undoY = recentY;
+	}
+
+	// Motion before this edge has been judged, a later edge only looks at what follows
+	historyCount = 0;
+	lastEdgeMs = nowMs;
+
+	isHolding = parameters.holdMs > 0;
+	holdUntilMs = nowMs + parameters.holdMs;
+	heldX = heldY = 0;
+}
+
+void ClickStabilizer::Filter(double nowMs, float& dx, float& dy)
+{
+	if (isHolding && nowMs >= holdUntilMs)
+	{
+		isHolding = false; // what was held stayed small: the press, not the hand
+	}
+	else if (isHolding)
+	{
+		heldX += dx;
+		heldY += dy;
+		auto threshold = parameters.movePixels;
+		if (IsAlong(heldX, heldY, approachX, approachY)) threshold /= 2;
+		else if (IsAlong(heldX, heldY, pressX, pressY)) threshold *= 2;
+		if (std::hypot(heldX, heldY) > threshold)
+		{
+			dx = heldX;
+			dy = heldY;
+			isHolding = false;
+		}
+		else
+		{
+			dx = dy = 0;
+		}
+	}
+
+	Record(nowMs, dx, dy);
+}
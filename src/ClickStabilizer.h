@@ -0,0 +1,65 @@
+#pragma once
+
+// Keeps the rotation of pressing or releasing a button from moving the cursor off what it was
+// aimed at. At each button edge, cursor motion from the last RewindMs is taken back when it is
+// small and does not continue the motion before it: the thumb pushing the switch, not the hand
+// pointing. An edge within MaxClickMs of the previous one takes back everything since it when that
+// stayed small, so a click releases where it pressed.
+//
+// For HoldMs after the edge, motion is buffered instead of applied; if it adds up to more than
+// MovePixels it was deliberate, a drag or moving on, and is applied at once, otherwise it is
+// dropped. The distance is halved for motion continuing the approach, and doubled for motion
+// continuing what was taken back, which is the press still rotating the remote.
+//
+// Pointing without button edges passes through untouched, so stabilization adds no latency to it.
+// Times are on the caller's sample clock.
+class ClickStabilizer
+{
+public:
+	struct Parameters
+	{
+		float rewindMs; // 0 disables the rewind
+		float holdMs; // 0 disables the hold
+		float movePixels;
+	};
+
+	static constexpr auto MaxHistory = 256; // samples, enough for the windows at 1000 Hz
+	static constexpr auto ApproachFactor = 2.0f; // the approach is measured over this many rewind windows before it
+	static constexpr auto ContinuationCosine = 0.7f; // motion within about 45 degrees of a direction continues it
+	static constexpr auto MaxClickMs = 300.0;
+
+	explicit ClickStabilizer(const Parameters& parameters);
+
+	// At a button edge, before the button is sent. Returns the motion to take back from the cursor.
+	void Edge(double nowMs, float& undoX, float& undoY);
+
+	// For every packet: takes the cursor motion Input would apply and returns what to apply now
+	void Filter(double nowMs, float& dx, float& dy);
+
+	void SetParameters(const Parameters& parameters);
+	void Reset();
+	bool IsHolding() const;
+private:
+	struct Sample
+	{
+		double timeMs;
+		float dx;
+		float dy;
+	};
+
+	Parameters parameters;
+	Sample history[MaxHistory];
+	int historyStart = 0;
+	int historyCount = 0;
+
+	double lastEdgeMs = -MaxClickMs - 1;
+	double holdUntilMs = 0;
+	bool isHolding = false;
+	float heldX = 0, heldY = 0;
+	float approachX = 0, approachY = 0; // direction of travel before the edge, 0 when still
+	float pressX = 0, pressY = 0; // what the edge took back, or would have
+
+	void Sum(double fromMs, double toMs, float& x, float& y) const;
+	static bool IsAlong(float x, float y, float directionX, float directionY);
+	void Record(double nowMs, float dx, float dy);
+};
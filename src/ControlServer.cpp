@@ -0,0 +1,214 @@
+#include "ControlServer.h"
+#include "Logger.h"
+#include <cstdlib>
+
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+ControlServer::ControlServer(CommandHandler handler) : handler(std::move(handler))
+{
+}
+
+ControlServer::~ControlServer()
+{
+	Stop();
+}
+
+bool ControlServer::Consume(const char* data, size_t length, std::string& line, const std::function<bool(const std::string&)>& reply)
+{
+	for (size_t i = 0; i < length; i++)
+	{
+		if (data[i] != '\n')
+		{
+			if (data[i] != '\r') line += data[i];
+			if (line.size() <= MaxCommandLength) continue;
+
+			reply("error command too long\n");
+			return false;
+		}
+
+		auto response = handler ? handler(line) : std::string("error no handler");
+		line.clear();
+		if (!reply(response + "\n")) return false;
+	}
+
+	return true;
+}
+
+#ifdef _WIN32
+std::string ControlServer::EndpointPath()
+{
+	return "\\\\.\\pipe\\GestureBackend";
+}
+
+bool ControlServer::Start()
+{
+	if (isRunning) return true;
+
+	// Rejecting a second first instance detects another running backend
+	pipe = CreateNamedPipeA(EndpointPath().c_str(),
+		PIPE_ACCESS_DUPLEX | FILE_FLAG_FIRST_PIPE_INSTANCE,
+		PIPE_TYPE_BYTE | PIPE_READMODE_BYTE | PIPE_WAIT | PIPE_REJECT_REMOTE_CLIENTS,
+		1, MaxCommandLength, MaxCommandLength, 0, NULL);
+
+	if (pipe == INVALID_HANDLE_VALUE)
+	{
+		Logger::Error("Could not create control pipe: %lld", (long long)GetLastError());
+		pipe = nullptr;
+		return false;
+	}
+
+	isRunning = true;
+	thread = std::thread(&ControlServer::Run, this);
+	return true;
+}
+
+void ControlServer::Run()
+{
+	std::string line;
+	char data[MaxCommandLength];
+
+	while (isRunning)
+	{
+		if (!ConnectNamedPipe(pipe, NULL) && GetLastError() != ERROR_PIPE_CONNECTED)
+		{
+			if (!isRunning) break;
+			continue;
+		}
+
+		line.clear();
+		auto reply = [this](const std::string& response) {
+			DWORD written;
+			return WriteFile(pipe, response.data(), (DWORD)response.size(), &written, NULL) != FALSE;
+		};
+
+		DWORD length;
+		while (isRunning && ReadFile(pipe, data, sizeof(data), &length, NULL) && length > 0)
+		{
+			if (!Consume(data, length, line, reply)) break;
+		}
+
+		FlushFileBuffers(pipe);
+		DisconnectNamedPipe(pipe);
+	}
+}
+
+void ControlServer::Stop()
+{
+	if (!isRunning.exchange(false)) return;
+
+	// Unblock ConnectNamedPipe or ReadFile, whichever the server thread is waiting in
+	CancelSynchronousIo(thread.native_handle());
+	auto wake = CreateFileA(EndpointPath().c_str(), GENERIC_READ | GENERIC_WRITE, 0, NULL, OPEN_EXISTING, 0, NULL);
+	if (wake != INVALID_HANDLE_VALUE) CloseHandle(wake);
+
+	thread.join();
+	CloseHandle(pipe);
+	pipe = nullptr;
+}
+#else
+std::string ControlServer::EndpointPath()
+{
+	if (auto runtimeDirectory = std::getenv("XDG_RUNTIME_DIR"))
+		return std::string(runtimeDirectory) + "/gesture-backend.sock";
+
+	return "/tmp/gesture-backend-" + std::to_string(getuid()) + ".sock";
+}
+
+bool ControlServer::Start()
+{
+	if (isRunning) return true;
+
+	auto path = EndpointPath();
+	sockaddr_un address{};
+	address.sun_family = AF_UNIX;
+	if (path.size() >= sizeof(address.sun_path)) return false;
+	path.copy(address.sun_path, path.size());
+
+	listenSocket = socket(AF_UNIX, SOCK_STREAM, 0);
+	if (listenSocket < 0) return false;
+
+	// A socket file left behind by a crashed backend refuses connections and can be replaced
+	if (connect(listenSocket, (sockaddr*)&address, sizeof(address)) == 0)
+	{
+		Logger::Error("Another backend already owns the control socket");
+		close(listenSocket);
+		listenSocket = -1;
+		return false;
+	}
+	close(listenSocket);
+
+	// Created owner-only rather than narrowed afterwards, so no other user can connect in between.
+	// The umask is process wide, but only makes files created meanwhile more private.
+	unlink(path.c_str());
+	listenSocket = socket(AF_UNIX, SOCK_STREAM, 0);
+	auto previousMask = umask(S_IRWXG | S_IRWXO);
+	auto isBound = listenSocket >= 0 && bind(listenSocket, (sockaddr*)&address, sizeof(address)) == 0;
+	umask(previousMask);
+	if (!isBound || chmod(path.c_str(), S_IRUSR | S_IWUSR) != 0 || listen(listenSocket, 4) != 0)
+	{
+		Logger::Error("Could not create control socket");
+		if (listenSocket >= 0) close(listenSocket);
+		listenSocket = -1;
+		return false;
+	}
+
+	isRunning = true;
+	thread = std::thread(&ControlServer::Run, this);
+	return true;
+}
+
+void ControlServer::Run()
+{
+#ifdef MSG_NOSIGNAL
+	constexpr int SendFlags = MSG_NOSIGNAL; // a client that hung up must not kill the backend
+#else
+	constexpr int SendFlags = 0;
+#endif
+
+	std::string line;
+	char data[MaxCommandLength];
+
+	while (isRunning)
+	{
+		auto client = accept(listenSocket, nullptr, nullptr);
+		if (client < 0) continue;
+
+		clientSocket = client;
+		line.clear();
+		auto reply = [client](const std::string& response) {
+			return send(client, response.data(), response.size(), SendFlags) == (ssize_t)response.size();
+		};
+
+		ssize_t length;
+		while (isRunning && (length = recv(client, data, sizeof(data), 0)) > 0)
+		{
+			if (!Consume(data, (size_t)length, line, reply)) break;
+		}
+
+		clientSocket = -1;
+		close(client);
+	}
+}
+
+void ControlServer::Stop()
+{
+	if (!isRunning.exchange(false)) return;
+
+	// Unblock accept and recv, whichever the server thread is waiting in
+	shutdown(listenSocket, SHUT_RDWR);
+	auto client = clientSocket.load();
+	if (client >= 0) shutdown(client, SHUT_RDWR);
+
+	thread.join();
+	close(listenSocket);
+	listenSocket = -1;
+	unlink(EndpointPath().c_str());
+}
+#endif
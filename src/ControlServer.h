@@ -0,0 +1,40 @@
+#pragma once
+#include <atomic>
+#include <functional>
+#include <string>
+#include <thread>
+
+// Line based local control endpoint: a named pipe on Windows and a UNIX domain socket elsewhere.
+// Each request is one line, answered with one line. Clients are served one at a time on the
+// server's thread.
+class ControlServer
+{
+public:
+	using CommandHandler = std::function<std::string(const std::string& command)>;
+
+	static constexpr auto MaxCommandLength = 256;
+
+	explicit ControlServer(CommandHandler handler);
+	~ControlServer();
+
+	// False when the endpoint cannot be created or another instance already owns it
+	bool Start();
+	void Stop();
+
+	static std::string EndpointPath();
+private:
+	CommandHandler handler;
+	std::thread thread;
+	std::atomic<bool> isRunning{ false };
+
+#ifdef _WIN32
+	void* pipe = nullptr; // HANDLE
+#else
+	int listenSocket = -1;
+	std::atomic<int> clientSocket{ -1 };
+#endif
+
+	void Run();
+	// Feeds received bytes into line and answers every completed line. False closes the connection.
+	bool Consume(const char* data, size_t length, std::string& line, const std::function<bool(const std::string&)>& reply);
+};
@@ -0,0 +1,236 @@
+// Headless entry point: runs the transport, parser and input pipeline without Qt and is driven
+// through ControlServer. Built by GestureDaemon.vcxproj on Windows. On other platforms it runs
+// against SimulatedTransport and a virtual pointer:
+//
+// Linux: g++ -std=c++17 -O2 Daemon.cpp ControlServer.cpp SimulatedTransport.cpp SimulatedRemote.cpp
+//            RemoteControl.cpp PacketParser.cpp CircularBuffer.cpp Input.cpp PointerOutput.cpp IdleDetector.cpp
+//            OrientationFilter.cpp MotionPredictor.cpp GyroHistory.cpp Profiles.cpp ProcessInfo.cpp Logger.cpp
+//            Metrics.cpp NetworkOutput.cpp PacketBroadcast.cpp Trace.cpp PlotFeed.cpp ResponseCurve.cpp Session.cpp
+//            ButtonMapper.cpp ClickStabilizer.cpp Foreground.cpp PipelineSnapshot.cpp Startup.cpp -o GestureDaemon -lrt
+//            -pthread
+//
+// Usage: GestureDaemon [--profile path] [--snapshot path] [--simulate]
+// --snapshot saves what was learned about each remote there, so it also survives a restart.
+// Control: tools/GestureControl.cpp sends connect, disconnect, status, reload-profile,
+//          start-trace, trace, stop-trace, record [path], stop-recording, foreground app or
+//          shutdown. trace writes what was traced since start-trace or while trace_gap_ms is set.
+//          On Windows the foreground application is followed by itself; elsewhere foreground
+//          tells which one it is.
+
+#ifdef _WIN32
+#include "pch.h"
+#include "Bluetooth.h"
+#endif
+#include "ControlServer.h"
+#include "Foreground.h"
+#include "Input.h"
+#include "Logger.h"
+#include "Metrics.h"
+#include "Pipeline.h"
+#include "PipelineSnapshot.h"
+#include "PointerOutput.h"
+#include "ProcessInfo.h"
+#include "Profiles.h"
+#include "RemoteControl.h"
+#include "Session.h"
+#include "SimulatedTransport.h"
+#include "Startup.h"
+#include "Trace.h"
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cstring>
+#include <string>
+#include <thread>
+
+static constexpr uint32_t SimulationSeed = 1;
+
+static std::atomic<bool> isStopping{ false };
+static uint64_t readyMicroseconds = 0;
+
+#ifdef _WIN32
+static BOOL WINAPI OnConsoleControl(DWORD)
+{
+	isStopping = true;
+	return TRUE;
+}
+#else
+static void OnSignal(int)
+{
+	isStopping = true;
+}
+#endif
+
+static std::string Status(bool isConnected, const RemoteControl::Configuration& configuration)
+{
+	Metrics::InputMetrics input{};
+	Metrics::Read(Metrics::WriterPage()->input, input);
+
+	return std::string("ok")
+		+ " connected=" + (isConnected ? "1" : "0")
+		+ " sample_rate_hz=" + std::to_string(configuration.sampleRateHz)
+		+ " gyro_range_dps=" + std::to_string(configuration.gyroRange)
+		+ " format=" + (configuration.packetFormat == PacketFormat::Extended ? "extended" : "standard")
+		+ " packets=" + std::to_string(input.packetsProcessed + input.idlePackets)
+		+ " output=" + (PointerOutput::IsForwarding() ? "forward" : "local")
+		+ " ready_us=" + std::to_string(readyMicroseconds)
+		+ " scan_us=" + std::to_string(Startup::Microseconds(Startup::Milestone::Scan))
+		+ " first_packet_us=" + std::to_string(Startup::Microseconds(Startup::Milestone::FirstPacket))
+		+ " uptime_s=" + std::to_string(ProcessInfo::MicrosecondsSinceStart() / 1000000)
+		+ " resident_kib=" + std::to_string(ProcessInfo::ResidentMemoryKiB());
+}
+
+template <typename Transport>
+static int Run(Transport& transport, const std::string& profilePath)
+{
+	RemoteControl::Controller remoteControl([&transport](const uint8_t* data, size_t length) {
+		return transport.Write(data, length);
+	});
+	Pipeline::Connect(transport, remoteControl);
+	Pipeline::KeepSnapshots(transport, remoteControl);
+
+	// Finding the remote takes longest, so it starts first and the rest comes up meanwhile. The
+	// profile is applied the same way reload-profile applies it to a running pipeline.
+	transport.AttemptConnection();
+	Startup::Reached(Startup::Milestone::Scan);
+
+	Profiles::Profile profile;
+	if (Profiles::Load(profilePath.c_str(), profile)) Profiles::Apply(profile);
+	Foreground::Start(Profiles::SetForegroundApplication);
+
+	Session::Recorder recorder(Pipeline::Packets());
+
+	ControlServer controlServer([&](const std::string& command) -> std::string {
+		if (command == "connect")
+		{
+			if (transport.IsConnected()) return "ok already connected";
+			transport.AttemptConnection();
+			return "ok connecting";
+		}
+		if (command == "disconnect")
+		{
+			transport.Disconnect();
+			return "ok";
+		}
+		if (command == "status")
+		{
+			return Status(transport.IsConnected(), remoteControl.CurrentConfiguration());
+		}
+		if (command == "reload-profile")
+		{
+			Profiles::Profile reloaded;
+			if (!Profiles::Load(profilePath.c_str(), reloaded)) return "error could not load " + profilePath;
+			Profiles::Apply(reloaded);
+			return "ok";
+		}
+		if (command == "start-trace" || command == "stop-trace")
+		{
+			Trace::SetRecording(command == "start-trace");
+			return "ok";
+		}
+		if (command == "trace")
+		{
+			if (!Trace::IsEnabled) return "error not tracing, send start-trace first";
+			if (!Trace::Dump(Trace::DefaultPath)) return "error could not write trace";
+			return std::string("ok ") + Trace::DefaultPath;
+		}
+		if (command == "record" || command.rfind("record ", 0) == 0)
+		{
+			auto path = command == "record" ? std::string(Session::DefaultPath) : command.substr(std::strlen("record "));
+			if (!recorder.Start(path)) return "error could not record to " + path;
+			return "ok " + path;
+		}
+		if (command == "stop-recording")
+		{
+			if (!recorder.IsRecording()) return "error not recording";
+			uint64_t skippedCount;
+			auto sampleCount = recorder.Stop(skippedCount);
+			return "ok samples=" + std::to_string(sampleCount) + " skipped=" + std::to_string(skippedCount);
+		}
+		if (command.rfind("foreground ", 0) == 0)
+		{
+			Foreground::Report(command.substr(std::strlen("foreground ")));
+			return "ok";
+		}
+		if (command == "shutdown")
+		{
+			isStopping = true;
+			return "ok";
+		}
+		return "error unknown command";
+	});
+
+	if (!controlServer.Start())
+	{
+		Foreground::Stop();
+		transport.Disconnect();
+		return 1;
+	}
+
+	readyMicroseconds = ProcessInfo::MicrosecondsSinceStart();
+	Logger::Info("Ready in %lld us, resident %lld KiB", readyMicroseconds, ProcessInfo::ResidentMemoryKiB());
+
+	while (!isStopping)
+	{
+		std::this_thread::sleep_for(std::chrono::milliseconds(RemoteControl::CommandTimeoutMs / 2));
+		remoteControl.CheckTimeouts();
+	}
+
+	controlServer.Stop();
+	Foreground::Stop();
+	transport.Disconnect();
+	return 0;
+}
+
+int main(int argc, char* argv[])
+{
+	std::string profilePath = Profiles::DefaultProfilePath;
+	std::string snapshotPath;
+	bool isSimulated = true;
+#ifdef _WIN32
+	isSimulated = false;
+#endif
+
+	for (int i = 1; i < argc; i++)
+	{
+		if (std::strcmp(argv[i], "--profile") == 0 && i + 1 < argc) profilePath = argv[++i];
+		else if (std::strcmp(argv[i], "--snapshot") == 0 && i + 1 < argc) snapshotPath = argv[++i];
+		else if (std::strcmp(argv[i], "--simulate") == 0) isSimulated = true;
+	}
+
+	Logger::Initialize("GestureDaemon.log");
+	Metrics::WriterPage();
+	Trace::Initialize();
+	Input::Initialize();
+	if (!snapshotPath.empty() && !PipelineSnapshot::Open(snapshotPath.c_str()))
+	{
+		Logger::Warning("Snapshot file is not valid, it will be overwritten");
+	}
+
+#ifdef _WIN32
+	SetConsoleCtrlHandler(OnConsoleControl, TRUE);
+#else
+	std::signal(SIGINT, OnSignal);
+	std::signal(SIGTERM, OnSignal);
+#endif
+
+	int exitCode = 0;
+	if (isSimulated)
+	{
+		SimulatedTransport transport(SimulationSeed);
+		exitCode = Run(transport, profilePath);
+	}
+	else
+	{
+#ifdef _WIN32
+		RoInitialize(RO_INIT_MULTITHREADED);
+		BluetoothLE::BLEDevice transport(0xffe0, 0xffe1, L"802048");
+		exitCode = Run(transport, profilePath);
+#endif
+	}
+
+	Trace::Shutdown();
+	Metrics::ClosePage();
+	Logger::Shutdown();
+	return exitCode;
+}
@@ -0,0 +1,126 @@
+#include "Foreground.h"
+#include "Logger.h"
+#include <cctype>
+#include <mutex>
+
+#ifdef _WIN32
+#include <Windows.h>
+#include <future>
+#include <thread>
+#endif
+
+namespace Foreground
+{
+	static std::mutex reportMutex;
+	static Listener listener;
+	static std::string lastApplication;
+
+	std::string Normalize(const std::string& application)
+	{
+		std::string normalized = application;
+		for (auto& c : normalized) c = (char)std::tolower((unsigned char)c);
+		return normalized;
+	}
+
+	void Report(const std::string& application)
+	{
+		auto normalized = Normalize(application);
+
+		// Held while the listener runs, so reports from different threads arrive in order
+		std::lock_guard<std::mutex> lock(reportMutex);
+		if (normalized == lastApplication) return;
+		lastApplication = normalized;
+		if (listener) listener(normalized);
+	}
+
+	static void SetListener(Listener newListener)
+	{
+		std::lock_guard<std::mutex> lock(reportMutex);
+		listener = std::move(newListener);
+		lastApplication.clear();
+	}
+
+#ifdef _WIN32
+	static std::thread hookThread;
+	static DWORD hookThreadId = 0;
+
+	static void ReportWindow(HWND window)
+	{
+		DWORD processId = 0;
+		GetWindowThreadProcessId(window, &processId);
+		if (processId == 0) return;
+
+		auto process = OpenProcess(PROCESS_QUERY_LIMITED_INFORMATION, FALSE, processId);
+		if (!process) return; // elevated or already gone
+
+		wchar_t path[MAX_PATH];
+		DWORD length = MAX_PATH;
+		auto isNamed = QueryFullProcessImageNameW(process, 0, path, &length);
+		CloseHandle(process);
+		if (!isNamed) return;
+
+		auto name = wcsrchr(path, L'\\');
+		char utf8[MAX_PATH * 3];
+		if (WideCharToMultiByte(CP_UTF8, 0, name ? name + 1 : path, -1, utf8, sizeof(utf8), nullptr, nullptr) <= 0) return;
+		Report(utf8);
+	}
+
+	static void CALLBACK OnForegroundChanged(HWINEVENTHOOK, DWORD, HWND window, LONG objectId, LONG, DWORD, DWORD)
+	{
+		if (objectId == OBJID_WINDOW) ReportWindow(window);
+	}
+
+	bool Start(Listener newListener)
+	{
+		if (hookThread.joinable()) return false;
+		SetListener(std::move(newListener));
+
+		// Out-of-context hooks are delivered through the message loop of the thread that set them
+		std::promise<bool> started;
+		auto isStarted = started.get_future();
+		hookThread = std::thread([&started] {
+			MSG message;
+			PeekMessage(&message, nullptr, WM_USER, WM_USER, PM_NOREMOVE); // creates the queue Stop posts to
+			hookThreadId = GetCurrentThreadId();
+
+			auto hook = SetWinEventHook(EVENT_SYSTEM_FOREGROUND, EVENT_SYSTEM_FOREGROUND, nullptr, OnForegroundChanged,
+				0, 0, WINEVENT_OUTOFCONTEXT | WINEVENT_SKIPOWNPROCESS);
+			started.set_value(hook != nullptr);
+			if (!hook) return;
+
+			ReportWindow(GetForegroundWindow());
+			while (GetMessage(&message, nullptr, 0, 0) > 0)
+			{
+				TranslateMessage(&message);
+				DispatchMessage(&message);
+			}
+			UnhookWinEvent(hook);
+		});
+
+		if (isStarted.get()) return true;
+
+		hookThread.join();
+		Logger::Error("Could not hook foreground changes, per-application profiles stay on the base profile");
+		return false;
+	}
+
+	void Stop()
+	{
+		if (!hookThread.joinable()) return;
+		PostThreadMessage(hookThreadId, WM_QUIT, 0, 0);
+		hookThread.join();
+		SetListener(nullptr);
+	}
+#else
+	bool Start(Listener newListener)
+	{
+		SetListener(std::move(newListener));
+		return true;
+	}
+
+	void Stop()
+	{
+		SetListener(nullptr);
+	}
+#endif
+}
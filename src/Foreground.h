@@ -0,0 +1,21 @@
+#pragma once
+#include <functional>
+#include <string>
+
+// Reports which application is in the foreground, by its executable file name in lower case, such
+// as "firefox.exe". On Windows a WinEvent hook on its own thread reports each foreground change as
+// it happens. Elsewhere nothing is built in: whoever knows, such as the daemon's foreground
+// command or a test, calls Report.
+namespace Foreground
+{
+	using Listener = std::function<void(const std::string& application)>;
+
+	// The listener runs on the provider's thread, first with the current application
+	bool Start(Listener listener);
+	void Stop();
+
+	// Any thread. Lower-cases application and passes it on when it differs from the last one.
+	void Report(const std::string& application);
+
+	std::string Normalize(const std::string& application);
+}
@@ -0,0 +1,95 @@
+#include "GyroHistory.h"
+#include <algorithm>
+
+GyroHistory::GyroHistory(int windowLength) :
+	windowLength(std::clamp(windowLength, 1, Capacity))
+{
+	Clear();
+}
+
+void GyroHistory::Clear()
+{
+	pushedCount = 0;
+	storedCount = 0;
+	blockPosition = 0;
+	hasPreviousBlock = false;
+}
+
+// The block that just filled up becomes the previous block. Runs once every windowLength pushes.
+void GyroHistory::CompleteBlock()
+{
+	for (int axis = 0; axis < AxisCount; axis++)
+	{
+		auto block = Latest(axis, windowLength);
+		auto minimum = block[windowLength - 1];
+		auto maximum = minimum;
+
+		for (int i = windowLength - 1; i >= 0; i--)
+		{
+			minimum = std::min(minimum, block[i]);
+			maximum = std::max(maximum, block[i]);
+			suffixMin[axis][i] = minimum;
+			suffixMax[axis][i] = maximum;
+		}
+	}
+
+	blockPosition = 0;
+	hasPreviousBlock = true;
+}
+
+void GyroHistory::Push(Vector3Int16 gyro)
+{
+	if (blockPosition == windowLength) CompleteBlock();
+
+	auto slot = pushedCount & IndexMask;
+	int16_t values[AxisCount] = { gyro.X, gyro.Y, gyro.Z };
+
+	for (int axis = 0; axis < AxisCount; axis++)
+	{
+		auto value = values[axis];
+		samples[axis][slot] = value;
+		samples[axis][slot + Capacity] = value;
+
+		prefixMin[axis] = blockPosition == 0 ? value : std::min(prefixMin[axis], value);
+		prefixMax[axis] = blockPosition == 0 ? value : std::max(prefixMax[axis], value);
+	}
+
+	blockPosition++;
+	pushedCount++;
+	if (storedCount < Capacity) storedCount++;
+}
+
+int GyroHistory::WindowLength() const
+{
+	return windowLength;
+}
+
+int GyroHistory::StoredCount() const
+{
+	return storedCount;
+}
+
+int GyroHistory::Count() const
+{
+	return std::min(StoredCount(), windowLength);
+}
+
+// The window holds the current block and, unless that block is full, the tail of the previous one
+int16_t GyroHistory::Min(int axis) const
+{
+	if (blockPosition == 0) return 0;
+	if (!hasPreviousBlock || blockPosition == windowLength) return prefixMin[axis];
+	return std::min(prefixMin[axis], suffixMin[axis][blockPosition]);
+}
+
+int16_t GyroHistory::Max(int axis) const
+{
+	if (blockPosition == 0) return 0;
+	if (!hasPreviousBlock || blockPosition == windowLength) return prefixMax[axis];
+	return std::max(prefixMax[axis], suffixMax[axis][blockPosition]);
+}
+
+const int16_t* GyroHistory::Latest(int axis, int count) const
+{
+	return &samples[axis][(pushedCount - (uint32_t)count) & IndexMask];
+}
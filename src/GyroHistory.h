@@ -0,0 +1,52 @@
+#pragma once
+#include "Packet.h"
+#include <cstdint>
+
+// Fixed-capacity history of raw gyro samples, stored as one int16 array per axis.
+// Every sample is written twice, Capacity apart, so the latest n samples are always contiguous
+// and can be handed to vectorised consumers without copying.
+//
+// Min and max over the last WindowLength() samples are O(1) queries, using the van Herk/Gil-Werman
+// split: the stream is cut into blocks of WindowLength() samples, and a window is the suffix of the
+// previous block plus the prefix of the current one. Suffix extremes are computed once per
+// completed block, which costs O(WindowLength()), so Push is amortized O(1): one push in
+// WindowLength() completes a block, and the others do no data dependent branching.
+class GyroHistory
+{
+public:
+	static constexpr auto Capacity = 256; // must be a power of two
+	static constexpr auto AxisCount = 3;
+
+	explicit GyroHistory(int windowLength); // clamped to 1..Capacity
+
+	void Push(Vector3Int16 gyro);
+	void Clear();
+
+	int WindowLength() const;
+	int Count() const; // samples currently in the window
+
+	int16_t Min(int axis) const;
+	int16_t Max(int axis) const;
+
+	// Oldest first. count must not exceed the number of stored samples or Capacity.
+	const int16_t* Latest(int axis, int count) const;
+	int StoredCount() const;
+private:
+	static constexpr uint32_t IndexMask = Capacity - 1;
+	static_assert((Capacity & IndexMask) == 0, "Capacity must be a power of two");
+
+	alignas(64) int16_t samples[AxisCount][2 * Capacity];
+
+	alignas(64) int16_t suffixMin[AxisCount][Capacity]; // over the previous block, from each position to its end
+	alignas(64) int16_t suffixMax[AxisCount][Capacity];
+	int16_t prefixMin[AxisCount]; // over the current block so far
+	int16_t prefixMax[AxisCount];
+	int blockPosition; // samples in the current block
+	bool hasPreviousBlock;
+
+	uint32_t pushedCount; // wraps, only differences are meaningful
+	int storedCount;
+	int windowLength;
+
+	void CompleteBlock();
+};
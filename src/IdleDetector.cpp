@@ -0,0 +1,51 @@
+#include "IdleDetector.h"
+#include <cstdlib>
+
+IdleDetector::IdleDetector(Vector3Int16 thresholds, int timeoutMs) :
+	thresholds(thresholds),
+	timeoutSeconds(timeoutMs / 1000.0f)
+{
+}
+
+// Integer-only check, cheap enough to run on every packet while idle
+bool IdleDetector::IsActive(const Packet& packet) const
+{
+	return packet.ButtonData != previousButtonData
+		|| std::abs(packet.Gyro.X) >= thresholds.X
+		|| std::abs(packet.Gyro.Y) >= thresholds.Y
+		|| std::abs(packet.Gyro.Z) >= thresholds.Z;
+}
+
+// Returns true when the packet needs full processing. The packet that ends an idle period
+// is always processed, so waking up never costs an extra packet of latency. interval is the
+// time the packet stands for, dropped samples before it included.
+bool IdleDetector::Update(const Packet& packet, float interval)
+{
+	auto isActive = IsActive(packet);
+	previousButtonData = packet.ButtonData;
+
+	if (isActive)
+	{
+		isIdle = false;
+		stillSeconds = 0;
+		return true;
+	}
+
+	if (isIdle) return false;
+
+	// Still, but not for long enough yet
+	stillSeconds += interval;
+	if (stillSeconds >= timeoutSeconds) isIdle = true;
+
+	return !isIdle;
+}
+
+bool IdleDetector::IsIdle() const
+{
+	return isIdle;
+}
+
+void IdleDetector::SetThresholds(Vector3Int16 stillThresholds)
+{
+	thresholds = stillThresholds;
+}
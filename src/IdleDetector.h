@@ -0,0 +1,22 @@
+#pragma once
+#include "Packet.h"
+
+// Detects when the remote is at rest so that the input pipeline can skip per-packet work.
+// A packet is still when every gyro axis is below its threshold and the buttons did not change.
+// Time is counted on the sample clock, the intervals the packets stand for, so no clock is read.
+class IdleDetector
+{
+private:
+	Vector3Int16 thresholds;
+	float timeoutSeconds;
+	float stillSeconds = 0; // since the last active packet
+	uint8_t previousButtonData = 0;
+	bool isIdle = false;
+public:
+	IdleDetector(Vector3Int16 thresholds, int timeoutMs);
+
+	bool IsActive(const Packet& packet) const;
+	bool Update(const Packet& packet, float interval);
+	bool IsIdle() const;
+	void SetThresholds(Vector3Int16 stillThresholds);
+};
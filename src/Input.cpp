@@ -1,19 +1,67 @@
-#include "pch.h"
 #include "Input.h"
+#include "Metrics.h"
+#include "GyroHistory.h"
+#include "IdleDetector.h"
+#include "OrientationFilter.h"
+#include "MotionPredictor.h"
+#include "Trace.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdlib>
 
 namespace Input
 {
-	static INPUT input;
-	static POINT cursor;
+	using PointerOutput::MouseButton;
 
 	static int screenWidth;
 	static int screenHeight;
 
 	static float mouseX = 0;
 	static float mouseY = 0;
-	static uint8_t previousButtonData;
+	static uint8_t previousButtonData = 0;
 
 	static MiddleMouseAction middleMouseAction = MiddleMouseAction::Undetermined;
+	static float scrollRemainder = 0; // scroll steps are whole, so each sample's fraction carries into the next
+	static bool isScrollMode = false;
+	static bool isPrecise = false;
+
+	static Metrics::InputMetrics metrics;
+
+	// Written by whoever learns the negotiated range, applied by the packet thread
+	static std::atomic<float> degreeRange = DefaultDegreeRange;
+	static float appliedDegreeRange = DefaultDegreeRange;
+
+	static std::atomic<float> sampleRate = (float)RemoteControl::DefaultSampleRateHz;
+	static int skippedSamples = 0; // packet thread only
+	static double sampleClockMs = 0; // sum of the intervals taken, times button gestures
+	static std::atomic<PointingMode> pointingMode = PointingMode::Relative;
+	static PointingMode appliedPointingMode = PointingMode::Relative;
+
+	static std::atomic<float> predictionLatency = DefaultPredictionLatencyMs;
+	static float appliedPredictionLatency = DefaultPredictionLatencyMs;
+	static MotionPredictor motionPredictor(DefaultPredictionLatencyMs);
+
+	// Set from any thread and picked up by the packet thread, which copies what it uses when the pointer changes
+	static const Tuning defaultTuning = DefaultTuning();
+	static std::atomic<const Tuning*> tuning{ &defaultTuning };
+	static std::atomic<const Tuning*> appliedTuning{ &defaultTuning }; // written by the packet thread only
+	static std::atomic<const Tuning*> applyingTuning{ nullptr }; // while the packet thread copies it
+	static ResponseCurve::Parameters responseCurve = DefaultResponseCurve;
+	static ButtonMapper buttonMapper(defaultTuning.buttons);
+	static ClickStabilizer clickStabilizer(DefaultClickStabilization);
+
+	static OrientationFilter orientationFilter(FusionBeta);
+	static float referenceYaw = 0;
+	static float referencePitch = 0;
+
+	static RemoteControl::UsageMode requestedUsageMode = RemoteControl::UsageMode::Normal;
+	static int usageModeWindowCount = 0;
+	static GyroHistory gyroHistory(UsageModeWindowPackets);
+
+	static PlotFeed plotFeed;
+
+	std::function<void(RemoteControl::UsageMode)> UsageModeRequested;
 
 	static Vector3 ToVector3(Vector3Int16 v, float range)
 	{
@@ -24,137 +72,352 @@ namespace Input
 		};
 	}
 
-	void Initialize()
+	// Smallest raw gyro value that survives the dead zone once scaled by range
+	static constexpr int16_t RawDeadZone(float deadZone, float range)
 	{
-		GetCursorPos(&cursor);
-		mouseX = (float)cursor.x;
-		mouseY = (float)cursor.y;
+		auto scaled = deadZone * INT16_MAX / range;
+		auto truncated = (int16_t)scaled;
+		return truncated < scaled ? (int16_t)(truncated + 1) : truncated;
+	}
 
-		HDC primary = GetDC(NULL);
-		screenWidth = GetDeviceCaps(primary, HORZRES) - 1;
-		screenHeight = GetDeviceCaps(primary, VERTRES) - 1;
-		ReleaseDC(NULL, primary);
+	// Axes as used by HandlePacket: X moves the cursor vertically, Y scrolls, Z moves horizontally
+	static constexpr Vector3Int16 StillThresholds(const ResponseCurve::Parameters& curve, float range)
+	{
+		return {
+			RawDeadZone(curve.mouseDeadZone, range),
+			RawDeadZone(curve.scrollDeadZone, range),
+			RawDeadZone(curve.mouseDeadZone, range)
+		};
+	}
 
-		MOUSEINPUT mouseInput{};
-		mouseInput.dx = 0;
-		mouseInput.dy = 0;
-		mouseInput.time = 0;
-		mouseInput.mouseData = 0;
-		mouseInput.dwExtraInfo = NULL;
+	static IdleDetector idleDetector(StillThresholds(DefaultResponseCurve, DefaultDegreeRange), IdleTimeoutMs);
+	static constexpr auto IdlePublishPackets = 128; // idle packets counted between publishing metrics
 
-		input.type = INPUT_MOUSE;
-		input.mi = mouseInput;
+	void SetDegreeRange(float range)
+	{
+		degreeRange.store(range, std::memory_order_relaxed);
 	}
 
-	static void SendMouseInput()
+	void SetSampleRate(float sampleRateHz)
 	{
-		UINT numEvents = SendInput(1, &input, sizeof(input));
-		if (numEvents == 0)
-		{
-			std::cout << "SendMouse failed: " << HRESULT_FROM_WIN32(GetLastError()) << std::endl;
-		}
+		sampleRate.store(sampleRateHz, std::memory_order_relaxed);
 	}
 
-	void Scroll(int scrollAmount)
+	void SetPointingMode(PointingMode mode)
 	{
-		input.mi.dx = 0;
-		input.mi.dy = 0;
-		input.mi.dwFlags = MOUSEEVENTF_WHEEL;
-		input.mi.mouseData = (DWORD)scrollAmount;
-		SendMouseInput();
+		pointingMode.store(mode, std::memory_order_relaxed);
 	}
 
-	// Moves the mouse to the position (mouseX, mouseY)
-	void MouseMove()
+	void SkipSamples(int count)
 	{
-		input.mi.dx = (int)round(mouseX * 0xffff / (float)screenWidth);
-		input.mi.dy = (int)round(mouseY * 0xffff / (float)screenHeight);
-		input.mi.dwFlags = MOUSEEVENTF_MOVE | MOUSEEVENTF_ABSOLUTE | MOUSEEVENTF_MOVE_NOCOALESCE;
-		input.mi.mouseData = 0;
-		SendMouseInput();
+		skippedSamples += count;
 	}
 
-	void MouseClick(int flags)
+	// Time the next packet stands for: its own sample period plus those of any dropped before it
+	static float TakeSampleInterval()
 	{
-		input.mi.dx = 0;
-		input.mi.dy = 0;
-		input.mi.dwFlags = (DWORD)flags;
-		input.mi.mouseData = 0;
-		SendMouseInput();
+		auto interval = (1 + skippedSamples) / sampleRate.load(std::memory_order_relaxed);
+		skippedSamples = 0;
+		sampleClockMs += interval * 1000.0;
+		return interval;
 	}
 
-	// Handles mouse input (click, move, and scroll)
-	void ProcessPacket(Packet packet)
+	void SetPredictionLatency(float latencyMs)
+	{
+		predictionLatency.store(latencyMs, std::memory_order_relaxed);
+	}
+
+	Tuning DefaultTuning()
+	{
+		return { DefaultResponseCurve, ButtonMapper::DefaultTable(), DefaultClickStabilization };
+	}
+
+	// Sequentially consistent, like the packet thread's side in ApplyTuning: either the caller's
+	// next IsTuningInUse sees the packet thread reading the old block, or the packet thread sees
+	// the new one and leaves the old alone
+	void SetTuning(const Tuning* newTuning)
+	{
+		tuning.store(newTuning);
+	}
+
+	// applyingTuning first: the packet thread sets appliedTuning before clearing it
+	bool IsTuningInUse(const Tuning* candidate)
+	{
+		return applyingTuning.load() == candidate || appliedTuning.load() == candidate;
+	}
+
+	static void ApplyPredictionLatency()
+	{
+		auto latency = predictionLatency.load(std::memory_order_relaxed);
+		if (latency == appliedPredictionLatency) return;
+
+		appliedPredictionLatency = latency;
+		motionPredictor.SetLatency(latency);
+		motionPredictor.Reset();
+	}
+
+	static void ApplyDegreeRange()
+	{
+		auto range = degreeRange.load(std::memory_order_relaxed);
+		if (range == appliedDegreeRange) return;
+
+		appliedDegreeRange = range;
+		idleDetector.SetThresholds(StillThresholds(responseCurve, range));
+	}
+
+	// Bindings already engaged keep their actions until released; click stabilization starts over
+	static void ApplyTuning()
+	{
+		auto next = tuning.load(std::memory_order_acquire);
+		if (next == appliedTuning.load(std::memory_order_relaxed)) return;
+
+		// Announces the read, then makes sure next was not replaced, and maybe freed, in between.
+		// If it was, the current block is picked up with the next packet.
+		applyingTuning.store(next);
+		if (tuning.load() != next)
+		{
+			applyingTuning.store(nullptr);
+			return;
+		}
+
+		responseCurve = next->responseCurve;
+		idleDetector.SetThresholds(StillThresholds(responseCurve, appliedDegreeRange));
+		buttonMapper.SetTable(next->buttons);
+		clickStabilizer.SetParameters(next->clickStabilization);
+
+		appliedTuning.store(next);
+		applyingTuning.store(nullptr, std::memory_order_release);
+	}
+
+	// Largest raw magnitude on any axis since the window was last cleared
+	static int WindowPeak()
+	{
+		int peak = 0;
+		for (int axis = 0; axis < GyroHistory::AxisCount; axis++)
+		{
+			peak = std::max({ peak, std::abs((int)gyroHistory.Min(axis)), std::abs((int)gyroHistory.Max(axis)) });
+		}
+		return peak;
+	}
+
+	static void RequestUsageMode(RemoteControl::UsageMode mode)
+	{
+		requestedUsageMode = mode;
+		if (UsageModeRequested) UsageModeRequested(mode);
+	}
+
+	// Widens the gyro range as soon as a sample saturates, and narrows it once a whole
+	// window of motion would have fit in a narrower range, for finer pointing resolution
+	static void EvaluateUsageMode(Vector3Int16 raw, float range)
 	{
-		auto gyro = ToVector3(packet.Gyro, DegreeRange);
+		using RemoteControl::UsageMode;
+
+		if (RemoteControl::UsageModeConfiguration(requestedUsageMode).gyroRange != range)
+		{
+			// A range change is in flight. Stop waiting if the remote never applies it.
+			if (++usageModeWindowCount < UsageModeWindowPackets) return;
+
+			usageModeWindowCount = 0;
+			gyroHistory.Clear();
+			requestedUsageMode = UsageMode::Normal;
+			for (auto mode : { UsageMode::Precision, UsageMode::Normal, UsageMode::Fast })
+			{
+				if (RemoteControl::UsageModeConfiguration(mode).gyroRange == range) requestedUsageMode = mode;
+			}
+			return;
+		}
+
+		gyroHistory.Push(raw);
+
+		auto peak = std::max({ std::abs(raw.X), std::abs(raw.Y), std::abs(raw.Z) });
+		if (peak >= SaturationFraction * INT16_MAX && requestedUsageMode != UsageMode::Fast)
+		{
+			usageModeWindowCount = 0;
+			gyroHistory.Clear();
+			RequestUsageMode((UsageMode)((int)requestedUsageMode + 1));
+			return;
+		}
 
-		auto currentButtonData = packet.ButtonData;
-		uint8_t buttonChanges = (uint8_t)(currentButtonData ^ previousButtonData);
+		if (++usageModeWindowCount < UsageModeWindowPackets) return;
 
-		int rightChanged = buttonChanges & RightMask;
-		int rightDown = currentButtonData & RightMask;
-		int middleChanged = buttonChanges & MiddleMask;
-		int middleDown = currentButtonData & MiddleMask;
-		int leftChanged = buttonChanges & LeftMask;
-		int leftDown = currentButtonData & LeftMask;
+		auto peakRate = WindowPeak() * range / INT16_MAX;
+		usageModeWindowCount = 0;
+		gyroHistory.Clear();
 
-		if (rightChanged)
+		for (auto mode = UsageMode::Precision; mode < requestedUsageMode; mode = (UsageMode)((int)mode + 1))
 		{
-			MouseClick(rightDown ? MOUSEEVENTF_RIGHTDOWN : MOUSEEVENTF_RIGHTUP);
+			if (peakRate >= RemoteControl::UsageModeConfiguration(mode).gyroRange * NarrowRangeHeadroom) continue;
+			RequestUsageMode(mode);
+			break;
 		}
+	}
+
+	void Initialize()
+	{
+		PointerOutput::Initialize();
+		PointerOutput::CursorPosition(mouseX, mouseY);
+		screenWidth = PointerOutput::ScreenWidth();
+		screenHeight = PointerOutput::ScreenHeight();
+	}
 
+	void Scroll(int scrollAmount)
+	{
+		metrics.scrolls++;
+		if (!PointerOutput::Scroll(scrollAmount)) metrics.sendInputFailures++;
+	}
+
+	// Moves the mouse to the position (x, y)
+	void MouseMove(float x, float y)
+	{
+		metrics.moves++;
+		if (!PointerOutput::Move(x, y)) metrics.sendInputFailures++;
+	}
 
-		if (leftChanged)
+	void MouseClick(MouseButton button, bool isDown)
+	{
+		metrics.clicks++;
+		if (!PointerOutput::Button(button, isDown)) metrics.sendInputFailures++;
+	}
+
+	// Modifiers go down before the key and up after it
+	static void KeyPress(const ButtonMapper::Action& action, bool isDown)
+	{
+		static constexpr uint16_t ModifierKeys[ButtonMapper::ModifierCount] = { 0x10, 0x11, 0x12, 0x5B }; // shift, ctrl, alt, win
+
+		auto isSent = true;
+		for (int i = 0; i < ButtonMapper::ModifierCount && isDown; i++)
 		{
-			MouseClick(leftDown ? MOUSEEVENTF_LEFTDOWN : MOUSEEVENTF_LEFTUP);
+			if (action.value & (1 << i)) isSent &= PointerOutput::Key(ModifierKeys[i], true);
 		}
+		isSent &= PointerOutput::Key(action.key, isDown);
+		for (int i = ButtonMapper::ModifierCount - 1; i >= 0 && !isDown; i--)
+		{
+			if (action.value & (1 << i)) isSent &= PointerOutput::Key(ModifierKeys[i], false);
+		}
+		if (!isSent) metrics.sendInputFailures++;
+	}
 
-		if (middleChanged)
+	static void Perform(const ButtonMapper::Output& output)
+	{
+		using ActionType = ButtonMapper::ActionType;
+
+		auto& action = output.action;
+		switch (action.type)
 		{
-			MouseClick(middleDown ? MOUSEEVENTF_MIDDLEDOWN : MOUSEEVENTF_MIDDLEUP);
-			middleMouseAction = middleDown ? MiddleMouseAction::Undetermined : MiddleMouseAction::None;
+		case ActionType::Mouse:
+			MouseClick((MouseButton)action.value, output.isActive);
+			break;
+		case ActionType::Key:
+			KeyPress(action, output.isActive);
+			break;
+		case ActionType::MiddleGesture:
+			MouseClick(MouseButton::Middle, output.isActive);
+			middleMouseAction = output.isActive ? MiddleMouseAction::Undetermined : MiddleMouseAction::None;
+			scrollRemainder = 0;
+			break;
+		case ActionType::Scroll:
+			isScrollMode = output.isActive;
+			scrollRemainder = 0;
+			break;
+		case ActionType::Precision:
+			isPrecise = output.isActive;
+			break;
+		default:
+			break;
 		}
+	}
 
-		previousButtonData = currentButtonData;
+	static void HandleButtons(uint8_t currentButtonData)
+	{
+		ButtonMapper::Output outputs[ButtonMapper::MaxOutputs];
+		auto count = buttonMapper.Update(currentButtonData, (int64_t)sampleClockMs, outputs);
+		for (int i = 0; i < count; i++) Perform(outputs[i]);
+	}
+
+	// Takes back what pressing or releasing moved the cursor, before the button goes out.
+	// Returns true when (mouseX, mouseY) changed.
+	static bool TakeBackButtonEdge(uint8_t buttonData, bool isScrolling)
+	{
+		auto isEdge = buttonData != previousButtonData;
+		previousButtonData = buttonData;
+		if (!isEdge || isScrolling) return false;
+
+		float undoX, undoY;
+		clickStabilizer.Edge(sampleClockMs, undoX, undoY);
+		if (undoX == 0 && undoY == 0) return false;
+
+		mouseX = std::clamp(mouseX - undoX, 0.0f, (float)screenWidth);
+		mouseY = std::clamp(mouseY - undoY, 0.0f, (float)screenHeight);
+		return true;
+	}
 
-		auto dx = gyro.Z;
-		auto dy = gyro.X;
-		auto scroll = gyro.Y;
+	static void HandlePacket(Packet packet, float interval)
+	{
+		auto gyro = ToVector3(packet.Gyro, appliedDegreeRange);
+		EvaluateUsageMode(packet.Gyro, appliedDegreeRange);
 
-		if (abs(dx) < MouseDeadZone) dx = 0;
-		if (abs(dy) < MouseDeadZone) dy = 0;
-		if (abs(scroll) < ScrollDeadZone) scroll = 0;
+		auto isScrolling = middleMouseAction == MiddleMouseAction::Scroll || isScrollMode;
+		if (TakeBackButtonEdge(packet.ButtonData, isScrolling))
+		{
+			motionPredictor.Reset();
+			MouseMove(mouseX, mouseY);
+		}
+		HandleButtons(packet.ButtonData);
 
-		auto cookedDx = (float)(-dx * pow(abs(dx), MousePowerFactor - 1) / MouseSensitivity);
-		auto cookedDy = (float)(dy * pow(abs(dy), MousePowerFactor - 1) / MouseSensitivity);
-		auto cookedScroll = (float)(scroll * pow(abs(scroll), ScrollPowerFactor - 1) / ScrollSensitivity);
+		auto motion = ResponseCurve::Apply(responseCurve, gyro, interval);
+		auto dx = motion.dx;
+		auto dy = motion.dy;
+		auto cookedDx = motion.cookedDx;
+		auto cookedDy = motion.cookedDy;
+		auto cookedScroll = motion.cookedScroll;
+
+		if (isPrecise)
+		{
+			cookedDx *= PrecisionScale;
+			cookedDy *= PrecisionScale;
+		}
+		clickStabilizer.Filter(sampleClockMs, cookedDx, cookedDy);
 
 		if (middleMouseAction == MiddleMouseAction::Undetermined)
 		{
-			if (abs(scroll) > ScrollTolerance)
+			if (ResponseCurve::IsScrollGesture(responseCurve, motion))
 			{
 				middleMouseAction = MiddleMouseAction::Scroll;
 			}
 
-			if (dx * dx + dy * dy > DragTolerance)
+			if (ResponseCurve::IsDragGesture(responseCurve, motion))
 			{
 				middleMouseAction = MiddleMouseAction::Drag;
 			}
 		}
 
-		if (middleMouseAction == MiddleMouseAction::Scroll)
+		isScrolling = middleMouseAction == MiddleMouseAction::Scroll || isScrollMode;
+		if (isScrolling)
 		{
-			Scroll((int)roundf(cookedScroll));
+			scrollRemainder += cookedScroll;
+			auto steps = (int)std::round(scrollRemainder);
+			scrollRemainder -= steps;
+			if (steps != 0) Scroll(steps);
 		}
 
 		bool noMovement = cookedDx == 0 && cookedDy == 0;
 
+		// The cursor is shown ahead of (mouseX, mouseY) by the predicted lead, which decays once
+		// movement stops, so keep moving until it has settled on the true position
+		float leadX = 0, leadY = 0;
+		motionPredictor.Update(cookedDx, cookedDy, interval, leadX, leadY);
+		bool isSettling = std::abs(leadX) >= 0.5f || std::abs(leadY) >= 0.5f;
+
+		bool isCursorFree = (noMovement && !isSettling) || isScrolling;
+		plotFeed.Push({ gyro.X, gyro.Y, gyro.Z, dx, dy, isCursorFree ? 0.0f : cookedDx, isCursorFree ? 0.0f : cookedDy });
+
 		// allow free mouse movement when no input is given or when scrolling
-		if (noMovement || middleMouseAction == MiddleMouseAction::Scroll)
+		if (isCursorFree)
 		{
-			GetCursorPos(&cursor);
-			mouseX = (float)cursor.x;
-			mouseY = (float)cursor.y;
+			if (isSettling) MouseMove(mouseX, mouseY);
+			motionPredictor.Reset();
+
+			PointerOutput::CursorPosition(mouseX, mouseY);
 			return;
 		}
 
@@ -163,6 +426,187 @@ namespace Input
 		mouseX = std::clamp(mouseX, 0.0f, (float)screenWidth);
 		mouseY = std::clamp(mouseY, 0.0f, (float)screenHeight);
 
-		MouseMove();
+		MouseMove(std::clamp(mouseX + leadX, 0.0f, (float)screenWidth), std::clamp(mouseY + leadY, 0.0f, (float)screenHeight));
+	}
+
+	// Whether a packet arriving while idle leaves it idle. Checked before anything else so that rest
+	// costs next to nothing; a pending range or tuning change changes the thresholds, so it takes
+	// the full path.
+	static bool StaysIdle(const Packet& packet)
+	{
+		return idleDetector.IsIdle() && !idleDetector.IsActive(packet)
+			&& degreeRange.load(std::memory_order_relaxed) == appliedDegreeRange
+			&& tuning.load(std::memory_order_relaxed) == appliedTuning.load(std::memory_order_relaxed);
+	}
+
+	// Published only now and then; the next active packet publishes the exact count
+	static void CountIdlePacket()
+	{
+		if (metrics.idlePackets++ % IdlePublishPackets == 0) Metrics::Publish(Metrics::WriterPage()->input, metrics);
+	}
+
+	// Handles mouse input (click, move, and scroll)
+	static void ProcessPacket(Packet packet, float interval)
+	{
+		if (StaysIdle(packet))
+		{
+			CountIdlePacket();
+			return;
+		}
+
+		Trace::Scope scope("Input");
+
+		ApplyDegreeRange();
+		ApplyPredictionLatency();
+		ApplyTuning();
+
+		auto wasIdle = idleDetector.IsIdle();
+
+		if (!idleDetector.Update(packet, interval))
+		{
+			scope.Argument("idle", 1);
+			metrics.idlePackets++;
+			Metrics::Publish(Metrics::WriterPage()->input, metrics);
+			return;
+		}
+
+		// The cursor may have been moved by another device while we were idle
+		if (wasIdle)
+		{
+			motionPredictor.Reset();
+			PointerOutput::CursorPosition(mouseX, mouseY);
+		}
+
+		HandlePacket(packet, interval);
+
+		metrics.packetsProcessed++;
+		Metrics::Publish(Metrics::WriterPage()->input, metrics);
+	}
+
+	void ProcessPacket(Packet packet)
+	{
+		ProcessPacket(packet, TakeSampleInterval());
+	}
+
+	// Yaw and pitch of the remote's pointing axis (Y) in degrees
+	static void PointingAngles(float& yaw, float& pitch)
+	{
+		constexpr auto DegreesPerRadian = 57.29578f;
+
+		auto forward = orientationFilter.Rotate({ 0, 1, 0 });
+		yaw = std::atan2(-forward.X, forward.Y) * DegreesPerRadian;
+		pitch = std::asin(std::clamp(forward.Z, -1.0f, 1.0f)) * DegreesPerRadian;
+	}
+
+	// Chooses the reference direction so that the current orientation maps to (mouseX, mouseY)
+	static void AnchorAbsolutePointing()
+	{
+		float yaw, pitch;
+		PointingAngles(yaw, pitch);
+
+		auto centerX = screenWidth / 2.0f;
+		auto centerY = screenHeight / 2.0f;
+		referenceYaw = yaw - (centerX - mouseX) / centerX * (AbsoluteHorizontalSpan / 2);
+		referencePitch = pitch - (mouseY - centerY) / centerY * (AbsoluteVerticalSpan / 2);
+	}
+
+	// Anchors to where the cursor is now, which another device may have moved
+	static void RecenterAbsolutePointing()
+	{
+		PointerOutput::CursorPosition(mouseX, mouseY);
+		AnchorAbsolutePointing();
+	}
+
+	// Button edges and the click stabilizer act on the cursor as in relative mode. What they take
+	// back or hold is moved into the reference direction, so the cursor stays where they left it.
+	static void HandleAbsolutePointing(const ExtendedPacket& packet)
+	{
+		if (TakeBackButtonEdge(packet.ButtonData, false)) AnchorAbsolutePointing();
+		HandleButtons(packet.ButtonData);
+
+		float yaw, pitch;
+		PointingAngles(yaw, pitch);
+
+		auto deltaYaw = std::remainder(yaw - referenceYaw, 360.0f);
+		auto deltaPitch = pitch - referencePitch;
+
+		// Same directions as relative mode: positive yaw moves left, positive pitch moves down
+		auto centerX = screenWidth / 2.0f;
+		auto centerY = screenHeight / 2.0f;
+		auto previousX = mouseX;
+		auto previousY = mouseY;
+		auto targetX = std::clamp(centerX - deltaYaw / (AbsoluteHorizontalSpan / 2) * centerX, 0.0f, (float)screenWidth);
+		auto targetY = std::clamp(centerY + deltaPitch / (AbsoluteVerticalSpan / 2) * centerY, 0.0f, (float)screenHeight);
+
+		auto dx = targetX - previousX;
+		auto dy = targetY - previousY;
+		clickStabilizer.Filter(sampleClockMs, dx, dy);
+		mouseX = previousX + dx;
+		mouseY = previousY + dy;
+		if (mouseX != targetX || mouseY != targetY) AnchorAbsolutePointing();
+
+		auto gyro = ToVector3(packet.Gyro, appliedDegreeRange);
+		plotFeed.Push({ gyro.X, gyro.Y, gyro.Z, deltaYaw, deltaPitch, mouseX - previousX, mouseY - previousY });
+
+		MouseMove(mouseX, mouseY);
+	}
+
+	const PlotFeed& Plots()
+	{
+		return plotFeed;
+	}
+
+	// Keeps the orientation estimate current in both pointing modes
+	void ProcessExtendedPacket(ExtendedPacket packet)
+	{
+		constexpr auto RadiansPerDegree = 0.01745329f;
+
+		// The orientation is left as it was while idle; absolute pointing anchors afresh on waking
+		auto interval = TakeSampleInterval();
+		if (StaysIdle({ packet.Gyro, packet.ButtonData }))
+		{
+			CountIdlePacket();
+			return;
+		}
+
+		Trace::Scope scope("Input extended");
+
+		ApplyDegreeRange();
+		ApplyTuning();
+
+		auto gyro = ToVector3(packet.Gyro, appliedDegreeRange * RadiansPerDegree);
+		auto acceleration = Vector3{ (float)packet.Accel.X, (float)packet.Accel.Y, (float)packet.Accel.Z }; // scale is irrelevant
+		orientationFilter.Update(gyro, acceleration, interval);
+
+		auto mode = pointingMode.load(std::memory_order_relaxed);
+
+		if (mode == PointingMode::Relative)
+		{
+			appliedPointingMode = mode;
+			ProcessPacket({ packet.Gyro, packet.ButtonData }, interval);
+			return;
+		}
+
+		// Idle as in relative mode. The pointer is anchored afresh on waking, as the cursor may
+		// have been moved by another device.
+		auto wasIdle = idleDetector.IsIdle();
+		if (!idleDetector.Update({ packet.Gyro, packet.ButtonData }, interval))
+		{
+			scope.Argument("idle", 1);
+			metrics.idlePackets++;
+			Metrics::Publish(Metrics::WriterPage()->input, metrics);
+			return;
+		}
+
+		if (appliedPointingMode != mode || wasIdle)
+		{
+			appliedPointingMode = mode;
+			RecenterAbsolutePointing();
+		}
+
+		HandleAbsolutePointing(packet);
+
+		metrics.packetsProcessed++;
+		Metrics::Publish(Metrics::WriterPage()->input, metrics);
 	}
 }
\ No newline at end of file
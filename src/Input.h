@@ -1,5 +1,13 @@
 #pragma once
-#include "Main.h"
+#include "ButtonMapper.h"
+#include "ClickStabilizer.h"
+#include "Packet.h"
+#include "PacketSchema.h"
+#include "PlotFeed.h"
+#include "PointerOutput.h"
+#include "RemoteControl.h"
+#include "ResponseCurve.h"
+#include <functional>
 
 namespace Input
 {
@@ -13,11 +21,42 @@ namespace Input
 	static constexpr auto ScrollTolerance = 25;
 	static constexpr auto DragTolerance = 20;
 
-	static constexpr auto DegreeRange = 500.0f;
+	static constexpr auto PrecisionScale = 0.3f; // pointer motion while a precision binding is active
 
-	static const uint8_t RightMask = 1 << 0;
-	static const uint8_t LeftMask = 1 << 1;
-	static const uint8_t MiddleMask = 1 << 2;
+	// Press-induced motion around button edges, see ClickStabilizer.h and tools/ClickBenchmark.cpp
+	static constexpr ClickStabilizer::Parameters DefaultClickStabilization{ 40, 60, 16 };
+
+	static constexpr ResponseCurve::Parameters DefaultResponseCurve{ MouseSensitivity, MousePowerFactor, MouseDeadZone,
+		ScrollSensitivity, ScrollPowerFactor, ScrollDeadZone, ScrollTolerance, DragTolerance };
+
+	static constexpr auto DefaultDegreeRange = (float)RemoteControl::DefaultGyroRange;
+
+	// Usage mode selection from observed angular rates
+	static constexpr auto UsageModeWindowPackets = 200;
+	static constexpr auto SaturationFraction = 0.95f; // a sample this close to full scale widens the range
+	static constexpr auto NarrowRangeHeadroom = 0.7f; // narrow only if the window peak fits within this share of the range
+
+	// Absolute (air mouse) pointing: the screen spans this many degrees of remote rotation
+	static constexpr auto FusionBeta = 0.033f;
+	static constexpr auto AbsoluteHorizontalSpan = 60.0f;
+	static constexpr auto AbsoluteVerticalSpan = 35.0f;
+
+	// Lead applied to relative pointing when prediction is enabled: a typical connection interval
+	// plus processing time. Prediction is off by default.
+	static constexpr auto PredictionLatencyMs = 20.0f;
+	static constexpr auto DefaultPredictionLatencyMs = 0.0f;
+
+	static constexpr auto IdleTimeoutMs = 2000; // no motion or button changes for this long enters idle mode
+
+	static const uint8_t RightMask = PacketSchema::RightMask;
+	static const uint8_t LeftMask = PacketSchema::LeftMask;
+	static const uint8_t MiddleMask = PacketSchema::MiddleMask;
+
+	enum class PointingMode
+	{
+		Relative, // integrate gyro rates into cursor deltas
+		Absolute // map the remote's orientation to a screen position, needs extended packets
+	};
 
 	enum class MiddleMouseAction
 	{
@@ -27,9 +66,36 @@ namespace Input
 		Drag
 	};
 
+	// Settings a profile can vary per application, resolved and compiled in advance
+	struct Tuning
+	{
+		ResponseCurve::Parameters responseCurve;
+		ButtonMapper::Table buttons; // compiled
+		ClickStabilizer::Parameters clickStabilization;
+	};
+
+	Tuning DefaultTuning();
+
+	extern std::function<void(RemoteControl::UsageMode)> UsageModeRequested;
+
 	void Initialize();
+	void SetDegreeRange(float range);
+	void SetSampleRate(float sampleRateHz);
+	void SetPointingMode(PointingMode mode);
+	void SetPredictionLatency(float latencyMs);
+	// Any thread. The packet thread picks the block up by pointer on its next packet, so it must
+	// stay allocated and unchanged while IsTuningInUse says so, or while it is current.
+	void SetTuning(const Tuning* tuning);
+	// After SetTuning replaced it: false once the packet thread no longer reads or compares the
+	// block, which may then be freed
+	bool IsTuningInUse(const Tuning* tuning);
+	void SkipSamples(int count); // samples lost before the next packet, whose motion then spans them too
 	void Scroll(int scrollAmount);
-	void MouseMove();
-	void MouseClick(int flags);
+	void MouseMove(float x, float y);
+	void MouseClick(PointerOutput::MouseButton button, bool isDown);
 	void ProcessPacket(Packet packet);
+	void ProcessExtendedPacket(ExtendedPacket packet);
+
+	// Per-packet signals for live plots, pushed on the packet thread
+	const PlotFeed& Plots();
 }
\ No newline at end of file
@@ -0,0 +1,87 @@
+#include "LinkSimulator.h"
+
+LinkSimulator::LinkSimulator(CircularBuffer& buffer, const ImpairmentProfile& profile, uint32_t seed) :
+	buffer(buffer),
+	profile(profile),
+	random(seed)
+{
+}
+
+bool LinkSimulator::Roll(double probability)
+{
+	return probability > 0 && chance(random) < probability;
+}
+
+void LinkSimulator::Emit(uint8_t byte)
+{
+	buffer.WriteBuffer(byte);
+	statistics.bytesOut++;
+
+	if (!isHoldingByte) return;
+
+	heldByteCountdown--;
+	if (heldByteCountdown > 0) return;
+
+	isHoldingByte = false;
+	buffer.WriteBuffer(heldByte);
+	statistics.bytesOut++;
+}
+
+// Writes the impaired version of data into the buffer
+void LinkSimulator::Transmit(const uint8_t* data, size_t length)
+{
+	for (size_t i = 0; i < length; i++)
+	{
+		auto byte = data[i];
+		statistics.bytesIn++;
+
+		if (burstBytesRemaining == 0 && Roll(profile.burstGapRate))
+		{
+			std::uniform_int_distribution<int> burstLength(1, profile.maxBurstGapBytes > 0 ? profile.maxBurstGapBytes : 1);
+			burstBytesRemaining = burstLength(random);
+			statistics.burstGaps++;
+		}
+
+		if (burstBytesRemaining > 0)
+		{
+			burstBytesRemaining--;
+			statistics.droppedBytes++;
+			continue;
+		}
+
+		if (Roll(profile.byteDropRate))
+		{
+			statistics.droppedBytes++;
+			continue;
+		}
+
+		if (Roll(profile.bitFlipRate))
+		{
+			std::uniform_int_distribution<int> bit(0, 7);
+			byte ^= (uint8_t)(1 << bit(random));
+			statistics.flippedBytes++;
+		}
+
+		if (!isHoldingByte && profile.reorderDistance > 0 && Roll(profile.reorderRate))
+		{
+			isHoldingByte = true;
+			heldByte = byte;
+			heldByteCountdown = profile.reorderDistance;
+			statistics.reorderedBytes++;
+			continue;
+		}
+
+		Emit(byte);
+
+		if (Roll(profile.duplicateRate))
+		{
+			Emit(byte);
+			statistics.duplicatedBytes++;
+		}
+	}
+}
+
+const LinkStatistics& LinkSimulator::Statistics() const
+{
+	return statistics;
+}
@@ -0,0 +1,54 @@
+#pragma once
+#include "CircularBuffer.h"
+#include <cstddef>
+#include <cstdint>
+#include <random>
+
+// Sits between a packet source and a CircularBuffer and impairs the byte stream the way a
+// noisy BLE link would. All probabilities are per byte.
+struct ImpairmentProfile
+{
+	const char* name;
+	double byteDropRate;
+	double bitFlipRate;
+	double duplicateRate;
+	double burstGapRate; // chance that a burst of bytes is lost starting at this byte
+	int maxBurstGapBytes;
+	double reorderRate; // chance that a byte is held back and delivered reorderDistance bytes later
+	int reorderDistance;
+};
+
+struct LinkStatistics
+{
+	uint64_t bytesIn;
+	uint64_t bytesOut;
+	uint64_t droppedBytes;
+	uint64_t flippedBytes;
+	uint64_t duplicatedBytes;
+	uint64_t burstGaps;
+	uint64_t reorderedBytes;
+};
+
+class LinkSimulator
+{
+private:
+	CircularBuffer& buffer;
+	ImpairmentProfile profile;
+	LinkStatistics statistics{};
+
+	std::mt19937 random;
+	std::uniform_real_distribution<double> chance{ 0.0, 1.0 };
+
+	int burstBytesRemaining = 0;
+	bool isHoldingByte = false;
+	uint8_t heldByte = 0;
+	int heldByteCountdown = 0;
+
+	bool Roll(double probability);
+	void Emit(uint8_t byte);
+public:
+	LinkSimulator(CircularBuffer& buffer, const ImpairmentProfile& profile, uint32_t seed);
+
+	void Transmit(const uint8_t* data, size_t length);
+	const LinkStatistics& Statistics() const;
+};
@@ -0,0 +1,281 @@
+#include "Logger.h"
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace Logger
+{
+	static_assert((RingCapacity & (RingCapacity - 1)) == 0, "RingCapacity must be a power of two");
+
+	// Single producer (the owning thread), single consumer (the writer thread)
+	struct Ring
+	{
+		alignas(64) std::atomic<uint32_t> head{ 0 }; // next slot to write, owned by producer
+		alignas(64) std::atomic<uint32_t> tail{ 0 }; // next slot to read, owned by consumer
+		alignas(64) std::atomic<uint32_t> dropped{ 0 };
+		Record records[RingCapacity];
+	};
+
+	struct RepeatState
+	{
+		int64_t lastPrintedNs;
+		unsigned int suppressed;
+		Record lastSuppressed; // printed with the count if the burst ends without another
+	};
+
+	std::atomic<Level> MinimumLevel{
+#ifdef _DEBUG
+		Level::Debug
+#else
+		Level::Info
+#endif
+	};
+
+	static std::mutex ringsMutex;
+	static std::vector<std::unique_ptr<Ring>> rings;
+	static std::vector<Ring*> freeRings; // reserved by Initialize, or left by threads that have exited
+
+	static void ReleaseRing(Ring* ring)
+	{
+		std::lock_guard<std::mutex> lock(ringsMutex);
+		freeRings.push_back(ring); // never grows past rings.size(), reserved in AcquireRing
+	}
+
+	// Hands the ring back when its thread exits. Notifications arrive on thread pool workers that
+	// come and go, and a new worker then takes a free ring instead of allocating on its first packet.
+	struct LocalRing
+	{
+		Ring* ring = nullptr;
+		~LocalRing() { if (ring) ReleaseRing(ring); }
+	};
+	static thread_local LocalRing localRing;
+
+	static std::thread writerThread;
+	static std::atomic<bool> isRunning = false;
+	static FILE* fileSink = nullptr;
+	static std::unordered_map<const char*, RepeatState> repeatStates;
+
+	static const char* LevelName(Level level)
+	{
+		switch (level)
+		{
+		case Level::Debug: return "DEBUG";
+		case Level::Info: return "INFO ";
+		case Level::Warning: return "WARN ";
+		case Level::Error: return "ERROR";
+		}
+		return "?????";
+	}
+
+	int64_t TimestampNs()
+	{
+		using namespace std::chrono;
+		return duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count();
+	}
+
+	// Call with ringsMutex held
+	static Ring* AddRing()
+	{
+		rings.push_back(std::make_unique<Ring>());
+		freeRings.reserve(rings.size());
+		return rings.back().get();
+	}
+
+	// A reused ring carries on from its head and tail; the writer keeps draining it throughout
+	static Ring* AcquireRing()
+	{
+		std::lock_guard<std::mutex> lock(ringsMutex);
+		if (freeRings.empty()) return AddRing();
+
+		auto* ring = freeRings.back();
+		freeRings.pop_back();
+		return ring;
+	}
+
+	void Push(const Record& record)
+	{
+		auto*& ring = localRing.ring;
+		if (ring == nullptr) ring = AcquireRing(); // once per thread, off the steady-state path
+
+		auto head = ring->head.load(std::memory_order_relaxed);
+		auto tail = ring->tail.load(std::memory_order_acquire);
+
+		if (head - tail >= RingCapacity)
+		{
+			ring->dropped.fetch_add(1, std::memory_order_relaxed);
+			return;
+		}
+
+		ring->records[head & (RingCapacity - 1)] = record;
+		ring->head.store(head + 1, std::memory_order_release);
+	}
+
+	static void WriteLine(const char* line, int length)
+	{
+		fwrite(line, 1, (size_t)length, stdout);
+		if (fileSink) fwrite(line, 1, (size_t)length, fileSink);
+	}
+
+	// Prints record, noting how many similar ones were suppressed before it
+	static void PrintRecord(const Record& record, unsigned int suppressed)
+	{
+		char message[256];
+		const auto* a = record.arguments;
+		// Unused trailing arguments are ignored by snprintf
+		snprintf(message, sizeof(message), record.format, a[0], a[1], a[2], a[3]);
+
+		char line[320];
+		auto seconds = (double)record.timestampNs / 1e9;
+		int length;
+		if (suppressed > 0)
+		{
+			length = snprintf(line, sizeof(line), "[%12.6f] %s %s (+%u similar suppressed)\n",
+				seconds, LevelName(record.level), message, suppressed);
+		}
+		else
+		{
+			length = snprintf(line, sizeof(line), "[%12.6f] %s %s\n", seconds, LevelName(record.level), message);
+		}
+
+		if (length > (int)sizeof(line) - 1) length = (int)sizeof(line) - 1;
+		WriteLine(line, length);
+	}
+
+	static void WriteRecord(const Record& record)
+	{
+		auto& repeat = repeatStates[record.format];
+		auto sinceLastPrintMs = (record.timestampNs - repeat.lastPrintedNs) / 1000000;
+
+		if (repeat.lastPrintedNs != 0 && sinceLastPrintMs < RepeatSuppressionMs)
+		{
+			repeat.lastSuppressed = record;
+			repeat.suppressed++;
+			return;
+		}
+
+		PrintRecord(record, repeat.suppressed);
+		repeat.lastPrintedNs = record.timestampNs;
+		repeat.suppressed = 0;
+	}
+
+	// Prints the last suppressed record of every burst whose window has passed, or of every burst
+	// when isFinal, so a count is not lost when the message does not come again
+	static bool FlushSuppressed(bool isFinal)
+	{
+		auto now = TimestampNs();
+		bool wroteAny = false;
+
+		for (auto& entry : repeatStates)
+		{
+			auto& repeat = entry.second;
+			if (repeat.suppressed == 0) continue;
+			if (!isFinal && (now - repeat.lastPrintedNs) / 1000000 < RepeatSuppressionMs) continue;
+
+			PrintRecord(repeat.lastSuppressed, repeat.suppressed - 1);
+			repeat.lastPrintedNs = repeat.lastSuppressed.timestampNs;
+			repeat.suppressed = 0;
+			wroteAny = true;
+		}
+
+		return wroteAny;
+	}
+
+	static bool Drain()
+	{
+		std::vector<Ring*> snapshot;
+		{
+			std::lock_guard<std::mutex> lock(ringsMutex);
+			snapshot.reserve(rings.size());
+			for (auto& ring : rings) snapshot.push_back(ring.get());
+		}
+
+		bool wroteAny = false;
+
+		for (auto* ring : snapshot)
+		{
+			auto tail = ring->tail.load(std::memory_order_relaxed);
+			auto head = ring->head.load(std::memory_order_acquire);
+
+			for (; tail != head; tail++)
+			{
+				WriteRecord(ring->records[tail & (RingCapacity - 1)]);
+				wroteAny = true;
+			}
+
+			ring->tail.store(tail, std::memory_order_release);
+
+			auto dropped = ring->dropped.exchange(0, std::memory_order_relaxed);
+			if (dropped > 0)
+			{
+				char line[96];
+				auto length = snprintf(line, sizeof(line), "Logger ring full, dropped %u records\n", dropped);
+				WriteLine(line, length);
+				wroteAny = true;
+			}
+		}
+
+		return wroteAny;
+	}
+
+	static void WriterLoop()
+	{
+		while (isRunning.load(std::memory_order_acquire))
+		{
+			auto wroteAny = Drain();
+			wroteAny |= FlushSuppressed(false);
+			if (wroteAny)
+			{
+				fflush(stdout);
+				if (fileSink) fflush(fileSink);
+			}
+
+			std::this_thread::sleep_for(std::chrono::milliseconds(FlushIntervalMs));
+		}
+
+		Drain();
+		FlushSuppressed(true);
+		fflush(stdout);
+		if (fileSink) fflush(fileSink);
+	}
+
+	// Starts the writer thread. Records are also appended to filePath when it is given.
+	void Initialize(const char* filePath)
+	{
+		if (isRunning.exchange(true)) return;
+
+		{
+			std::lock_guard<std::mutex> lock(ringsMutex);
+			while ((int)freeRings.size() < ReservedRings) freeRings.push_back(AddRing());
+		}
+
+		if (filePath)
+		{
+#ifdef _WIN32
+			if (fopen_s(&fileSink, filePath, "a") != 0) fileSink = nullptr;
+#else
+			fileSink = fopen(filePath, "a");
+#endif
+			if (!fileSink) fprintf(stderr, "Unable to open log file %s\n", filePath);
+		}
+
+		writerThread = std::thread(WriterLoop);
+	}
+
+	// Flushes all pending records and stops the writer thread
+	void Shutdown()
+	{
+		if (!isRunning.exchange(false)) return;
+
+		writerThread.join();
+
+		if (fileSink)
+		{
+			fclose(fileSink);
+			fileSink = nullptr;
+		}
+	}
+}
@@ -0,0 +1,65 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <type_traits>
+
+// Asynchronous logger for the data path. Callers copy a fixed-size binary record into a
+// lock-free ring owned by their thread; a background thread formats and writes the records.
+namespace Logger
+{
+	static constexpr auto RingCapacity = 256; // records per thread, must be a power of two
+	static constexpr auto ReservedRings = 4; // created up front for threads that start logging later
+	static constexpr auto MaxArguments = 4;
+	static constexpr auto FlushIntervalMs = 10;
+	static constexpr auto RepeatSuppressionMs = 1000; // identical messages within this window are counted, not printed
+
+	enum class Level : uint8_t
+	{
+		Debug,
+		Info,
+		Warning,
+		Error
+	};
+
+	struct Record
+	{
+		const char* format; // printf-style, all conversions must be %ll. Must outlive the logger (use literals)
+		int64_t timestampNs;
+		long long arguments[MaxArguments];
+		Level level;
+		uint8_t argumentCount;
+	};
+
+	extern std::atomic<Level> MinimumLevel;
+
+	void Initialize(const char* filePath = nullptr);
+	void Shutdown();
+	int64_t TimestampNs();
+	void Push(const Record& record);
+
+	// Only integral arguments are accepted so that a record never owns memory.
+	template <typename... Args>
+	void Log(Level level, const char* format, Args... args)
+	{
+		static_assert(sizeof...(Args) <= MaxArguments, "Too many log arguments");
+		static_assert((std::is_integral_v<Args> && ...), "Log arguments must be integral");
+
+		if (level < MinimumLevel.load(std::memory_order_relaxed)) return;
+
+		Record record{ format, TimestampNs(), { static_cast<long long>(args)... }, level,
+			static_cast<uint8_t>(sizeof...(Args)) };
+		Push(record);
+	}
+
+	template <typename... Args>
+	void Debug(const char* format, Args... args) { Log(Level::Debug, format, args...); }
+
+	template <typename... Args>
+	void Info(const char* format, Args... args) { Log(Level::Info, format, args...); }
+
+	template <typename... Args>
+	void Warning(const char* format, Args... args) { Log(Level::Warning, format, args...); }
+
+	template <typename... Args>
+	void Error(const char* format, Args... args) { Log(Level::Error, format, args...); }
+}
@@ -6,8 +6,18 @@
 #include "PacketParser.h"
 #include "Main.h"
 #include "TrayWindow.h"
+#include "Logger.h"
+#include "Metrics.h"
+#include "RemoteControl.h"
+#include "Pipeline.h"
+#include "PipelineSnapshot.h"
+#include "ProcessInfo.h"
+#include "Startup.h"
+#include "Trace.h"
 #include <QApplication>
 #include <QFont>
+#include <future>
+#include <memory>
 
 static bool autoReconnect = false;
 static HMODULE hInstance;
@@ -151,29 +161,78 @@ void OnBLEDisconnected()
 
 int main(int argc, char* argv[]) {
 
+	Logger::Initialize("GestureBackend.log");
+	Metrics::WriterPage();
+	Trace::Initialize();
+
+	// The QApplication constructor would make the process per-monitor DPI aware while the worker
+	// below reads the screen size, so it is set first, to what Qt would choose. Qt then keeps it;
+	// if a manifest already set it, this fails and the awareness is fixed just the same.
+	SetProcessDpiAwarenessContext(DPI_AWARENESS_CONTEXT_PER_MONITOR_AWARE_V2);
+
+	// Bluetooth and the input pipeline come up on their own thread while Qt loads, so the remote
+	// is found and drives the cursor whether or not the tray window is up yet
+	std::unique_ptr<BluetoothLE::BLEDevice> bleDevice;
+	RemoteControl::Controller remoteControl([&bleDevice](const uint8_t* data, size_t length) {
+		return bleDevice->Write(data, length); // only once connected, so after bleDevice is set
+	});
+	auto pipelineStarted = std::async(std::launch::async, [&bleDevice, &remoteControl]() {
+		RoInitialize(RO_INIT_MULTITHREADED); // kept for the process, like the threads WinRT calls back on
+
+		Input::Initialize();
+		if (!PipelineSnapshot::Open(PipelineSnapshot::DefaultPath))
+		{
+			Logger::Warning("Snapshot file is not valid, it will be overwritten");
+		}
+
+		bleDevice = std::make_unique<BluetoothLE::BLEDevice>(0xffe0, 0xffe1, L"802048");
+		Pipeline::Connect(*bleDevice, remoteControl, OnBLEConnected, OnBLEDisconnected);
+		Pipeline::KeepSnapshots(*bleDevice, remoteControl);
+		bleDevice->AttemptConnection();
+		Startup::Reached(Startup::Milestone::Scan);
+	});
+
 	QApplication app(argc, argv);
 	QApplication::setQuitOnLastWindowClosed(false);
 
-	QFont font("Roboto");
+	QFont font("Roboto"); // matched against the installed fonts on first paint
 	app.setFont(font);
 
 	TrayWindow trayWindow;
+	trayWindow.SetAbsolutePointingHandler([](bool isEnabled) {
+		Input::SetPointingMode(isEnabled ? Input::PointingMode::Absolute : Input::PointingMode::Relative);
+	});
+	trayWindow.SetMotionPredictionHandler([](bool isEnabled) {
+		Input::SetPredictionLatency(isEnabled ? Input::PredictionLatencyMs : 0);
+	});
+	trayWindow.SetRecordTraceHandler([](bool isEnabled) {
+		Trace::SetRecording(isEnabled);
+	});
+	trayWindow.SetSaveTraceHandler([]() {
+		return Trace::Dump(Trace::DefaultPath);
+	});
+	trayWindow.SetPlotFeed(Input::Plots());
 	trayWindow.show();
+	Startup::Reached(Startup::Milestone::Tray);
 
-	Input::Initialize();
-
-	BluetoothLE::BLEDevice bleDevice = BluetoothLE::BLEDevice(0xffe0, 0xffe1, L"802048");
-	bleDevice.Connected = OnBLEConnected;
-	bleDevice.Disconnected = OnBLEDisconnected;
-	bleDevice.ReceivedData = PacketParser::OnReceivedData;
-	PacketParser::PacketReady = Input::ProcessPacket;
-	PacketParser::SetBuffer(&bleDevice.buffer);
-
-	QTimer::singleShot(0, std::bind(&BluetoothLE::BLEDevice::AttemptConnection, bleDevice));
+	pipelineStarted.get();
+	QTimer::singleShot(0, []() {
+		Logger::Info("Ready in %lld us, resident %lld KiB", ProcessInfo::MicrosecondsSinceStart(), ProcessInfo::ResidentMemoryKiB());
+	});
 	QTimer bleTimer;
 	//QObject::connect(&bleTimer, &QTimer::timeout, nullptr, )
 
-	return app.exec();
+	QTimer remoteControlTimer;
+	QObject::connect(&remoteControlTimer, &QTimer::timeout, [&remoteControl]() {
+		remoteControl.CheckTimeouts();
+	});
+	remoteControlTimer.start(RemoteControl::CommandTimeoutMs / 2);
+
+	auto exitCode = app.exec();
+	Trace::Shutdown();
+	Metrics::ClosePage();
+	Logger::Shutdown();
+	return exitCode;
 }
 
 /*
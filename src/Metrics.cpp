@@ -0,0 +1,139 @@
+#include "Metrics.h"
+#include <cstdio>
+#include <new>
+
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace Metrics
+{
+	static Page localPage;
+	static Page* writerPage = nullptr;
+	static const Page* readerPage = nullptr;
+
+#ifdef _WIN32
+	static HANDLE mappingHandle = NULL;
+
+	static void* MapPage(bool writable)
+	{
+		if (writable)
+		{
+			mappingHandle = CreateFileMappingW(INVALID_HANDLE_VALUE, NULL, PAGE_READWRITE,
+				0, sizeof(Page), SharedMemoryName);
+		}
+		else
+		{
+			mappingHandle = OpenFileMappingW(FILE_MAP_READ, FALSE, SharedMemoryName);
+		}
+
+		if (mappingHandle == NULL) return nullptr;
+
+		auto view = MapViewOfFile(mappingHandle, writable ? FILE_MAP_ALL_ACCESS : FILE_MAP_READ, 0, 0, sizeof(Page));
+		if (view == nullptr)
+		{
+			CloseHandle(mappingHandle);
+			mappingHandle = NULL;
+		}
+
+		return view;
+	}
+
+	static void UnmapPage(const void* page)
+	{
+		UnmapViewOfFile(page);
+		if (mappingHandle != NULL) CloseHandle(mappingHandle);
+		mappingHandle = NULL;
+	}
+
+	static uint64_t CurrentProcessId()
+	{
+		return GetCurrentProcessId();
+	}
+#else
+	static void* MapPage(bool writable)
+	{
+		auto fd = writable ? shm_open(SharedMemoryName, O_CREAT | O_RDWR, 0644) : shm_open(SharedMemoryName, O_RDONLY, 0);
+		if (fd < 0) return nullptr;
+
+		if (writable && ftruncate(fd, sizeof(Page)) != 0)
+		{
+			close(fd);
+			return nullptr;
+		}
+
+		auto view = mmap(nullptr, sizeof(Page), writable ? PROT_READ | PROT_WRITE : PROT_READ, MAP_SHARED, fd, 0);
+		close(fd);
+
+		return view == MAP_FAILED ? nullptr : view;
+	}
+
+	static void UnmapPage(const void* page)
+	{
+		munmap(const_cast<void*>(page), sizeof(Page));
+	}
+
+	static uint64_t CurrentProcessId()
+	{
+		return (uint64_t)getpid();
+	}
+#endif
+
+	Page* WriterPage()
+	{
+		if (writerPage) return writerPage;
+
+		auto view = MapPage(true);
+		if (view == nullptr)
+		{
+			fprintf(stderr, "Unable to map shared metrics page, metrics are process local\n");
+			view = &localPage;
+		}
+
+		writerPage = new (view) Page{};
+		writerPage->processId = CurrentProcessId();
+		writerPage->version = PageVersion;
+		std::atomic_thread_fence(std::memory_order_release);
+		writerPage->magic = PageMagic;
+
+		return writerPage;
+	}
+
+	const Page* OpenReaderPage()
+	{
+		if (readerPage) return readerPage;
+
+		auto view = static_cast<const Page*>(MapPage(false));
+		if (view == nullptr) return nullptr;
+
+		if (view->magic != PageMagic || view->version != PageVersion)
+		{
+			UnmapPage(view);
+			return nullptr;
+		}
+
+		readerPage = view;
+		return readerPage;
+	}
+
+	void ClosePage()
+	{
+		if (writerPage && writerPage != &localPage)
+		{
+			writerPage->magic = 0;
+			UnmapPage(writerPage);
+#ifndef _WIN32
+			shm_unlink(SharedMemoryName);
+#endif
+		}
+
+		if (readerPage) UnmapPage(readerPage);
+
+		writerPage = nullptr;
+		readerPage = nullptr;
+	}
+}
@@ -0,0 +1,112 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+
+// Live counters published into a named shared memory segment so that an external
+// reader (tools/MetricsReader.cpp) can sample them without touching the writers.
+namespace Metrics
+{
+#ifdef _WIN32
+	static constexpr auto SharedMemoryName = L"Local\\GestureBackendMetrics";
+#else
+	static constexpr auto SharedMemoryName = "/GestureBackendMetrics";
+#endif
+	static constexpr uint32_t PageMagic = 0x4D524247; // "GBRM"
+	static constexpr uint32_t PageVersion = 3;
+	static constexpr auto MaxReadAttempts = 64;
+
+	enum class ConnectionState : uint32_t
+	{
+		Disconnected,
+		Scanning,
+		Connecting,
+		Connected
+	};
+
+	struct ParserMetrics
+	{
+		uint64_t packets;
+		uint64_t realignments;
+		uint64_t backlogDroppedBytes;
+		uint64_t controlResponses;
+		uint32_t backlogBytes;
+		uint32_t isAligned;
+	};
+
+	struct DeviceMetrics
+	{
+		uint64_t notifications;
+		uint64_t bytesReceived;
+	};
+
+	struct ConnectionMetrics
+	{
+		ConnectionState state;
+		uint32_t connectionAttempts;
+	};
+
+	struct InputMetrics
+	{
+		uint64_t packetsProcessed;
+		uint64_t moves;
+		uint64_t clicks;
+		uint64_t scrolls;
+		uint64_t sendInputFailures;
+		uint64_t idlePackets;
+	};
+
+	// A seqlock-protected block. Each block must only be published from one thread at a time.
+	template <typename T>
+	struct alignas(64) Block
+	{
+		std::atomic<uint32_t> sequence;
+		T values;
+	};
+
+	struct Page
+	{
+		uint32_t magic;
+		uint32_t version;
+		uint64_t processId;
+		Block<ParserMetrics> parser;
+		Block<DeviceMetrics> device;
+		Block<ConnectionMetrics> connection;
+		Block<InputMetrics> input;
+	};
+
+	static_assert(std::atomic<uint32_t>::is_always_lock_free, "Seqlock sequence must be lock free across processes");
+
+	// Never null. Falls back to process-local memory when the shared segment cannot be created.
+	Page* WriterPage();
+	// Returns nullptr when no backend is running
+	const Page* OpenReaderPage();
+	void ClosePage();
+
+	template <typename T>
+	void Publish(Block<T>& block, const T& values)
+	{
+		auto sequence = block.sequence.load(std::memory_order_relaxed);
+		block.sequence.store(sequence + 1, std::memory_order_relaxed); // odd: write in progress
+		std::atomic_thread_fence(std::memory_order_release);
+		std::memcpy(&block.values, &values, sizeof(T));
+		block.sequence.store(sequence + 2, std::memory_order_release);
+	}
+
+	template <typename T>
+	bool Read(const Block<T>& block, T& values)
+	{
+		for (int i = 0; i < MaxReadAttempts; i++)
+		{
+			auto before = block.sequence.load(std::memory_order_acquire);
+			if (before & 1) continue;
+
+			std::memcpy(&values, &block.values, sizeof(T));
+			std::atomic_thread_fence(std::memory_order_acquire);
+
+			if (block.sequence.load(std::memory_order_relaxed) == before) return true;
+		}
+
+		return false;
+	}
+}
@@ -0,0 +1,71 @@
+#include "MotionPredictor.h"
+#include <algorithm>
+#include <cmath>
+
+MotionPredictor::MotionPredictor(float latencyMs) : latency(latencyMs / 1000)
+{
+}
+
+float MotionPredictor::UpdateAxis(Axis& axis, float delta, float dt)
+{
+	auto measured = delta / dt;
+
+	if (!hasSample)
+	{
+		axis = { measured, 0, 1 };
+		return measured * latency;
+	}
+
+	auto previous = axis.velocity;
+
+	// A reversal invalidates the history: follow the new direction immediately and lead again gradually
+	if (measured * previous < 0 && std::abs(previous) > ReversalSpeed)
+	{
+		axis = { measured, 0, 0 };
+		return 0;
+	}
+
+	axis.velocity += VelocitySmoothing * (measured - axis.velocity);
+	axis.acceleration += AccelerationSmoothing * ((axis.velocity - previous) / dt - axis.acceleration);
+
+	// Braking hard means a stop is coming that the delayed samples have not shown yet
+	auto isStopping = axis.acceleration * axis.velocity < 0
+		&& std::abs(axis.acceleration) * StoppingHorizon > std::abs(axis.velocity);
+	if (isStopping)
+		axis.gain *= DecelerationFalloff;
+	else
+		axis.gain = std::min(1.0f, axis.gain + 1 / RecoverySamples);
+
+	// Deceleration shortens the lead but never turns it around
+	auto lead = axis.velocity * latency + 0.5f * axis.acceleration * latency * latency;
+	auto maxLead = axis.velocity * latency * MaxLeadFactor;
+	lead = maxLead >= 0 ? std::clamp(lead, 0.0f, maxLead) : std::clamp(lead, maxLead, 0.0f);
+
+	return axis.gain * lead;
+}
+
+void MotionPredictor::Update(float dx, float dy, float dt, float& offsetX, float& offsetY)
+{
+	if (latency <= 0 || dt <= 0)
+	{
+		offsetX = 0;
+		offsetY = 0;
+		return;
+	}
+
+	offsetX = UpdateAxis(axes[0], dx, dt);
+	offsetY = UpdateAxis(axes[1], dy, dt);
+	hasSample = true;
+}
+
+void MotionPredictor::Reset()
+{
+	axes[0] = {};
+	axes[1] = {};
+	hasSample = false;
+}
+
+void MotionPredictor::SetLatency(float latencyMs)
+{
+	latency = latencyMs / 1000;
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+// Extrapolates cursor motion ahead by the transport latency. Velocity and acceleration are tracked
+// per axis with an alpha-beta filter over the cursor deltas, and the lead is dropped on a direction
+// reversal or hard braking and faded back in, so that stopping or turning around does not overshoot.
+// That holds up to about 20 ms: the delayed samples show a stop too late to brake a longer lead.
+class MotionPredictor
+{
+private:
+	struct Axis
+	{
+		float velocity; // pixels per second
+		float acceleration; // pixels per second squared
+		float gain; // 0 right after a reversal, recovers to 1
+	};
+
+	Axis axes[2] = {};
+	float latency;
+	bool hasSample = false;
+
+	float UpdateAxis(Axis& axis, float delta, float dt);
+public:
+	static constexpr auto VelocitySmoothing = 0.5f;
+	static constexpr auto AccelerationSmoothing = 0.2f;
+	static constexpr auto RecoverySamples = 8.0f; // samples until full lead is restored after a reversal
+	static constexpr auto StoppingHorizon = 0.2f; // seconds; deceleration that would stop within this backs off
+	static constexpr auto DecelerationFalloff = 0.7f; // lead retained per sample while stopping
+	static constexpr auto ReversalSpeed = 20.0f; // pixels per second; slower motion is not treated as a reversal
+	static constexpr auto MaxLeadFactor = 1.5f; // the lead never exceeds this multiple of velocity * latency
+
+	explicit MotionPredictor(float latencyMs);
+
+	// Takes this sample's cursor delta and returns the offset to add to the true cursor position
+	void Update(float dx, float dy, float dt, float& offsetX, float& offsetY);
+	void Reset();
+	void SetLatency(float latencyMs);
+};
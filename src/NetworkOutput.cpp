@@ -0,0 +1,707 @@
+#include "NetworkOutput.h"
+#include "Logger.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+#ifdef _WIN32
+#include <WinSock2.h>
+#include <WS2tcpip.h>
+#pragma comment(lib, "Ws2_32.lib")
+#else
+#include <netdb.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+namespace NetworkOutput
+{
+	static constexpr uint8_t Magic[2] = { 'G', 'F' };
+	static constexpr uint8_t Version = 4;
+	static constexpr auto CountOffset = 3;
+	static constexpr auto ButtonCount = 3;
+	static constexpr auto CoordinateScale = 0xffff;
+
+	static constexpr size_t EventSize(EventType type)
+	{
+		return type == EventType::Move ? 5 : type == EventType::Key ? 4 : 3;
+	}
+
+	static void Put16(uint8_t* data, uint16_t value)
+	{
+		data[0] = (uint8_t)value;
+		data[1] = (uint8_t)(value >> 8);
+	}
+
+	static void Put32(uint8_t* data, uint32_t value)
+	{
+		for (int i = 0; i < 4; i++) data[i] = (uint8_t)(value >> (8 * i));
+	}
+
+	static void Put64(uint8_t* data, uint64_t value)
+	{
+		for (int i = 0; i < 8; i++) data[i] = (uint8_t)(value >> (8 * i));
+	}
+
+	static uint16_t Get16(const uint8_t* data)
+	{
+		return (uint16_t)(data[0] | data[1] << 8);
+	}
+
+	static uint32_t Get32(const uint8_t* data)
+	{
+		uint32_t value = 0;
+		for (int i = 0; i < 4; i++) value |= (uint32_t)data[i] << (8 * i);
+		return value;
+	}
+
+	static uint64_t Get64(const uint8_t* data)
+	{
+		uint64_t value = 0;
+		for (int i = 0; i < 8; i++) value |= (uint64_t)data[i] << (8 * i);
+		return value;
+	}
+
+	static uint16_t ToCoordinate(float fraction)
+	{
+		return (uint16_t)std::lround(std::clamp(fraction, 0.0f, 1.0f) * CoordinateScale);
+	}
+
+	uint64_t NowMicroseconds()
+	{
+		return (uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(
+			std::chrono::steady_clock::now().time_since_epoch()).count();
+	}
+
+	bool Decode(const uint8_t* data, size_t length, Header& header, Event* events)
+	{
+		if (length < HeaderSize || data[0] != Magic[0] || data[1] != Magic[1] || data[2] != Version) return false;
+
+		header.eventCount = data[CountOffset];
+		header.sequence = Get32(data + 4);
+		header.senderTimeUs = Get64(data + 8);
+		header.heldButtons = data[16];
+		header.epoch = Get64(data + 17);
+		if (header.eventCount > MaxEvents) return false;
+
+		size_t offset = HeaderSize;
+		for (int i = 0; i < header.eventCount; i++)
+		{
+			if (offset >= length) return false;
+
+			auto type = (EventType)data[offset];
+			if (type > EventType::Key || offset + EventSize(type) > length) return false;
+
+			auto& event = events[i];
+			auto payload = data + offset + 1;
+			event.type = type;
+
+			switch (type)
+			{
+			case EventType::Move:
+				event.x = Get16(payload) / (float)CoordinateScale;
+				event.y = Get16(payload + 2) / (float)CoordinateScale;
+				break;
+			case EventType::Button:
+				if (payload[0] >= ButtonCount) return false;
+				event.button = (PointerOutput::MouseButton)payload[0];
+				event.isDown = payload[1] != 0;
+				break;
+			case EventType::Scroll:
+				event.amount = (int16_t)Get16(payload);
+				break;
+			case EventType::Key:
+				event.key = Get16(payload);
+				event.isDown = payload[2] != 0;
+				break;
+			}
+
+			offset += EventSize(type);
+		}
+
+		return offset == length;
+	}
+
+	static constexpr uint32_t Sha256Initial[8] = {
+		0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19 };
+
+	static constexpr uint32_t Sha256Rounds[64] = {
+		0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+		0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+		0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+		0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+		0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+		0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+		0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+		0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2 };
+
+	static constexpr auto Sha256BlockSize = 64;
+	static constexpr auto Sha256DigestSize = 32;
+
+	static uint32_t RotateRight(uint32_t value, int bits)
+	{
+		return value >> bits | value << (32 - bits);
+	}
+
+	static void Sha256Block(uint32_t state[8], const uint8_t* block)
+	{
+		uint32_t w[64];
+		for (int i = 0; i < 16; i++)
+		{
+			w[i] = (uint32_t)block[4 * i] << 24 | (uint32_t)block[4 * i + 1] << 16 | (uint32_t)block[4 * i + 2] << 8 | block[4 * i + 3];
+		}
+		for (int i = 16; i < 64; i++)
+		{
+			auto s0 = RotateRight(w[i - 15], 7) ^ RotateRight(w[i - 15], 18) ^ w[i - 15] >> 3;
+			auto s1 = RotateRight(w[i - 2], 17) ^ RotateRight(w[i - 2], 19) ^ w[i - 2] >> 10;
+			w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+		}
+
+		auto a = state[0], b = state[1], c = state[2], d = state[3];
+		auto e = state[4], f = state[5], g = state[6], h = state[7];
+		for (int i = 0; i < 64; i++)
+		{
+			auto t1 = h + (RotateRight(e, 6) ^ RotateRight(e, 11) ^ RotateRight(e, 25)) + ((e & f) ^ (~e & g)) + Sha256Rounds[i] + w[i];
+			auto t2 = (RotateRight(a, 2) ^ RotateRight(a, 13) ^ RotateRight(a, 22)) + ((a & b) ^ (a & c) ^ (b & c));
+			h = g;
+			g = f;
+			f = e;
+			e = d + t1;
+			d = c;
+			c = b;
+			b = a;
+			a = t1 + t2;
+		}
+
+		state[0] += a; state[1] += b; state[2] += c; state[3] += d;
+		state[4] += e; state[5] += f; state[6] += g; state[7] += h;
+	}
+
+	// Hashes data after the prefixBlocks already folded into start
+	static void Sha256(const uint32_t start[8], int prefixBlocks, const uint8_t* data, size_t length, uint8_t* digest)
+	{
+		uint32_t state[8];
+		std::copy(start, start + 8, state);
+
+		auto whole = length / Sha256BlockSize * Sha256BlockSize;
+		for (size_t offset = 0; offset < whole; offset += Sha256BlockSize) Sha256Block(state, data + offset);
+
+		// The rest, a 1 bit, zeros and the length in bits, in one or two blocks
+		uint8_t tail[2 * Sha256BlockSize] = {};
+		auto rest = length - whole;
+		std::copy(data + whole, data + length, tail);
+		tail[rest] = 0x80;
+		size_t tailSize = rest + 9 <= Sha256BlockSize ? Sha256BlockSize : 2 * Sha256BlockSize;
+		auto bits = ((uint64_t)prefixBlocks * Sha256BlockSize + length) * 8;
+		for (int i = 0; i < 8; i++) tail[tailSize - 1 - i] = (uint8_t)(bits >> (8 * i));
+		for (size_t offset = 0; offset < tailSize; offset += Sha256BlockSize) Sha256Block(state, tail + offset);
+
+		for (int i = 0; i < 8; i++)
+		{
+			for (int j = 0; j < 4; j++) digest[4 * i + j] = (uint8_t)(state[i] >> (24 - 8 * j));
+		}
+	}
+
+	void Authenticator::SetSecret(const std::string& secret)
+	{
+		// A key longer than a block is hashed first, a shorter one padded with zeros
+		uint8_t key[Sha256BlockSize] = {};
+		if (secret.size() > Sha256BlockSize)
+		{
+			Sha256(Sha256Initial, 0, (const uint8_t*)secret.data(), secret.size(), key);
+		}
+		else
+		{
+			std::copy(secret.begin(), secret.end(), key);
+		}
+
+		uint8_t inner[Sha256BlockSize], outer[Sha256BlockSize];
+		for (int i = 0; i < Sha256BlockSize; i++)
+		{
+			inner[i] = key[i] ^ 0x36;
+			outer[i] = key[i] ^ 0x5c;
+		}
+
+		std::copy(Sha256Initial, Sha256Initial + 8, innerState);
+		std::copy(Sha256Initial, Sha256Initial + 8, outerState);
+		Sha256Block(innerState, inner);
+		Sha256Block(outerState, outer);
+		hasSecret = !secret.empty();
+	}
+
+	bool Authenticator::HasSecret() const
+	{
+		return hasSecret;
+	}
+
+	void Authenticator::Tag(const uint8_t* data, size_t length, uint8_t* tag) const
+	{
+		uint8_t innerDigest[Sha256DigestSize], digest[Sha256DigestSize];
+		Sha256(innerState, 1, data, length, innerDigest);
+		Sha256(outerState, 1, innerDigest, sizeof(innerDigest), digest);
+		std::copy(digest, digest + TagSize, tag);
+	}
+
+	bool Authenticator::Verify(const uint8_t* data, size_t length, const uint8_t* tag) const
+	{
+		uint8_t expected[TagSize];
+		Tag(data, length, expected);
+
+		uint8_t difference = 0;
+		for (int i = 0; i < TagSize; i++) difference |= expected[i] ^ tag[i];
+		return hasSecret && difference == 0;
+	}
+
+#ifdef _WIN32
+	static bool StartSockets()
+	{
+		WSADATA data;
+		return WSAStartup(MAKEWORD(2, 2), &data) == 0;
+	}
+
+	static void StopSockets()
+	{
+		WSACleanup();
+	}
+
+	static void CloseSocket(intptr_t handle)
+	{
+		closesocket((SOCKET)handle);
+	}
+
+	static bool WaitReadable(intptr_t handle, int timeoutMs)
+	{
+		WSAPOLLFD descriptor{ (SOCKET)handle, POLLRDNORM, 0 };
+		return WSAPoll(&descriptor, 1, timeoutMs) > 0;
+	}
+#else
+	static bool StartSockets()
+	{
+		return true;
+	}
+
+	static void StopSockets()
+	{
+	}
+
+	static void CloseSocket(intptr_t handle)
+	{
+		close((int)handle);
+	}
+
+	static bool WaitReadable(intptr_t handle, int timeoutMs)
+	{
+		pollfd descriptor{ (int)handle, POLLIN, 0 };
+		return poll(&descriptor, 1, timeoutMs) > 0;
+	}
+#endif
+
+	static intptr_t OpenSocket(const std::string& host, uint16_t port, int family)
+	{
+		addrinfo hints{};
+		hints.ai_family = family;
+		hints.ai_socktype = SOCK_DGRAM;
+		hints.ai_flags = AI_PASSIVE;
+
+		addrinfo* addresses = nullptr;
+		auto service = std::to_string(port);
+		if (getaddrinfo(host.empty() ? nullptr : host.c_str(), service.c_str(), &hints, &addresses) != 0) return -1;
+
+		intptr_t handle = -1;
+		for (auto address = addresses; address && handle == -1; address = address->ai_next)
+		{
+			handle = (intptr_t)socket(address->ai_family, address->ai_socktype, address->ai_protocol);
+			if (handle == -1) continue;
+
+			int isV6Only = 0; // also accept IPv4 senders
+			if (address->ai_family == AF_INET6) setsockopt(handle, IPPROTO_IPV6, IPV6_V6ONLY, (const char*)&isV6Only, sizeof(isV6Only));
+			if (bind(handle, address->ai_addr, (int)address->ai_addrlen) != 0)
+			{
+				CloseSocket(handle);
+				handle = -1;
+			}
+		}
+
+		freeaddrinfo(addresses);
+		return handle;
+	}
+
+	// A UDP socket bound to port on host, or on all interfaces when host is empty
+	static intptr_t OpenSocket(const std::string& host, uint16_t port)
+	{
+		if (!StartSockets()) return -1;
+
+		// Dual stack where available, IPv4 only otherwise
+		auto isAllInterfaces = host.empty();
+		auto handle = OpenSocket(host, port, isAllInterfaces ? AF_INET6 : AF_UNSPEC);
+		if (handle == -1 && isAllInterfaces) handle = OpenSocket(host, port, AF_INET);
+
+		if (handle == -1)
+		{
+			Logger::Error("Could not open forwarding socket on port %lld", (long long)port);
+			StopSockets();
+		}
+		return handle;
+	}
+
+	Sender::~Sender()
+	{
+		Close();
+	}
+
+	bool Resolve(const std::string& host, uint16_t port, Destination& destination)
+	{
+		destination.length = 0;
+		if (host.empty() || !StartSockets()) return false;
+
+		addrinfo hints{};
+		hints.ai_family = AF_UNSPEC;
+		hints.ai_socktype = SOCK_DGRAM;
+
+		addrinfo* addresses = nullptr;
+		auto service = std::to_string(port);
+		if (getaddrinfo(host.c_str(), service.c_str(), &hints, &addresses) == 0)
+		{
+			if (addresses->ai_addrlen <= sizeof(destination.address))
+			{
+				std::copy((const uint8_t*)addresses->ai_addr, (const uint8_t*)addresses->ai_addr + addresses->ai_addrlen, destination.address);
+				destination.length = (int)addresses->ai_addrlen;
+			}
+			freeaddrinfo(addresses);
+		}
+		StopSockets();
+
+		if (destination.length == 0) Logger::Error("Could not resolve the forwarding host");
+		return destination.length != 0;
+	}
+
+	bool Sender::Open(const std::string& host, uint16_t port, const std::string& secret)
+	{
+		Destination destination;
+		if (!Resolve(host, port, destination))
+		{
+			Close();
+			return false;
+		}
+		return Open(destination, secret);
+	}
+
+	bool Sender::Open(const Destination& destination, const std::string& secret)
+	{
+		Close();
+		if (destination.length == 0) return false;
+		if (secret.empty())
+		{
+			Logger::Error("Not forwarding input without a shared secret");
+			return false;
+		}
+		if (!StartSockets()) return false;
+
+		auto address = (const sockaddr*)destination.address;
+		socketHandle = (intptr_t)socket(address->sa_family, SOCK_DGRAM, IPPROTO_UDP);
+		if (socketHandle != -1 && connect(socketHandle, address, destination.length) != 0)
+		{
+			CloseSocket(socketHandle);
+			socketHandle = -1;
+		}
+		if (socketHandle == -1)
+		{
+			Logger::Error("Could not open forwarding socket");
+			StopSockets();
+			return false;
+		}
+		authenticator.SetSecret(secret);
+
+		// A new epoch for every session, later than the last one even if reopened within the same us
+		auto now = (uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(
+			std::chrono::system_clock::now().time_since_epoch()).count();
+		epoch = std::max(now, epoch + 1);
+		sequence = 0;
+
+		auto port = address->sa_family == AF_INET6 ? ((const sockaddr_in6*)address)->sin6_port : ((const sockaddr_in*)address)->sin_port;
+		Logger::Info("Forwarding input to port %lld", (long long)ntohs(port));
+		return true;
+	}
+
+	void Sender::Close()
+	{
+		if (socketHandle == -1) return;
+
+		// Leave no button held down on the other machine
+		for (int button = 0; button < ButtonCount; button++)
+		{
+			if (heldButtons & (1 << button)) Button((PointerOutput::MouseButton)button, false);
+		}
+		Flush();
+
+		CloseSocket(socketHandle);
+		StopSockets();
+		socketHandle = -1;
+		length = HeaderSize;
+		eventCount = 0;
+		lastMoveOffset = 0;
+	}
+
+	bool Sender::IsOpen() const
+	{
+		return socketHandle != -1;
+	}
+
+	uint8_t* Sender::Reserve(EventType type, size_t size)
+	{
+		if (eventCount == MaxEvents) Flush();
+
+		auto event = datagram + length;
+		event[0] = (uint8_t)type;
+		length += size;
+		eventCount++;
+		return event + 1;
+	}
+
+	void Sender::Move(float x, float y)
+	{
+		if (lastMoveOffset != 0)
+		{
+			movesCoalesced++;
+		}
+		else
+		{
+			Reserve(EventType::Move, EventSize(EventType::Move));
+			lastMoveOffset = length - EventSize(EventType::Move);
+		}
+
+		Put16(datagram + lastMoveOffset + 1, ToCoordinate(x));
+		Put16(datagram + lastMoveOffset + 3, ToCoordinate(y));
+	}
+
+	void Sender::Button(PointerOutput::MouseButton button, bool isDown)
+	{
+		auto payload = Reserve(EventType::Button, EventSize(EventType::Button));
+		payload[0] = (uint8_t)button;
+		payload[1] = isDown;
+		lastMoveOffset = 0;
+
+		auto bit = (uint8_t)(1 << (int)button);
+		heldButtons = isDown ? heldButtons | bit : heldButtons & ~bit;
+	}
+
+	void Sender::Scroll(int amount)
+	{
+		auto payload = Reserve(EventType::Scroll, EventSize(EventType::Scroll));
+		Put16(payload, (uint16_t)(int16_t)std::clamp(amount, (int)INT16_MIN, (int)INT16_MAX));
+		lastMoveOffset = 0;
+	}
+
+	void Sender::Key(uint16_t key, bool isDown)
+	{
+		auto payload = Reserve(EventType::Key, EventSize(EventType::Key));
+		Put16(payload, key);
+		payload[2] = isDown;
+		lastMoveOffset = 0;
+	}
+
+	bool Sender::Flush()
+	{
+		if (eventCount == 0 || socketHandle == -1) return true;
+
+		datagram[0] = Magic[0];
+		datagram[1] = Magic[1];
+		datagram[2] = Version;
+		datagram[CountOffset] = (uint8_t)eventCount;
+		Put32(datagram + 4, sequence++);
+		Put64(datagram + 8, NowMicroseconds());
+		datagram[16] = heldButtons;
+		Put64(datagram + 17, epoch);
+		authenticator.Tag(datagram, length, datagram + length);
+
+		auto size = (int)(length + TagSize);
+		auto isSent = send(socketHandle, (const char*)datagram, size, 0) == size;
+		length = HeaderSize;
+		eventCount = 0;
+		lastMoveOffset = 0;
+
+		// Log once per run of failures, for example while the receiver's host is unreachable
+		if (!isSent && !isFailing) Logger::Warning("Could not send forwarded input");
+		isFailing = !isSent;
+		if (isSent) datagramsSent++;
+		return isSent;
+	}
+
+	uint64_t Sender::DatagramsSent() const
+	{
+		return datagramsSent;
+	}
+
+	uint64_t Sender::MovesCoalesced() const
+	{
+		return movesCoalesced;
+	}
+
+	Receiver::~Receiver()
+	{
+		Close();
+	}
+
+	// The address as IPv6, with IPv4 mapped, so that senders compare the same on any socket
+	static bool AddressBytes(const sockaddr* address, uint8_t* bytes)
+	{
+		if (address->sa_family == AF_INET6)
+		{
+			auto& v6 = ((const sockaddr_in6*)address)->sin6_addr;
+			std::copy((const uint8_t*)&v6, (const uint8_t*)&v6 + 16, bytes);
+			return true;
+		}
+		if (address->sa_family != AF_INET) return false;
+
+		auto v4 = (const uint8_t*)&((const sockaddr_in*)address)->sin_addr;
+		std::fill(bytes, bytes + 10, 0);
+		bytes[10] = bytes[11] = 0xff;
+		std::copy(v4, v4 + 4, bytes + 12);
+		return true;
+	}
+
+	static bool ResolveAddress(const std::string& host, uint8_t* bytes)
+	{
+		addrinfo hints{};
+		hints.ai_family = AF_UNSPEC;
+		hints.ai_socktype = SOCK_DGRAM;
+
+		addrinfo* addresses = nullptr;
+		if (getaddrinfo(host.c_str(), nullptr, &hints, &addresses) != 0) return false;
+		auto isResolved = AddressBytes(addresses->ai_addr, bytes);
+		freeaddrinfo(addresses);
+		return isResolved;
+	}
+
+	bool Receiver::Open(const std::string& bindAddress, uint16_t port, const std::string& secret, const std::string& allowedSender)
+	{
+		Close();
+		if (secret.empty() || (bindAddress.empty() && allowedSender.empty()))
+		{
+			Logger::Error("Receiving forwarded input needs a shared secret, and a bind address or an allowed sender");
+			return false;
+		}
+
+		hasAllowedSender = !allowedSender.empty();
+		if (hasAllowedSender)
+		{
+			auto isResolved = StartSockets() && ResolveAddress(allowedSender, allowedAddress);
+			StopSockets();
+			if (!isResolved)
+			{
+				Logger::Error("Could not resolve the allowed sender");
+				return false;
+			}
+		}
+
+		socketHandle = OpenSocket(bindAddress, port);
+		authenticator.SetSecret(secret);
+		return socketHandle != -1;
+	}
+
+	void Receiver::Close()
+	{
+		if (socketHandle == -1) return;
+
+		CloseSocket(socketHandle);
+		StopSockets();
+		socketHandle = -1;
+		hasSequence = false;
+	}
+
+	bool Receiver::Poll(int timeoutMs, const EventHandler& handler, Header* header)
+	{
+		if (socketHandle == -1 || !WaitReadable(socketHandle, timeoutMs)) return false;
+
+		uint8_t data[MaxDatagramSize + 1]; // one spare byte to detect oversized datagrams
+		sockaddr_storage from{};
+		socklen_t fromLength = sizeof(from);
+		auto received = recvfrom(socketHandle, (char*)data, (int)sizeof(data), 0, (sockaddr*)&from, &fromLength);
+		if (received <= 0) return false;
+
+		uint8_t fromAddress[16];
+		if (hasAllowedSender && (!AddressBytes((const sockaddr*)&from, fromAddress) || !std::equal(fromAddress, fromAddress + 16, allowedAddress)))
+		{
+			statistics.unauthenticated++;
+			return false;
+		}
+
+		if (received < HeaderSize + TagSize)
+		{
+			statistics.malformed++;
+			return false;
+		}
+
+		auto length = (size_t)received - TagSize;
+		if (!authenticator.Verify(data, length, data + length))
+		{
+			statistics.unauthenticated++;
+			return false;
+		}
+
+		Header decoded;
+		Event events[MaxEvents];
+		if (!Decode(data, length, decoded, events))
+		{
+			statistics.malformed++;
+			return false;
+		}
+
+		// A restarted sender comes back with a larger epoch; anything from an earlier one is a replay
+		if (decoded.epoch < epoch)
+		{
+			statistics.late++;
+			return false;
+		}
+		if (decoded.epoch > epoch) hasSequence = false;
+
+		// Signed difference so that the sequence may wrap
+		auto gap = (int32_t)(decoded.sequence - lastSequence);
+		if (hasSequence && gap <= 0)
+		{
+			statistics.late++;
+			return false;
+		}
+		if (hasSequence && gap > 1) statistics.lost += gap - 1;
+		hasSequence = true;
+		epoch = decoded.epoch;
+		lastSequence = decoded.sequence;
+
+		statistics.datagrams++;
+		statistics.events += decoded.eventCount;
+
+		for (int i = 0; i < decoded.eventCount; i++)
+		{
+			if (events[i].type == EventType::Button)
+			{
+				auto bit = (uint8_t)(1 << (int)events[i].button);
+				heldButtons = events[i].isDown ? heldButtons | bit : heldButtons & ~bit;
+			}
+			handler(events[i]);
+		}
+
+		for (int button = 0; button < ButtonCount; button++)
+		{
+			auto bit = (uint8_t)(1 << button);
+			if ((heldButtons & bit) == (decoded.heldButtons & bit)) continue;
+
+			Event event{};
+			event.type = EventType::Button;
+			event.button = (PointerOutput::MouseButton)button;
+			event.isDown = (decoded.heldButtons & bit) != 0;
+			heldButtons ^= bit;
+			statistics.buttonsReconciled++;
+			handler(event);
+		}
+
+		if (header) *header = decoded;
+		return true;
+	}
+
+	const ReceiverStatistics& Receiver::Statistics() const
+	{
+		return statistics;
+	}
+}
@@ -0,0 +1,172 @@
+#pragma once
+#include "PointerOutput.h"
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+
+// Forwards processed pointer events to another machine over UDP. Each datagram is a header
+// followed by a batch of events, all fields little endian:
+//
+//   header  magic "GF", version, event count, sequence (4), sender time in us (8), held buttons,
+//           session epoch (8)
+//   move    type 0, x (2), y (2)  position as a fraction of the screen, 0..0xffff
+//   button  type 1, button, 1 if down
+//   scroll  type 2, amount (2, signed)
+//   key     type 3, Windows virtual key code (2), 1 if down
+//   tag     first TagSize bytes of HMAC-SHA256 over everything before it, keyed with the shared secret
+//
+// Moves are absolute, so a lost datagram only delays the cursor. The held buttons in every header
+// let the receiver release a button whose up event was lost; keys are not reconciled. The receiver
+// drops a datagram whose tag does not match before looking at its events. The sender picks a new
+// epoch, its wall clock in us, each time it opens and numbers datagrams from 0 within it; the
+// receiver takes a larger epoch as a restarted sender and drops a smaller one, or a sequence that
+// does not move forward within the current epoch, so a captured session cannot be replayed. The
+// first epoch after the receiver opens is taken as it comes.
+namespace NetworkOutput
+{
+	static constexpr uint16_t DefaultPort = 47800;
+	static constexpr auto MaxEvents = 32;
+	static constexpr auto HeaderSize = 25;
+	static constexpr auto MaxEventSize = 5;
+	static constexpr auto TagSize = 16;
+	static constexpr auto MaxDatagramSize = HeaderSize + MaxEvents * MaxEventSize + TagSize;
+
+	enum class EventType : uint8_t
+	{
+		Move,
+		Button,
+		Scroll,
+		Key
+	};
+
+	struct Event
+	{
+		EventType type;
+		float x; // Move, 0..1
+		float y;
+		PointerOutput::MouseButton button; // Button
+		bool isDown;
+		int amount; // Scroll
+		uint16_t key; // Key, with isDown
+	};
+
+	struct Header
+	{
+		uint32_t sequence;
+		uint64_t senderTimeUs;
+		uint8_t heldButtons; // bit per MouseButton
+		uint64_t epoch;
+		int eventCount;
+	};
+
+	// Microseconds on the steady clock, comparable between processes on the same machine
+	uint64_t NowMicroseconds();
+
+	// Returns false for anything that is not a complete, well formed datagram. length excludes the tag.
+	bool Decode(const uint8_t* data, size_t length, Header& header, Event* events);
+
+	// HMAC-SHA256 keyed with the shared secret, with the padded key blocks hashed once up front
+	class Authenticator
+	{
+	public:
+		void SetSecret(const std::string& secret);
+		bool HasSecret() const;
+
+		void Tag(const uint8_t* data, size_t length, uint8_t* tag) const; // writes TagSize bytes
+		bool Verify(const uint8_t* data, size_t length, const uint8_t* tag) const; // in constant time
+	private:
+		uint32_t innerState[8] = {};
+		uint32_t outerState[8] = {};
+		bool hasSecret = false;
+	};
+
+	// A resolved address to send to, so that opening a sender does no name lookup
+	struct Destination
+	{
+		alignas(8) uint8_t address[128] = {}; // sockaddr_storage
+		int length = 0; // 0 when not resolved
+	};
+
+	// Blocks on the name lookup. On failure destination is left unresolved.
+	bool Resolve(const std::string& host, uint16_t port, Destination& destination);
+
+	class Sender
+	{
+	public:
+		~Sender();
+
+		// Both refuse an empty secret. The second does not block, the first resolves host first.
+		bool Open(const std::string& host, uint16_t port, const std::string& secret);
+		bool Open(const Destination& destination, const std::string& secret);
+		void Close();
+		bool IsOpen() const;
+
+		// Queued until Flush. A move replaces a move queued directly before it.
+		void Move(float x, float y);
+		void Button(PointerOutput::MouseButton button, bool isDown);
+		void Scroll(int amount);
+		void Key(uint16_t key, bool isDown);
+
+		// Sends the queued events as one datagram, if there are any
+		bool Flush();
+
+		uint64_t DatagramsSent() const;
+		uint64_t MovesCoalesced() const;
+	private:
+		intptr_t socketHandle = -1;
+		Authenticator authenticator;
+		uint8_t datagram[MaxDatagramSize];
+		size_t length = HeaderSize;
+		int eventCount = 0;
+		size_t lastMoveOffset = 0; // 0 when the last queued event is not a move
+		uint8_t heldButtons = 0;
+		uint32_t sequence = 0;
+		uint64_t epoch = 0;
+		uint64_t datagramsSent = 0;
+		uint64_t movesCoalesced = 0;
+		bool isFailing = false;
+
+		uint8_t* Reserve(EventType type, size_t size);
+	};
+
+	struct ReceiverStatistics
+	{
+		uint64_t datagrams;
+		uint64_t events;
+		uint64_t lost; // sequence numbers skipped
+		uint64_t late; // duplicated, reordered or from an earlier epoch, dropped
+		uint64_t malformed;
+		uint64_t unauthenticated; // from a sender not allowed, or with a tag that does not match, dropped
+		uint64_t buttonsReconciled; // transitions recovered from the held buttons
+	};
+
+	class Receiver
+	{
+	public:
+		using EventHandler = std::function<void(const Event& event)>;
+
+		~Receiver();
+
+		// Needs the shared secret, and bindAddress, allowedSender or both. With only allowedSender it
+		// binds to all interfaces; with only bindAddress it takes datagrams from any sender.
+		bool Open(const std::string& bindAddress, uint16_t port, const std::string& secret, const std::string& allowedSender = "");
+		void Close();
+
+		// Waits up to timeoutMs for a datagram and passes its events to handler. Returns false on
+		// timeout, error, or when the datagram was dropped.
+		bool Poll(int timeoutMs, const EventHandler& handler, Header* header = nullptr);
+
+		const ReceiverStatistics& Statistics() const;
+	private:
+		intptr_t socketHandle = -1;
+		Authenticator authenticator;
+		uint8_t allowedAddress[16] = {}; // IPv4 as mapped into IPv6
+		bool hasAllowedSender = false;
+		bool hasSequence = false;
+		uint64_t epoch = 0; // kept across Close, so a reopened receiver still drops older sessions
+		uint32_t lastSequence = 0;
+		uint8_t heldButtons = 0;
+		ReceiverStatistics statistics{};
+	};
+}
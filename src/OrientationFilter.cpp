@@ -0,0 +1,102 @@
+#include "OrientationFilter.h"
+#include <cmath>
+
+OrientationFilter::OrientationFilter(float beta) : beta(beta)
+{
+}
+
+static float InverseSqrt(float x)
+{
+	return 1.0f / std::sqrt(x);
+}
+
+// Starts from the attitude implied by gravity instead of waiting for the filter to converge
+void OrientationFilter::InitializeFromGravity(Vector3 a)
+{
+	auto roll = std::atan2(a.Y, a.Z);
+	auto pitch = std::atan2(-a.X, std::sqrt(a.Y * a.Y + a.Z * a.Z));
+
+	auto cr = std::cos(roll * 0.5f), sr = std::sin(roll * 0.5f);
+	auto cp = std::cos(pitch * 0.5f), sp = std::sin(pitch * 0.5f);
+
+	orientation = { cr * cp, sr * cp, cr * sp, -sr * sp };
+	isInitialized = true;
+}
+
+void OrientationFilter::Update(Vector3 g, Vector3 a, float dt)
+{
+	auto hasGravity = a.X != 0 || a.Y != 0 || a.Z != 0;
+
+	if (!isInitialized && hasGravity) InitializeFromGravity(a);
+
+	auto [q0, q1, q2, q3] = orientation;
+
+	// Rate of change from the gyroscope
+	auto qDot0 = 0.5f * (-q1 * g.X - q2 * g.Y - q3 * g.Z);
+	auto qDot1 = 0.5f * (q0 * g.X + q2 * g.Z - q3 * g.Y);
+	auto qDot2 = 0.5f * (q0 * g.Y - q1 * g.Z + q3 * g.X);
+	auto qDot3 = 0.5f * (q0 * g.Z + q1 * g.Y - q2 * g.X);
+
+	if (hasGravity)
+	{
+		auto norm = InverseSqrt(a.X * a.X + a.Y * a.Y + a.Z * a.Z);
+		auto ax = a.X * norm, ay = a.Y * norm, az = a.Z * norm;
+
+		auto _2q0 = 2.0f * q0, _2q1 = 2.0f * q1, _2q2 = 2.0f * q2, _2q3 = 2.0f * q3;
+		auto _4q0 = 4.0f * q0, _4q1 = 4.0f * q1, _4q2 = 4.0f * q2;
+		auto _8q1 = 8.0f * q1, _8q2 = 8.0f * q2;
+		auto q0q0 = q0 * q0, q1q1 = q1 * q1, q2q2 = q2 * q2, q3q3 = q3 * q3;
+
+		// Gradient descent step towards the orientation where measured acceleration points along world +Z
+		auto s0 = _4q0 * q2q2 + _2q2 * ax + _4q0 * q1q1 - _2q1 * ay;
+		auto s1 = _4q1 * q3q3 - _2q3 * ax + 4.0f * q0q0 * q1 - _2q0 * ay - _4q1 + _8q1 * q1q1 + _8q1 * q2q2 + _4q1 * az;
+		auto s2 = 4.0f * q0q0 * q2 + _2q0 * ax + _4q2 * q3q3 - _2q3 * ay - _4q2 + _8q2 * q1q1 + _8q2 * q2q2 + _4q2 * az;
+		auto s3 = 4.0f * q1q1 * q3 - _2q1 * ax + 4.0f * q2q2 * q3 - _2q2 * ay;
+
+		auto stepSquared = s0 * s0 + s1 * s1 + s2 * s2 + s3 * s3;
+		if (stepSquared > 0)
+		{
+			auto stepNorm = InverseSqrt(stepSquared);
+			qDot0 -= beta * s0 * stepNorm;
+			qDot1 -= beta * s1 * stepNorm;
+			qDot2 -= beta * s2 * stepNorm;
+			qDot3 -= beta * s3 * stepNorm;
+		}
+	}
+
+	q0 += qDot0 * dt;
+	q1 += qDot1 * dt;
+	q2 += qDot2 * dt;
+	q3 += qDot3 * dt;
+
+	auto norm = InverseSqrt(q0 * q0 + q1 * q1 + q2 * q2 + q3 * q3);
+	orientation = { q0 * norm, q1 * norm, q2 * norm, q3 * norm };
+}
+
+void OrientationFilter::Reset()
+{
+	orientation = { 1, 0, 0, 0 };
+	isInitialized = false;
+}
+
+Quaternion OrientationFilter::Orientation() const
+{
+	return orientation;
+}
+
+// Rotates a vector from the remote's frame into the world frame
+Vector3 OrientationFilter::Rotate(Vector3 v) const
+{
+	auto [w, x, y, z] = orientation;
+
+	// v' = v + 2w(u x v) + 2u x (u x v), with u = (x, y, z)
+	auto cx = y * v.Z - z * v.Y;
+	auto cy = z * v.X - x * v.Z;
+	auto cz = x * v.Y - y * v.X;
+
+	return {
+		v.X + 2.0f * (w * cx + y * cz - z * cy),
+		v.Y + 2.0f * (w * cy + z * cx - x * cz),
+		v.Z + 2.0f * (w * cz + x * cy - y * cx)
+	};
+}
@@ -0,0 +1,30 @@
+#pragma once
+#include "Packet.h"
+
+struct Quaternion
+{
+	float W;
+	float X;
+	float Y;
+	float Z;
+};
+
+// Madgwick IMU filter: integrates gyro rates and corrects pitch and roll drift towards gravity.
+// Yaw is not observable without a magnetometer and drifts slowly with gyro bias.
+class OrientationFilter
+{
+private:
+	Quaternion orientation{ 1, 0, 0, 0 };
+	float beta;
+	bool isInitialized = false;
+
+	void InitializeFromGravity(Vector3 acceleration);
+public:
+	explicit OrientationFilter(float beta);
+
+	void Update(Vector3 gyroRadians, Vector3 acceleration, float dt);
+	void Reset();
+
+	Quaternion Orientation() const;
+	Vector3 Rotate(Vector3 v) const;
+};
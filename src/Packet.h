@@ -0,0 +1,56 @@
+#pragma once
+#include <cstdint>
+
+struct Vector3
+{
+	float X;
+	float Y;
+	float Z;
+};
+
+struct Vector3Int16
+{
+	int16_t X;
+	int16_t Y;
+	int16_t Z;
+};
+
+#pragma pack(push, 1)
+struct Packet
+{
+	Vector3Int16 Gyro;
+	uint8_t ButtonData;
+};
+
+// Layout streamed by remotes with an accelerometer once it is enabled over the control channel
+struct ExtendedPacket
+{
+	Vector3Int16 Gyro;
+	Vector3Int16 Accel;
+	uint8_t ButtonData;
+};
+#pragma pack(pop)
+
+enum class PacketFormat : uint8_t
+{
+	Standard,
+	Extended
+};
+
+// Sent by the remote in place of a Packet to acknowledge a host command.
+// Same size as Packet so the stream stays aligned; told apart by the signature byte.
+// While extended packets are streamed, the response is padded to ExtendedPacket size
+// and the signature moves to the last byte.
+#pragma pack(push, 1)
+struct ControlResponse
+{
+	uint8_t Sequence;
+	uint8_t Opcode;
+	uint8_t Result;
+	uint16_t SampleRateHz; // configuration in effect once the command was applied
+	uint8_t GyroRangeCode; // low bits index RemoteControl::GyroRanges, see RemoteControl::ExtendedFormatFlag
+	uint8_t Signature;
+};
+#pragma pack(pop)
+
+static_assert(sizeof(ControlResponse) == sizeof(Packet), "Control responses must be packet sized");
@@ -0,0 +1,175 @@
+#include "PacketBroadcast.h"
+#include <chrono>
+#include <cstring>
+
+static constexpr auto SubscriptionWaitMs = 100;
+
+PacketBroadcast::PacketBroadcast()
+{
+	for (auto& slot : slots) slot.stamp.store(0, std::memory_order_relaxed);
+}
+
+void PacketBroadcast::Publish(const Packet& packet, uint16_t gyroRange, int64_t timestampNs)
+{
+	ExtendedPacket extended{};
+	extended.Gyro = packet.Gyro;
+	extended.ButtonData = packet.ButtonData;
+	Publish(extended, PacketFormat::Standard, gyroRange, timestampNs);
+}
+
+void PacketBroadcast::Publish(const ExtendedPacket& packet, PacketFormat format, uint16_t gyroRange, int64_t timestampNs)
+{
+	auto sequence = publishedCount.load(std::memory_order_relaxed);
+	auto& slot = slots[sequence & IndexMask];
+	Entry entry{ sequence, timestampNs, format, packet, gyroRange };
+
+	slot.stamp.store(2 * sequence + 1, std::memory_order_relaxed); // odd: write in progress
+	std::atomic_thread_fence(std::memory_order_release);
+	std::memcpy(&slot.entry, &entry, sizeof(Entry));
+	slot.stamp.store(2 * (sequence + 1), std::memory_order_release);
+
+	// Sequentially consistent against the reader registering as a waiter, so one of the two
+	// always sees the other
+	publishedCount.store(sequence + 1, std::memory_order_seq_cst);
+	if (waiterCount.load(std::memory_order_seq_cst) > 0) Wake();
+}
+
+uint64_t PacketBroadcast::PublishedCount() const
+{
+	return publishedCount.load(std::memory_order_acquire);
+}
+
+void PacketBroadcast::Wake()
+{
+	std::lock_guard<std::mutex> lock(waitMutex);
+	published.notify_all();
+}
+
+PacketBroadcast::Reader::Reader(PacketBroadcast& broadcast, LagPolicy policy) :
+	broadcast(broadcast),
+	policy(policy),
+	next(broadcast.PublishedCount())
+{
+}
+
+PacketBroadcast::Reader::Status PacketBroadcast::Reader::TryRead(Entry& entry)
+{
+	if (isDetached.load(std::memory_order_relaxed)) return Status::Detached;
+
+	while (true)
+	{
+		auto publishedCount = broadcast.PublishedCount();
+		if (next >= publishedCount) return Status::Empty;
+
+		if (publishedCount - next > Capacity)
+		{
+			if (policy == LagPolicy::Detach)
+			{
+				isDetached.store(true, std::memory_order_relaxed);
+				return Status::Detached;
+			}
+
+			// Half a ring of headroom, so the reader is not lapped again straight away
+			auto resume = publishedCount - Capacity / 2;
+			skippedCount.fetch_add(resume - next, std::memory_order_relaxed);
+			next = resume;
+		}
+
+		const auto& slot = broadcast.slots[next & IndexMask];
+		auto expected = 2 * (next + 1);
+		if (slot.stamp.load(std::memory_order_acquire) == expected)
+		{
+			std::memcpy(&entry, &slot.entry, sizeof(Entry));
+			std::atomic_thread_fence(std::memory_order_acquire);
+			if (slot.stamp.load(std::memory_order_relaxed) == expected)
+			{
+				next++;
+				return Status::Read;
+			}
+		}
+
+		// Overwritten before or during the copy: the producer is now a ring ahead
+		std::this_thread::yield();
+	}
+}
+
+PacketBroadcast::Reader::Status PacketBroadcast::Reader::Read(Entry& entry, int timeoutMs)
+{
+	for (int i = 0; i < SpinReads; i++)
+	{
+		auto status = TryRead(entry);
+		if (status != Status::Empty || isCancelled.load(std::memory_order_relaxed)) return status;
+		std::this_thread::yield();
+	}
+
+	broadcast.waiterCount.fetch_add(1, std::memory_order_seq_cst);
+	{
+		std::unique_lock<std::mutex> lock(broadcast.waitMutex);
+		broadcast.published.wait_for(lock, std::chrono::milliseconds(timeoutMs), [this]() {
+			return broadcast.publishedCount.load(std::memory_order_seq_cst) > next || isCancelled.load(std::memory_order_relaxed);
+		});
+	}
+	broadcast.waiterCount.fetch_sub(1, std::memory_order_relaxed);
+
+	return TryRead(entry);
+}
+
+void PacketBroadcast::Reader::Cancel()
+{
+	isCancelled.store(true, std::memory_order_relaxed);
+	broadcast.Wake();
+}
+
+bool PacketBroadcast::Reader::IsCancelled() const
+{
+	return isCancelled.load(std::memory_order_relaxed);
+}
+
+bool PacketBroadcast::Reader::HasPending() const
+{
+	return broadcast.PublishedCount() > next;
+}
+
+uint64_t PacketBroadcast::Reader::SkippedCount() const
+{
+	return skippedCount.load(std::memory_order_relaxed);
+}
+
+bool PacketBroadcast::Reader::IsDetached() const
+{
+	return isDetached.load(std::memory_order_relaxed);
+}
+
+PacketBroadcast::Subscription::Subscription(PacketBroadcast& broadcast, LagPolicy policy, Handler handler) :
+	reader(broadcast, policy),
+	handler(std::move(handler)),
+	thread(&Subscription::Run, this)
+{
+}
+
+PacketBroadcast::Subscription::~Subscription()
+{
+	reader.Cancel();
+	if (thread.joinable()) thread.join();
+}
+
+void PacketBroadcast::Subscription::Run()
+{
+	Entry entry;
+	while (!reader.IsCancelled())
+	{
+		auto status = reader.Read(entry, SubscriptionWaitMs);
+		if (status == Reader::Status::Detached) return;
+		if (status == Reader::Status::Read) handler(entry, !reader.HasPending());
+	}
+}
+
+uint64_t PacketBroadcast::Subscription::SkippedCount() const
+{
+	return reader.SkippedCount();
+}
+
+bool PacketBroadcast::Subscription::IsDetached() const
+{
+	return reader.IsDetached();
+}
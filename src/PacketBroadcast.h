@@ -0,0 +1,115 @@
+#pragma once
+#include "Packet.h"
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+// Single producer, multi consumer broadcast ring for decoded packets. The parser publishes each
+// packet once and every Reader walks the ring with a cursor of its own, on its own thread.
+//
+// Publishing never waits for readers. A reader that falls more than Capacity packets behind has
+// been lapped: depending on its LagPolicy it either skips ahead and counts what it missed, or is
+// detached. Slots are seqlocks, like Metrics::Block, so a reader also notices a slot that was
+// overwritten while it was copying it.
+class PacketBroadcast
+{
+public:
+	static constexpr auto Capacity = 1024; // must be a power of two
+	static constexpr auto SpinReads = 64; // yielding polls before a waiting reader blocks
+
+	struct Entry
+	{
+		uint64_t sequence; // position in the stream, from 0
+		int64_t timestampNs;
+		PacketFormat format;
+		ExtendedPacket packet; // Accel is zero for standard packets
+		uint16_t gyroRange; // full scale in degrees per second the gyro was sampled at
+	};
+
+	enum class LagPolicy
+	{
+		Skip, // resume half a ring behind the producer
+		Detach // stop reading, for consumers that need every packet
+	};
+
+	PacketBroadcast();
+
+	// Producer side, one thread only
+	void Publish(const Packet& packet, uint16_t gyroRange, int64_t timestampNs);
+	void Publish(const ExtendedPacket& packet, PacketFormat format, uint16_t gyroRange, int64_t timestampNs);
+	uint64_t PublishedCount() const;
+
+	class Reader
+	{
+	public:
+		enum class Status
+		{
+			Read,
+			Empty,
+			Detached
+		};
+
+		// Starts with the next packet published
+		Reader(PacketBroadcast& broadcast, LagPolicy policy);
+
+		Status TryRead(Entry& entry);
+		// Polls, then blocks until a packet arrives, timeoutMs passes or Cancel is called
+		Status Read(Entry& entry, int timeoutMs);
+		void Cancel(); // safe from any thread
+		bool IsCancelled() const;
+
+		bool HasPending() const;
+		uint64_t SkippedCount() const;
+		bool IsDetached() const;
+	private:
+		PacketBroadcast& broadcast;
+		LagPolicy policy;
+		uint64_t next;
+		std::atomic<uint64_t> skippedCount{ 0 };
+		std::atomic<bool> isDetached{ false };
+		std::atomic<bool> isCancelled{ false };
+	};
+
+	// Calls handler for every packet on a thread of its own. isEndOfBatch is set when no further
+	// packet is waiting, so consumers can defer work such as flushing output.
+	class Subscription
+	{
+	public:
+		using Handler = std::function<void(const Entry& entry, bool isEndOfBatch)>;
+
+		Subscription(PacketBroadcast& broadcast, LagPolicy policy, Handler handler);
+		~Subscription(); // stops the thread and waits for it
+
+		uint64_t SkippedCount() const;
+		bool IsDetached() const;
+	private:
+		Reader reader;
+		Handler handler;
+		std::thread thread;
+
+		void Run();
+	};
+private:
+	static constexpr uint64_t IndexMask = Capacity - 1;
+	static_assert((Capacity & IndexMask) == 0, "Capacity must be a power of two");
+
+	// stamp is 2 * (sequence + 1) once the entry for sequence is written, odd while writing
+	struct alignas(64) Slot
+	{
+		std::atomic<uint64_t> stamp;
+		Entry entry;
+	};
+
+	Slot slots[Capacity];
+	alignas(64) std::atomic<uint64_t> publishedCount{ 0 };
+
+	// Readers block here once polling gives up. Publish only takes the lock when one is waiting.
+	alignas(64) std::atomic<int> waiterCount{ 0 };
+	std::mutex waitMutex;
+	std::condition_variable published;
+
+	void Wake();
+};
@@ -1,127 +1,277 @@
-#include "pch.h"
 #include "PacketParser.h"
 #include "CircularBuffer.h"
+#include "Logger.h"
+#include "Metrics.h"
+#include "PacketSchema.h"
+#include "Trace.h"
+#include <algorithm>
 #include <bitset>
 #include <chrono>
+#include <cstring>
+#include <iterator>
 
 namespace PacketParser
 {
-	static Packet currentPacket;
+	static constexpr auto MaxFrameSize = PacketSchema::MaxFrameSize;
+
+	// Everything the parser needs to know about one frame layout, generated from its schema
+	struct FrameFormat
+	{
+		int frameSize;
+		int bytesAfterSignature; // left in the frame once alignment locks onto its signature byte
+		bool (*isSignature)(uint8_t byte);
+		void (*processFrames)(int dropCount); // consumes every whole frame in the buffer
+	};
+
+	template <const PacketSchema::Layout& layout>
+	static void ProcessFrames(int dropCount);
+
+	template <const PacketSchema::Layout& layout>
+	static constexpr FrameFormat MakeFrameFormat()
+	{
+		using Decoder = PacketSchema::Decoder<layout>;
+		return { Decoder::FrameSize, layout.frameSize - 1 - layout.signatureOffset, Decoder::IsSignature, ProcessFrames<layout> };
+	}
+
+	static constexpr FrameFormat FrameFormats[] = { // indexed by PacketFormat
+		MakeFrameFormat<PacketSchema::Standard>(),
+		MakeFrameFormat<PacketSchema::Extended>()
+	};
+	static constexpr auto FormatCount = (int)std::size(FrameFormats);
+
+	static uint8_t frame[MaxFrameSize];
+	static PacketFormat packetFormat = PacketFormat::Standard;
+	static const FrameFormat* frameFormat = &FrameFormats[(int)PacketFormat::Standard];
+	static int frameSize = frameFormat->frameSize;
+	static int maxPacketBacklog = MaxPacketBacklog;
+	static int skipBytes = 0; // rest of the frame whose signature completed alignment
 	static CircularBuffer* buffer;
 
 	static bool isDataAligned = false;
 	static int attemptedPacketAlignments = 0;
 
+	// byteValidCount[f][i] stores how many times the ith byte of a frame in format f had a valid signature.
+	// Both layouts are tracked because a format switch acknowledged before alignment goes unnoticed.
+	static uint8_t byteValidCount[FormatCount][MaxFrameSize] = {};
+	static int byteIndex[FormatCount] = {};
+
+	static Metrics::ParserMetrics metrics;
+
 	std::function<void(Packet)> PacketReady;
+	std::function<void(ExtendedPacket)> ExtendedPacketReady;
+	std::function<bool(ControlResponse)> ControlResponseReady;
+	std::function<void(int count)> PacketsDropped;
 
 	void SetBuffer(CircularBuffer* circularBuffer)
 	{
 		PacketParser::buffer = circularBuffer;
 	}
 
-	inline static bool HasValidSignature(uint8_t byte)
+	// Selects the generated decoder once, so frames are processed without a per-packet format check
+	static void ApplyPacketFormat(PacketFormat format)
 	{
-		return (byte & SignatureMask) == Signature;
+		packetFormat = format;
+		frameFormat = &FrameFormats[(int)format];
+		frameSize = frameFormat->frameSize;
 	}
 
-	static bool TryProcessPacket()
+	// Switches the frame layout. Call from the parser thread (e.g. from ControlResponseReady)
+	// so the change lands exactly between two frames.
+	void SetPacketFormat(PacketFormat format)
 	{
-		uint8_t* byteBuffer = (uint8_t*)&currentPacket;
+		if (format == packetFormat) return;
+		ApplyPacketFormat(format);
 
-		for (int i = 0; i < sizeof(Packet); i++) // read data into packet struct
-		{
-			byteBuffer[i] = buffer->ReadBuffer();
-		}
+		// Alignment progress was gathered under the old layout
+		if (!isDataAligned) ResetDataAlignment();
+	}
 
-		return HasValidSignature(currentPacket.ButtonData);
+	void SetSampleRate(uint16_t sampleRateHz)
+	{
+		maxPacketBacklog = std::max(MaxPacketBacklog, sampleRateHz * MaxBacklogMs / 1000);
 	}
 
-	// Attempts to align data currently in the buffer
-	bool TryAlignData()
+	// False when the frame only looks like a response: it answers no command in flight
+	static bool DispatchControlResponse(int responseSignatureOffset)
 	{
-		// byteValidCount[i] stores how many times the ith byte had a valid signature
-		static uint8_t byteValidCount[sizeof(Packet)] = {};
-		static int byteIndex = 0;
+		ControlResponse response;
+		memcpy(&response, frame, sizeof(response) - 1);
+		response.Signature = frame[responseSignatureOffset];
 
-		while (buffer->BufferCount() > 0)
+		if (ControlResponseReady && !ControlResponseReady(response)) return false;
+
+		metrics.controlResponses++;
+		Trace::Instant("Control response", "opcode", response.Opcode);
+		return true;
+	}
+
+	static void OnMisaligned()
+	{
+		isDataAligned = false;
+		attemptedPacketAlignments = 0;
+		metrics.realignments++;
+
+		Trace::Instant("Misaligned");
+		Logger::Warning("Data misaligned! Attempting to realign...");
+	}
+
+	// The first dropCount frames are discarded as backlog, except for control responses
+	template <const PacketSchema::Layout& layout>
+	static void ProcessFrames(int dropCount)
+	{
+		using Decoder = PacketSchema::Decoder<layout>;
+
+		while (buffer->BufferCount() >= Decoder::FrameSize)
 		{
-			if (HasValidSignature(buffer->ReadBuffer()))
+			for (int i = 0; i < Decoder::FrameSize; i++) // read data into frame
 			{
-				byteValidCount[byteIndex]++;
+				frame[i] = buffer->ReadBuffer();
 			}
-			else
+
+			if (!Decoder::IsValid(frame))
+			{
+				if (Decoder::IsControlResponse(frame) && DispatchControlResponse(layout.responseSignatureOffset)) continue;
+
+				OnMisaligned();
+				return;
+			}
+
+			if (dropCount > 0)
 			{
-				byteValidCount[byteIndex] = 0;
+				dropCount--;
+				metrics.backlogDroppedBytes += Decoder::FrameSize;
+				if (PacketsDropped) PacketsDropped(1);
+				continue;
 			}
 
-			if (byteValidCount[byteIndex] >= SequentialValidPacketsToAlign)
+			metrics.packets++;
+			auto packet = Decoder::Decode(frame);
+
+			if constexpr (Decoder::HasAccel)
 			{
-				isDataAligned = true;
-				return true;
+				if (ExtendedPacketReady)
+				{
+					ExtendedPacketReady(packet);
+					continue;
+				}
 			}
 
-			byteIndex++;
+			// Consumers that only understand gyro data still get it
+			if (PacketReady) PacketReady({ packet.Gyro, packet.ButtonData });
+		}
+	}
+
+	// Attempts to align data currently in the buffer, to whichever frame layout locks first
+	bool TryAlignData()
+	{
+		while (buffer->BufferCount() > 0)
+		{
+			auto byte = buffer->ReadBuffer();
+
+			for (int offset = 0; offset < FormatCount; offset++)
+			{
+				auto format = ((int)packetFormat + offset) % FormatCount; // the expected layout wins ties
+				auto& index = byteIndex[format];
+				auto& validCount = byteValidCount[format][index];
+
+				validCount = FrameFormats[format].isSignature(byte) ? validCount + 1 : 0;
 
-			if (byteIndex < sizeof(Packet)) continue;
+				if (validCount >= SequentialValidPacketsToAlign)
+				{
+					if (format != (int)packetFormat)
+					{
+						Logger::Info("Aligned to %lld byte frames instead of %lld", FrameFormats[format].frameSize, frameSize);
+						ApplyPacketFormat((PacketFormat)format);
+					}
 
-			byteIndex = 0;
-			attemptedPacketAlignments++;
+					skipBytes = frameFormat->bytesAfterSignature;
+					isDataAligned = true;
+					Trace::Instant("Aligned", "frame_bytes", frameSize);
+					return true;
+				}
+
+				if (++index < FrameFormats[format].frameSize) continue;
+
+				index = 0;
+				if (format == (int)packetFormat) attemptedPacketAlignments++;
+			}
 		}
 
 		return false;
 	}
 
-	static void CorrectPacketBacklog()
+	// Frames to discard so that at most maxPacketBacklog remain
+	static int PacketBacklogExcess()
 	{
-		auto packetBacklog = buffer->BufferCount() / (int)sizeof(Packet);
+		auto packetBacklog = buffer->BufferCount() / frameSize;
+		if (packetBacklog <= maxPacketBacklog) return 0;
 
-		if (packetBacklog <= MaxPacketBacklog) return;
-		
-		for (unsigned int i = 0; i < (packetBacklog - MaxPacketBacklog) * sizeof(Packet); i++)
-		{
-			buffer->ReadBuffer();
-		}
+		Trace::Instant("Backlog dropped", "bytes", (packetBacklog - maxPacketBacklog) * frameSize);
+		return packetBacklog - maxPacketBacklog;
 	}
 
-	void OnReceivedData()
+	static void ProcessReceivedData()
 	{
 		if (!isDataAligned)
 		{
 			if (attemptedPacketAlignments > PacketAlignmentAttemptsThreshold)
 			{
-				std::cout << "Tried to align " << PacketAlignmentAttemptsThreshold << " packets with no success" << std::endl;
+				Logger::Warning("Tried to align %lld packets with no success", PacketAlignmentAttemptsThreshold);
 				return;
 			}
 
 			if (TryAlignData())
 			{
-				std::cout << "Data aligned!" << std::endl;
+				Logger::Info("Data aligned!");
 			}
 			return;
 		}
 
-		CorrectPacketBacklog(); // TODO: is backlog correction necessary now that we consume all available packets?
-
-		while (buffer->BufferCount() >= sizeof(Packet))
+		for (; skipBytes > 0 && buffer->BufferCount() > 0; skipBytes--)
 		{
-			if (!TryProcessPacket())
-			{
-				isDataAligned = false;
-				attemptedPacketAlignments = 0;
+			buffer->ReadBuffer();
+		}
+		if (skipBytes > 0) return;
 
-				std::cout << "Data misaligned! Attempting to realign..." << std::endl;
-				return;
-			}
+		frameFormat->processFrames(PacketBacklogExcess());
+	}
 
-			//std::cout << currentPacket.Gyro.X << "\t" << currentPacket.Gyro.Y << "\t" << currentPacket.Gyro.Z << std::endl;
+	void OnReceivedData()
+	{
+		Trace::Scope scope("Parse");
+		auto packetsBefore = metrics.packets;
 
-			if (PacketReady) PacketReady(currentPacket);
-		}
+		ProcessReceivedData();
+
+		scope.Argument("packets", (int64_t)(metrics.packets - packetsBefore));
+
+		metrics.backlogBytes = (uint32_t)buffer->BufferCount();
+		metrics.isAligned = isDataAligned;
+		Metrics::Publish(Metrics::WriterPage()->parser, metrics);
+	}
+
+	bool IsDataAligned()
+	{
+		return isDataAligned;
 	}
 
-	// Marks data as not aligned
+	// Marks data as not aligned and restarts alignment from scratch
 	void ResetDataAlignment()
 	{
 		isDataAligned = false;
+		attemptedPacketAlignments = 0;
+		skipBytes = 0;
+		std::fill(std::begin(byteIndex), std::end(byteIndex), 0);
+		std::fill(&byteValidCount[0][0], &byteValidCount[0][0] + FormatCount * MaxFrameSize, (uint8_t)0);
+	}
+
+	// For a stream known to restart on a frame boundary. If it does not, the first frame misaligns
+	// and alignment starts over as usual.
+	void ResumeAlignment(int staleBytes)
+	{
+		ResetDataAlignment();
+		isDataAligned = true;
+		skipBytes = staleBytes;
+		Trace::Instant("Alignment resumed", "frame_bytes", frameSize);
 	}
-}
\ No newline at end of file
+}
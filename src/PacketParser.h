@@ -1,19 +1,29 @@
 #pragma once
-#include "Main.h"
+#include "Packet.h"
 #include "CircularBuffer.h"
+#include <functional>
 
+// Frames bytes from the transport into packets. Frame layouts are described in PacketSchema.h.
 namespace PacketParser
 {
-	static constexpr auto Signature = 0b10101000;
-	static constexpr auto SignatureMask = 0b11111000;
 	static constexpr auto PacketAlignmentAttemptsThreshold = 1000;
-	static constexpr auto MaxPacketBacklog = 3;
+	static constexpr auto MaxPacketBacklog = 3; // kept at any sample rate
+	static constexpr auto MaxBacklogMs = 30; // sampling time kept once a notification carries more packets
 	static constexpr auto SequentialValidPacketsToAlign = 5;
 
 	extern std::function<void(Packet)> PacketReady;
+	extern std::function<void(ExtendedPacket)> ExtendedPacketReady; // when unset, extended packets go to PacketReady
+	extern std::function<bool(ControlResponse)> ControlResponseReady; // false if it answers no command, then it is misaligned data
+	extern std::function<void(int count)> PacketsDropped; // discarded unparsed to catch up with a backlog
 
 	void SetBuffer(CircularBuffer* circularBuffer);
+	void SetPacketFormat(PacketFormat format);
+	void SetSampleRate(uint16_t sampleRateHz);
 	void OnReceivedData();
 	bool TryAlignData();
+	bool IsDataAligned();
 	void ResetDataAlignment();
+	// After a reconnect: frames in the current format start right after the staleBytes left over
+	// from before it
+	void ResumeAlignment(int staleBytes);
 }
\ No newline at end of file
@@ -0,0 +1,189 @@
+#pragma once
+#include "Packet.h"
+#include "RemoteControl.h"
+#include <cstdint>
+
+// Compile-time descriptions of the frame layouts streamed by remote firmware. Decoder<layout>
+// generates the validator, decoder and encoder for one layout, so a new firmware layout is a new
+// Layout constant rather than a change to the parser. Decoded packets carry the canonical button
+// bits below whichever bits the firmware uses, and no signature bits.
+namespace PacketSchema
+{
+	static constexpr uint8_t RightMask = 1 << 0;
+	static constexpr uint8_t LeftMask = 1 << 1;
+	static constexpr uint8_t MiddleMask = 1 << 2;
+	static constexpr uint8_t ButtonMask = RightMask | LeftMask | MiddleMask;
+
+	static constexpr auto Absent = -1;
+	static constexpr auto MaxFrameSize = 32;
+
+	struct Layout
+	{
+		int frameSize;
+		int gyroOffsets[3]; // little endian int16 for X, Y and Z
+		int accelOffsets[3]; // Absent on remotes without an accelerometer
+		int signatureOffset;
+		uint8_t signature;
+		uint8_t signatureMask;
+		int buttonOffset;
+		uint8_t rightMask;
+		uint8_t leftMask;
+		uint8_t middleMask;
+		int responseSignatureOffset; // control responses are frame sized and marked here instead
+	};
+
+	// PacketFormat::Standard, the layout of Packet
+	inline constexpr Layout Standard{
+		7,
+		{ 0, 2, 4 },
+		{ Absent, Absent, Absent },
+		6, 0b10101000, 0b11111000,
+		6, 1 << 0, 1 << 1, 1 << 2,
+		6
+	};
+
+	// PacketFormat::Extended, the layout of ExtendedPacket
+	inline constexpr Layout Extended{
+		13,
+		{ 0, 2, 4 },
+		{ 6, 8, 10 },
+		12, 0b10101000, 0b11111000,
+		12, 1 << 0, 1 << 1, 1 << 2,
+		12
+	};
+
+	constexpr bool IsWithin(const Layout& layout, int offset, int width)
+	{
+		return offset >= 0 && offset + width <= layout.frameSize;
+	}
+
+	constexpr bool Overlaps(int offset, int width, int otherOffset, int otherWidth)
+	{
+		return offset < otherOffset + otherWidth && otherOffset < offset + width;
+	}
+
+	// Fields inside the frame, gyro and accelerometer fields disjoint from each other and from the
+	// signature, button and response signature bytes, button bits disjoint from each other and from
+	// the signature bits
+	constexpr bool IsConsistent(const Layout& layout)
+	{
+		if (layout.frameSize <= 0 || layout.frameSize > MaxFrameSize) return false;
+
+		for (int axis = 0; axis < 3; axis++)
+		{
+			if (!IsWithin(layout, layout.gyroOffsets[axis], 2)) return false;
+			if ((layout.accelOffsets[axis] == Absent) != (layout.accelOffsets[0] == Absent)) return false;
+			if (layout.accelOffsets[axis] != Absent && !IsWithin(layout, layout.accelOffsets[axis], 2)) return false;
+		}
+
+		int buttons = layout.rightMask | layout.leftMask | layout.middleMask;
+		if ((layout.rightMask & layout.leftMask) || (layout.rightMask & layout.middleMask) || (layout.leftMask & layout.middleMask)) return false;
+		if (layout.buttonOffset == layout.signatureOffset && (buttons & layout.signatureMask)) return false;
+		if ((layout.signature & ~layout.signatureMask) != 0) return false;
+
+		if (!IsWithin(layout, layout.signatureOffset, 1) || !IsWithin(layout, layout.buttonOffset, 1)
+			|| !IsWithin(layout, layout.responseSignatureOffset, 1)) return false;
+
+		int fields[6] = {};
+		int fieldCount = 0;
+		for (int axis = 0; axis < 3; axis++)
+		{
+			fields[fieldCount++] = layout.gyroOffsets[axis];
+			if (layout.accelOffsets[axis] != Absent) fields[fieldCount++] = layout.accelOffsets[axis];
+		}
+
+		const int markers[3] = { layout.signatureOffset, layout.buttonOffset, layout.responseSignatureOffset };
+		for (int i = 0; i < fieldCount; i++)
+		{
+			for (int j = i + 1; j < fieldCount; j++)
+			{
+				if (Overlaps(fields[i], 2, fields[j], 2)) return false;
+			}
+			for (auto marker : markers)
+			{
+				if (Overlaps(fields[i], 2, marker, 1)) return false;
+			}
+		}
+
+		return true;
+	}
+
+	static_assert(IsConsistent(Standard) && Standard.frameSize == sizeof(Packet), "Standard layout must describe Packet");
+	static_assert(IsConsistent(Extended) && Extended.frameSize == sizeof(ExtendedPacket), "Extended layout must describe ExtendedPacket");
+
+	template <const Layout& layout>
+	struct Decoder
+	{
+		static_assert(IsConsistent(layout), "Inconsistent packet layout");
+
+		static constexpr auto FrameSize = layout.frameSize;
+		static constexpr auto HasAccel = layout.accelOffsets[0] != Absent;
+		static constexpr auto IsCanonicalButtons = layout.rightMask == RightMask && layout.leftMask == LeftMask
+			&& layout.middleMask == MiddleMask;
+
+		static constexpr bool IsSignature(uint8_t byte)
+		{
+			return (byte & layout.signatureMask) == layout.signature;
+		}
+
+		static bool IsValid(const uint8_t* frame)
+		{
+			return IsSignature(frame[layout.signatureOffset]);
+		}
+
+		static bool IsControlResponse(const uint8_t* frame)
+		{
+			return frame[layout.responseSignatureOffset] == RemoteControl::ResponseSignature;
+		}
+
+		static constexpr uint8_t Buttons(uint8_t byte)
+		{
+			if constexpr (IsCanonicalButtons) return byte & ButtonMask;
+			return (uint8_t)((byte & layout.rightMask ? RightMask : 0)
+				| (byte & layout.leftMask ? LeftMask : 0)
+				| (byte & layout.middleMask ? MiddleMask : 0));
+		}
+
+		static ExtendedPacket Decode(const uint8_t* frame)
+		{
+			ExtendedPacket packet;
+			packet.Gyro = { Read(frame, layout.gyroOffsets[0]), Read(frame, layout.gyroOffsets[1]), Read(frame, layout.gyroOffsets[2]) };
+			if constexpr (HasAccel) packet.Accel = { Read(frame, layout.accelOffsets[0]), Read(frame, layout.accelOffsets[1]), Read(frame, layout.accelOffsets[2]) };
+			else packet.Accel = { 0, 0, 0 };
+			packet.ButtonData = Buttons(frame[layout.buttonOffset]);
+			return packet;
+		}
+
+		// Takes canonical button bits. Bytes not covered by the layout are zeroed.
+		static void Encode(const ExtendedPacket& packet, uint8_t* frame)
+		{
+			for (int i = 0; i < FrameSize; i++) frame[i] = 0;
+
+			Write(frame, layout.gyroOffsets[0], packet.Gyro.X);
+			Write(frame, layout.gyroOffsets[1], packet.Gyro.Y);
+			Write(frame, layout.gyroOffsets[2], packet.Gyro.Z);
+			if constexpr (HasAccel)
+			{
+				Write(frame, layout.accelOffsets[0], packet.Accel.X);
+				Write(frame, layout.accelOffsets[1], packet.Accel.Y);
+				Write(frame, layout.accelOffsets[2], packet.Accel.Z);
+			}
+
+			frame[layout.buttonOffset] |= (uint8_t)((packet.ButtonData & RightMask ? layout.rightMask : 0)
+				| (packet.ButtonData & LeftMask ? layout.leftMask : 0)
+				| (packet.ButtonData & MiddleMask ? layout.middleMask : 0));
+			frame[layout.signatureOffset] = (uint8_t)((frame[layout.signatureOffset] & ~layout.signatureMask) | layout.signature);
+		}
+	private:
+		static int16_t Read(const uint8_t* frame, int offset)
+		{
+			return (int16_t)(frame[offset] | frame[offset + 1] << 8);
+		}
+
+		static void Write(uint8_t* frame, int offset, int16_t value)
+		{
+			frame[offset] = (uint8_t)value;
+			frame[offset + 1] = (uint8_t)((uint16_t)value >> 8);
+		}
+	};
+}
@@ -0,0 +1,132 @@
+#pragma once
+#include "Input.h"
+#include "PacketBroadcast.h"
+#include "PacketParser.h"
+#include "PipelineSnapshot.h"
+#include "PointerOutput.h"
+#include "RemoteControl.h"
+#include "Startup.h"
+#include "Trace.h"
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <memory>
+
+// Wires a transport (BluetoothLE::BLEDevice or SimulatedTransport) through the parser and the
+// remote control channel into Input. Shared by the tray application and the headless daemon.
+namespace Pipeline
+{
+	// Every decoded packet, for consumers on their own threads (recorders, telemetry, gestures).
+	// The cursor is driven inline on the parser thread and never waits for them.
+	inline PacketBroadcast& Packets()
+	{
+		static PacketBroadcast packets;
+		return packets;
+	}
+
+	inline int64_t Timestamp()
+	{
+		return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+	}
+
+	// Full scale of the packets being parsed, for broadcast consumers. Parser thread only.
+	inline uint16_t& GyroRange()
+	{
+		static uint16_t gyroRange = RemoteControl::DefaultGyroRange;
+		return gyroRange;
+	}
+
+	template <typename Transport>
+	void Connect(Transport& transport, RemoteControl::Controller& remoteControl,
+		std::function<void()> onConnected = nullptr, std::function<void()> onDisconnected = nullptr)
+	{
+		transport.Connected = [&remoteControl, onConnected]() {
+			Trace::ResetArrivals();
+			if (onConnected) onConnected();
+			remoteControl.RequestStatus();
+			remoteControl.SetPacketFormat(PacketFormat::Extended); // rejected by remotes without an accelerometer
+		};
+		transport.Disconnected = [&remoteControl, onDisconnected]() {
+			Trace::ResetArrivals();
+			if (onDisconnected) onDisconnected();
+			remoteControl.Reset();
+		};
+		transport.ReceivedData = [&remoteControl]() {
+			Trace::Arrival();
+			remoteControl.AnnounceReset();
+			PacketParser::OnReceivedData();
+			PointerOutput::Flush(); // one forwarded datagram per notification
+		};
+		PacketParser::PacketReady = [](Packet packet) {
+			Packets().Publish(packet, GyroRange(), Timestamp());
+			Input::ProcessPacket(packet);
+			Startup::Reached(Startup::Milestone::FirstPacket);
+		};
+		PacketParser::ExtendedPacketReady = [](ExtendedPacket packet) {
+			Packets().Publish(packet, PacketFormat::Extended, GyroRange(), Timestamp());
+			Input::ProcessExtendedPacket(packet);
+			Startup::Reached(Startup::Milestone::FirstPacket);
+		};
+		PacketParser::ControlResponseReady = [&remoteControl](ControlResponse response) {
+			return remoteControl.OnResponse(response);
+		};
+		PacketParser::PacketsDropped = [](int count) {
+			Input::SkipSamples(count);
+		};
+		PacketParser::SetBuffer(&transport.buffer);
+
+		// Runs on the parser thread, between the acknowledgement and the next packet
+		remoteControl.ConfigurationChanged = [](RemoteControl::Configuration configuration) {
+			GyroRange() = configuration.gyroRange;
+			Input::SetDegreeRange(configuration.gyroRange);
+			Input::SetSampleRate(configuration.sampleRateHz);
+			PacketParser::SetSampleRate(configuration.sampleRateHz);
+			PacketParser::SetPacketFormat(configuration.packetFormat);
+		};
+		Input::UsageModeRequested = [&remoteControl](RemoteControl::UsageMode mode) {
+			remoteControl.SetUsageMode(mode);
+		};
+	}
+
+	// Stores a PipelineSnapshot of the remote as its link drops, and restores the snapshot of the
+	// same device before the first data after a reconnect is parsed. Call after Connect; the
+	// transport also needs DeviceId().
+	template <typename Transport>
+	void KeepSnapshots(Transport& transport, RemoteControl::Controller& remoteControl)
+	{
+		// Taken on the parser thread after every notification, as the parser and buffer belong to it
+		struct Resume
+		{
+			std::atomic<bool> isPending{ false };
+			std::atomic<bool> isAligned{ false }; // also read on the thread reporting the drop
+			int staleBytes = 0; // the unparsed end of the last frame, parser thread only
+		};
+		auto resume = std::make_shared<Resume>();
+
+		auto disconnected = transport.Disconnected;
+		transport.Disconnected = [&transport, &remoteControl, resume, disconnected]() {
+			auto isAligned = resume->isAligned.load(std::memory_order_relaxed);
+			PipelineSnapshot::Store(transport.DeviceId(), { remoteControl.CurrentConfiguration(), isAligned });
+			disconnected();
+		};
+		auto connected = transport.Connected;
+		transport.Connected = [resume, connected]() {
+			resume->isPending.store(true, std::memory_order_release);
+			connected();
+		};
+		auto receivedData = transport.ReceivedData;
+		transport.ReceivedData = [&transport, &remoteControl, resume, receivedData]() {
+			PipelineSnapshot::Snapshot snapshot;
+			if (resume->isPending.exchange(false, std::memory_order_acquire)
+				&& PipelineSnapshot::Find(transport.DeviceId(), snapshot))
+			{
+				remoteControl.Restore(snapshot.configuration);
+				if (snapshot.isAligned) PacketParser::ResumeAlignment(resume->staleBytes);
+				Trace::Instant("Snapshot restored", "sample_rate_hz", snapshot.configuration.sampleRateHz);
+			}
+			receivedData();
+			resume->staleBytes = transport.buffer.BufferCount();
+			resume->isAligned.store(PacketParser::IsDataAligned(), std::memory_order_relaxed);
+		};
+	}
+}
@@ -0,0 +1,98 @@
+#include "PipelineSnapshot.h"
+#include "Logger.h"
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <vector>
+
+namespace PipelineSnapshot
+{
+	static std::mutex mutex;
+	static std::vector<Record> records; // least recently stored first
+	static std::string savePath;
+
+	static FILE* OpenFile(const char* path, const char* mode)
+	{
+		FILE* file = nullptr;
+#ifdef _WIN32
+		if (fopen_s(&file, path, mode) != 0) file = nullptr;
+#else
+		file = fopen(path, mode);
+#endif
+		return file;
+	}
+
+	static bool IsValid(const Record& record)
+	{
+		return record.deviceId[MaxDeviceIdLength] == '\0' && record.sampleRateHz > 0
+			&& RemoteControl::GyroRangeCode(record.gyroRange) >= 0 && (uint8_t)record.packetFormat <= (uint8_t)PacketFormat::Extended;
+	}
+
+	// Caller holds mutex
+	static bool Save()
+	{
+		auto file = OpenFile(savePath.c_str(), "wb");
+		if (!file) return false;
+
+		Header header{ Magic, Version, (uint32_t)sizeof(Record), (uint32_t)records.size() };
+		auto isWritten = fwrite(&header, sizeof(header), 1, file) == 1
+			&& fwrite(records.data(), sizeof(Record), records.size(), file) == records.size();
+		return fclose(file) == 0 && isWritten;
+	}
+
+	void Store(const std::string& deviceId, const Snapshot& snapshot)
+	{
+		Record record{};
+		std::strncpy(record.deviceId, deviceId.c_str(), MaxDeviceIdLength);
+		record.sampleRateHz = snapshot.configuration.sampleRateHz;
+		record.gyroRange = snapshot.configuration.gyroRange;
+		record.packetFormat = snapshot.configuration.packetFormat;
+		record.isAligned = snapshot.isAligned;
+
+		std::lock_guard<std::mutex> lock(mutex);
+		for (auto i = records.begin(); i != records.end(); i++)
+		{
+			if (std::strcmp(i->deviceId, record.deviceId) != 0) continue;
+			records.erase(i);
+			break;
+		}
+		if (records.size() == MaxDevices) records.erase(records.begin());
+		records.push_back(record);
+
+		if (!savePath.empty() && !Save()) Logger::Warning("Could not save the pipeline snapshot");
+	}
+
+	bool Find(const std::string& deviceId, Snapshot& snapshot)
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		for (auto& record : records)
+		{
+			if (deviceId.compare(0, MaxDeviceIdLength, record.deviceId) != 0) continue;
+			snapshot.configuration = { record.sampleRateHz, record.gyroRange, record.packetFormat };
+			snapshot.isAligned = record.isAligned != 0;
+			return true;
+		}
+		return false;
+	}
+
+	bool Open(const char* path)
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		savePath = path;
+
+		auto file = OpenFile(path, "rb");
+		if (!file) return true; // nothing saved yet
+
+		Header header;
+		auto isValid = fread(&header, sizeof(header), 1, file) == 1 && header.magic == Magic
+			&& header.version == Version && header.recordSize == sizeof(Record) && header.recordCount <= MaxDevices;
+
+		std::vector<Record> loaded(isValid ? header.recordCount : 0);
+		isValid = isValid && fread(loaded.data(), sizeof(Record), loaded.size(), file) == loaded.size();
+		for (auto& record : loaded) isValid = isValid && IsValid(record);
+		fclose(file);
+
+		if (isValid) records = loaded;
+		return isValid;
+	}
+}
@@ -0,0 +1,57 @@
+#pragma once
+#include "RemoteControl.h"
+#include <cstdint>
+#include <string>
+
+// What the pipeline had learned about a remote when its link dropped, kept per device so that a
+// reconnect resumes where it left off. The remote keeps its configuration through a dropout, but
+// RemoteControl falls back to the defaults with the link and only learns the truth again from the
+// status round trip after it returns. Until then the parser misreads the frame layout and has to
+// realign, and Input scales rates by the wrong range and sample period. Pipeline::KeepSnapshots
+// restores the snapshot when data resumes instead.
+//
+// A remote that did reset answers the status request with its defaults, and frames that do not fit
+// the restored layout misalign the parser, which then realigns as before. A snapshot file is a
+// Header followed by one Record per device, written in the host's byte order.
+namespace PipelineSnapshot
+{
+	static constexpr uint32_t Magic = 0x50534247; // "GBSP"
+	static constexpr uint32_t Version = 1;
+	static constexpr auto DefaultPath = "GestureBackend.snapshot";
+	static constexpr auto MaxDevices = 16; // the least recently stored is dropped beyond this
+	static constexpr auto MaxDeviceIdLength = 31;
+
+	struct Snapshot
+	{
+		RemoteControl::Configuration configuration;
+		bool isAligned; // the parser had locked onto frames, so they resume on a frame boundary
+	};
+
+	struct Header
+	{
+		uint32_t magic;
+		uint32_t version;
+		uint32_t recordSize; // lets a reader reject files written with another Record layout
+		uint32_t recordCount;
+	};
+
+	struct Record
+	{
+		char deviceId[MaxDeviceIdLength + 1]; // zero terminated
+		uint16_t sampleRateHz;
+		uint16_t gyroRange;
+		PacketFormat packetFormat;
+		uint8_t isAligned;
+		uint16_t reserved;
+	};
+
+	static_assert(sizeof(Record) == 40, "Record layout is part of the file format");
+
+	// Any thread. Saves to the file set by Open, if any.
+	void Store(const std::string& deviceId, const Snapshot& snapshot);
+	bool Find(const std::string& deviceId, Snapshot& snapshot);
+
+	// Loads the snapshots saved at path, if there are any, and saves every later Store there.
+	// False when the file exists but is not a snapshot file.
+	bool Open(const char* path);
+}
@@ -0,0 +1,94 @@
+#include "PlotFeed.h"
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+PlotFeed::PlotFeed()
+{
+	for (auto& slot : slots) slot.stamp.store(0, std::memory_order_relaxed);
+	ResetColumn();
+}
+
+// Starts from the widest possible extremes so that Push needs no first-sample branch
+void PlotFeed::ResetColumn()
+{
+	std::fill(std::begin(current.minimum), std::end(current.minimum), std::numeric_limits<float>::max());
+	std::fill(std::begin(current.maximum), std::end(current.maximum), std::numeric_limits<float>::lowest());
+	currentSamples = 0;
+}
+
+void PlotFeed::Push(const float (&values)[ChannelCount])
+{
+	for (int channel = 0; channel < ChannelCount; channel++)
+	{
+		current.minimum[channel] = std::min(current.minimum[channel], values[channel]);
+		current.maximum[channel] = std::max(current.maximum[channel], values[channel]);
+	}
+
+	if (++currentSamples < SamplesPerColumn) return;
+
+	auto column = columnCount.load(std::memory_order_relaxed);
+	auto& slot = slots[column & IndexMask];
+
+	slot.stamp.store(2 * column + 1, std::memory_order_relaxed); // odd: write in progress
+	std::atomic_thread_fence(std::memory_order_release);
+	std::memcpy(&slot.column, &current, sizeof(Column));
+	slot.stamp.store(2 * (column + 1), std::memory_order_release);
+
+	columnCount.store(column + 1, std::memory_order_release);
+	ResetColumn();
+}
+
+uint64_t PlotFeed::Read(std::vector<Column>& columns, int count) const
+{
+	auto end = columnCount.load(std::memory_order_acquire);
+	auto available = std::min<uint64_t>({ end, (uint64_t)std::max(count, 0), Capacity });
+
+	columns.clear();
+	columns.reserve((size_t)available);
+
+	Column column;
+	for (auto index = end - available; index < end; index++)
+	{
+		const auto& slot = slots[index & IndexMask];
+		auto expected = 2 * (index + 1);
+		if (slot.stamp.load(std::memory_order_acquire) != expected) continue;
+
+		std::memcpy(&column, &slot.column, sizeof(Column));
+		std::atomic_thread_fence(std::memory_order_acquire);
+
+		// Overwritten while copying: the input thread lapped this reader, so the column is gone
+		if (slot.stamp.load(std::memory_order_relaxed) != expected) continue;
+		columns.push_back(column);
+	}
+
+	return end * SamplesPerColumn;
+}
+
+void PlotFeed::Decimate(const std::vector<Column>& columns, int width, std::vector<Column>& decimated)
+{
+	decimated.clear();
+	if (width <= 0 || columns.empty()) return;
+
+	auto size = (int)columns.size();
+	auto buckets = std::min(width, size);
+	decimated.reserve((size_t)buckets);
+
+	for (int bucket = 0; bucket < buckets; bucket++)
+	{
+		// Bucket edges spread the remainder evenly, so every source column lands in one bucket
+		auto first = (int)((int64_t)bucket * size / buckets);
+		auto last = (int)((int64_t)(bucket + 1) * size / buckets);
+
+		auto merged = columns[first];
+		for (auto i = first + 1; i < last; i++)
+		{
+			for (int channel = 0; channel < ChannelCount; channel++)
+			{
+				merged.minimum[channel] = std::min(merged.minimum[channel], columns[i].minimum[channel]);
+				merged.maximum[channel] = std::max(merged.maximum[channel], columns[i].maximum[channel]);
+			}
+		}
+		decimated.push_back(merged);
+	}
+}
@@ -0,0 +1,64 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+// Live signal history for plotting. The input thread pushes one sample per packet and folds every
+// SamplesPerColumn samples into a min/max column, which is published into a ring of seqlocked
+// slots like PacketBroadcast's. Pushing never waits and costs the same whether anyone reads;
+// a reader copies the newest columns and decimates them to its plot width.
+class PlotFeed
+{
+public:
+	static constexpr auto SamplesPerColumn = 4;
+	static constexpr auto Capacity = 2048; // columns kept, must be a power of two
+
+	enum Channel
+	{
+		GyroX, // raw rates in degrees per second
+		GyroY,
+		GyroZ,
+		FilteredX, // what drives the cursor: dead-zoned rates, or orientation in air mouse mode
+		FilteredY,
+		CursorDx, // pixels the cursor moved for this packet
+		CursorDy,
+		ChannelCount
+	};
+
+	struct Column
+	{
+		float minimum[ChannelCount];
+		float maximum[ChannelCount];
+	};
+
+	PlotFeed();
+
+	// Input thread only
+	void Push(const float (&values)[ChannelCount]);
+
+	// Any thread. Copies up to count of the newest columns, oldest first, and returns how many
+	// samples those and all earlier columns hold, from which a reader derives the packet rate.
+	uint64_t Read(std::vector<Column>& columns, int count) const;
+
+	// Merges columns into at most width columns, keeping each channel's extremes
+	static void Decimate(const std::vector<Column>& columns, int width, std::vector<Column>& decimated);
+private:
+	static constexpr uint64_t IndexMask = Capacity - 1;
+	static_assert((Capacity & IndexMask) == 0, "Capacity must be a power of two");
+
+	// stamp is 2 * (column + 1) once the column is written, odd while writing
+	struct Slot
+	{
+		std::atomic<uint64_t> stamp;
+		Column column;
+	};
+
+	Slot slots[Capacity];
+	alignas(64) std::atomic<uint64_t> columnCount{ 0 };
+
+	// Owned by the input thread
+	alignas(64) Column current;
+	int currentSamples = 0;
+
+	void ResetColumn();
+};
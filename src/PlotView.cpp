@@ -0,0 +1,155 @@
+#include "PlotView.h"
+#include <QPainter>
+#include <QPaintEvent>
+#include <QPen>
+#include <algorithm>
+#include <cmath>
+
+static const QColor ChannelColors[] = { QColor(220, 60, 60), QColor(60, 170, 60), QColor(60, 100, 220) };
+static constexpr auto PlotCount = 4;
+static constexpr auto Margin = 4;
+static constexpr auto TitleHeight = 14;
+
+PlotView::PlotView(const PlotFeed& feed, QWidget* parent) :
+	QWidget(parent),
+	feed(feed),
+	rateHistory(RateHistoryPoints, 0.0f)
+{
+	setMinimumSize(420, 360);
+
+	repaintTimer.setInterval(1000 / MaxFramesPerSecond);
+	connect(&repaintTimer, &QTimer::timeout, [this]() {
+		update(); // coalesced by Qt, so a slow paint drops frames instead of queueing them
+	});
+}
+
+void PlotView::showEvent(QShowEvent* event)
+{
+	QWidget::showEvent(event);
+	lastRateTime = std::chrono::steady_clock::now();
+	lastSampleCount = feed.Read(columns, 0);
+	repaintTimer.start();
+}
+
+void PlotView::hideEvent(QHideEvent* event)
+{
+	repaintTimer.stop();
+	QWidget::hideEvent(event);
+}
+
+void PlotView::UpdatePacketRate(uint64_t sampleCount)
+{
+	auto now = std::chrono::steady_clock::now();
+	if (now - lastRateTime < std::chrono::milliseconds(RateIntervalMs)) return;
+
+	auto seconds = std::chrono::duration<float>(now - lastRateTime).count();
+	rateHistory[rateHistoryNext] = (sampleCount - lastSampleCount) / seconds;
+	rateHistoryNext = (rateHistoryNext + 1) % RateHistoryPoints;
+
+	lastRateTime = now;
+	lastSampleCount = sampleCount;
+}
+
+void PlotView::paintEvent(QPaintEvent*)
+{
+	UpdatePacketRate(feed.Read(columns, HistoryColumns));
+
+	QPainter painter(this);
+	painter.fillRect(rect(), palette().base());
+
+	auto plotHeight = (height() - Margin * (PlotCount + 1)) / PlotCount;
+	auto plotArea = [&](int index) {
+		return QRect(Margin, Margin + index * (plotHeight + Margin), width() - 2 * Margin, plotHeight);
+	};
+
+	PlotFeed::Decimate(columns, plotArea(0).width(), decimated);
+
+	DrawChannels(painter, plotArea(0), "Gyro (deg/s)", PlotFeed::GyroX, 3);
+	DrawChannels(painter, plotArea(1), "Filtered", PlotFeed::FilteredX, 2);
+	DrawChannels(painter, plotArea(2), "Cursor delta (px)", PlotFeed::CursorDx, 2);
+	DrawRate(painter, plotArea(3));
+}
+
+// Each pixel column is drawn as a vertical span from the bucket's minimum to its maximum, widened
+// to meet the previous bucket so that fast swings stay connected
+void PlotView::DrawChannels(QPainter& painter, const QRect& area, const char* title, int firstChannel, int channelCount)
+{
+	painter.setPen(palette().mid().color());
+	painter.drawRect(area);
+	painter.setPen(palette().text().color());
+	painter.drawText(area.adjusted(Margin, 0, 0, 0), Qt::AlignLeft | Qt::AlignTop, title);
+
+	auto plot = area.adjusted(0, TitleHeight, 0, 0);
+	if (decimated.empty() || plot.height() <= 0) return;
+
+	auto scale = 1.0f;
+	for (auto& column : decimated)
+	{
+		for (auto channel = firstChannel; channel < firstChannel + channelCount; channel++)
+		{
+			scale = std::max({ scale, std::abs(column.minimum[channel]), std::abs(column.maximum[channel]) });
+		}
+	}
+
+	auto centerY = plot.center().y();
+	auto halfHeight = plot.height() / 2.0f;
+	auto toY = [&](float value) { return centerY - value / scale * halfHeight; };
+
+	painter.setPen(palette().mid().color());
+	painter.drawLine(plot.left(), centerY, plot.right(), centerY);
+
+	// Newest column on the right edge
+	auto left = plot.right() - (int)decimated.size() + 1;
+	std::vector<QLineF> lines(decimated.size());
+	for (int index = 0; index < channelCount; index++)
+	{
+		auto channel = firstChannel + index;
+		for (size_t i = 0; i < decimated.size(); i++)
+		{
+			auto low = decimated[i].minimum[channel];
+			auto high = decimated[i].maximum[channel];
+			if (i > 0)
+			{
+				low = std::min(low, decimated[i - 1].maximum[channel]);
+				high = std::max(high, decimated[i - 1].minimum[channel]);
+			}
+
+			auto x = left + (qreal)i;
+			lines[i] = QLineF(x, toY(low), x, toY(high));
+		}
+
+		painter.setPen(QPen(ChannelColors[index], 1));
+		painter.drawLines(lines.data(), (int)lines.size());
+	}
+
+	painter.setPen(palette().text().color());
+	painter.drawText(area.adjusted(0, 0, -Margin, 0), Qt::AlignRight | Qt::AlignTop, QString("max %1").arg(scale, 0, 'f', 1));
+}
+
+void PlotView::DrawRate(QPainter& painter, const QRect& area)
+{
+	auto current = rateHistory[(rateHistoryNext + RateHistoryPoints - 1) % RateHistoryPoints];
+
+	painter.setPen(palette().mid().color());
+	painter.drawRect(area);
+	painter.setPen(palette().text().color());
+	painter.drawText(area.adjusted(Margin, 0, 0, 0), Qt::AlignLeft | Qt::AlignTop,
+		QString("Packet rate: %1 Hz").arg(current, 0, 'f', 0));
+
+	auto plot = area.adjusted(0, TitleHeight, 0, 0);
+	if (plot.height() <= 0) return;
+
+	auto scale = std::max(1.0f, *std::max_element(rateHistory.begin(), rateHistory.end()));
+	auto stepX = (qreal)plot.width() / (RateHistoryPoints - 1);
+
+	QPolygonF points;
+	points.reserve(RateHistoryPoints);
+	for (int i = 0; i < RateHistoryPoints; i++)
+	{
+		auto rate = rateHistory[(rateHistoryNext + i) % RateHistoryPoints]; // oldest first
+		points.append(QPointF(plot.left() + i * stepX, plot.bottom() - rate / scale * (plot.height() - 1)));
+	}
+
+	painter.setPen(QPen(ChannelColors[2], 1));
+	painter.drawPolyline(points);
+}
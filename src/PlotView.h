@@ -0,0 +1,41 @@
+#pragma once
+#include "PlotFeed.h"
+#include <QTimer>
+#include <QWidget>
+#include <chrono>
+#include <vector>
+
+class QPainter;
+
+// Live plots of a PlotFeed: raw gyro, filtered values, cursor deltas and packet rate. Repaints at
+// most MaxFramesPerSecond times a second and only while shown. Reading the feed never makes the
+// input thread wait.
+class PlotView : public QWidget
+{
+public:
+	static constexpr auto MaxFramesPerSecond = 30;
+	static constexpr auto HistoryColumns = 1024; // about 40 s of packets at 100 Hz
+	static constexpr auto RateIntervalMs = 1000; // the feed counts whole columns, so shorter intervals jitter
+	static constexpr auto RateHistoryPoints = 60;
+
+	explicit PlotView(const PlotFeed& feed, QWidget* parent = nullptr);
+protected:
+	void paintEvent(QPaintEvent* event) override;
+	void showEvent(QShowEvent* event) override;
+	void hideEvent(QHideEvent* event) override;
+private:
+	const PlotFeed& feed;
+	QTimer repaintTimer;
+
+	std::vector<PlotFeed::Column> columns;
+	std::vector<PlotFeed::Column> decimated;
+
+	std::chrono::steady_clock::time_point lastRateTime;
+	uint64_t lastSampleCount = 0;
+	std::vector<float> rateHistory; // packets per second, one per RateIntervalMs
+	int rateHistoryNext = 0;
+
+	void UpdatePacketRate(uint64_t sampleCount);
+	void DrawChannels(QPainter& painter, const QRect& area, const char* title, int firstChannel, int channelCount);
+	void DrawRate(QPainter& painter, const QRect& area);
+};
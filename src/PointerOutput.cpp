@@ -0,0 +1,254 @@
+#include "PointerOutput.h"
+#include "Logger.h"
+#include "NetworkOutput.h"
+#include "Trace.h"
+#include <atomic>
+#include <cmath>
+#include <mutex>
+
+#ifdef _WIN32
+#include <Windows.h>
+#endif
+
+namespace PointerOutput
+{
+	static int screenWidth = VirtualScreenWidth - 1;
+	static int screenHeight = VirtualScreenHeight - 1;
+
+#ifdef _WIN32
+	static INPUT input;
+
+	void Initialize()
+	{
+		HDC primary = GetDC(NULL);
+		screenWidth = GetDeviceCaps(primary, HORZRES) - 1;
+		screenHeight = GetDeviceCaps(primary, VERTRES) - 1;
+		ReleaseDC(NULL, primary);
+
+		MOUSEINPUT mouseInput{};
+		mouseInput.dx = 0;
+		mouseInput.dy = 0;
+		mouseInput.time = 0;
+		mouseInput.mouseData = 0;
+		mouseInput.dwExtraInfo = NULL;
+
+		input.type = INPUT_MOUSE;
+		input.mi = mouseInput;
+	}
+
+	static void LocalCursorPosition(float& x, float& y)
+	{
+		POINT cursor;
+		GetCursorPos(&cursor);
+		x = (float)cursor.x;
+		y = (float)cursor.y;
+	}
+
+	static bool SendMouseInput()
+	{
+		Trace::Scope scope("SendInput");
+		UINT numEvents = SendInput(1, &input, sizeof(input));
+		if (numEvents == 0)
+		{
+			Logger::Error("SendMouse failed: 0x%llx", (unsigned long)HRESULT_FROM_WIN32(GetLastError()));
+			return false;
+		}
+		return true;
+	}
+
+	static bool LocalMove(float x, float y)
+	{
+		input.mi.dx = (int)round(x * 0xffff / (float)screenWidth);
+		input.mi.dy = (int)round(y * 0xffff / (float)screenHeight);
+		input.mi.dwFlags = MOUSEEVENTF_MOVE | MOUSEEVENTF_ABSOLUTE | MOUSEEVENTF_MOVE_NOCOALESCE;
+		input.mi.mouseData = 0;
+		return SendMouseInput();
+	}
+
+	static bool LocalButton(MouseButton button, bool isDown)
+	{
+		DWORD flags = 0;
+		switch (button)
+		{
+		case MouseButton::Left: flags = isDown ? MOUSEEVENTF_LEFTDOWN : MOUSEEVENTF_LEFTUP; break;
+		case MouseButton::Right: flags = isDown ? MOUSEEVENTF_RIGHTDOWN : MOUSEEVENTF_RIGHTUP; break;
+		case MouseButton::Middle: flags = isDown ? MOUSEEVENTF_MIDDLEDOWN : MOUSEEVENTF_MIDDLEUP; break;
+		}
+
+		input.mi.dx = 0;
+		input.mi.dy = 0;
+		input.mi.dwFlags = flags;
+		input.mi.mouseData = 0;
+		return SendMouseInput();
+	}
+
+	static bool LocalScroll(int amount)
+	{
+		input.mi.dx = 0;
+		input.mi.dy = 0;
+		input.mi.dwFlags = MOUSEEVENTF_WHEEL;
+		input.mi.mouseData = (DWORD)amount;
+		return SendMouseInput();
+	}
+
+	static bool LocalKey(uint16_t key, bool isDown)
+	{
+		INPUT keyInput{};
+		keyInput.type = INPUT_KEYBOARD;
+		keyInput.ki.wVk = key;
+		keyInput.ki.dwFlags = isDown ? 0 : KEYEVENTF_KEYUP;
+
+		Trace::Scope scope("SendInput");
+		if (SendInput(1, &keyInput, sizeof(keyInput)) == 0)
+		{
+			Logger::Error("SendKey failed: 0x%llx", (unsigned long)HRESULT_FROM_WIN32(GetLastError()));
+			return false;
+		}
+		return true;
+	}
+#else
+	static float cursorX = VirtualScreenWidth / 2;
+	static float cursorY = VirtualScreenHeight / 2;
+
+	void Initialize()
+	{
+	}
+
+	static void LocalCursorPosition(float& x, float& y)
+	{
+		x = std::round(cursorX);
+		y = std::round(cursorY);
+	}
+
+	static bool LocalMove(float x, float y)
+	{
+		cursorX = x;
+		cursorY = y;
+		return true;
+	}
+
+	static bool LocalButton(MouseButton, bool)
+	{
+		return true;
+	}
+
+	static bool LocalScroll(int)
+	{
+		return true;
+	}
+
+	static bool LocalKey(uint16_t, bool)
+	{
+		return true;
+	}
+#endif
+
+	// Only touched by the thread that produces events, except for the pending target
+	static NetworkOutput::Sender sender;
+	static std::atomic<bool> isForwarding{ false };
+	static float forwardedX = 0;
+	static float forwardedY = 0;
+
+	static std::mutex targetMutex;
+	static std::atomic<bool> isTargetPending{ false };
+	static bool isPendingLocal = true;
+	static NetworkOutput::Destination pendingDestination;
+	static std::string pendingSecret;
+
+	void SetForwardTarget(const std::string& host, uint16_t port, const std::string& secret)
+	{
+		// The name lookup can block for seconds, so it is done here rather than on the packet thread
+		NetworkOutput::Destination destination;
+		if (!host.empty()) NetworkOutput::Resolve(host, port, destination);
+
+		std::lock_guard<std::mutex> lock(targetMutex);
+		isPendingLocal = host.empty();
+		pendingDestination = destination;
+		pendingSecret = secret;
+		isTargetPending = true;
+	}
+
+	static void ApplyForwardTarget()
+	{
+		std::lock_guard<std::mutex> lock(targetMutex);
+		isTargetPending = false;
+
+		if (isPendingLocal)
+		{
+			if (sender.IsOpen()) Logger::Info("Injecting input locally");
+			sender.Close();
+			isForwarding = false;
+			return;
+		}
+
+		// The remote screen starts where the local cursor is, in proportion
+		if (!sender.IsOpen()) LocalCursorPosition(forwardedX, forwardedY);
+		isForwarding = sender.Open(pendingDestination, pendingSecret);
+	}
+
+	bool IsForwarding()
+	{
+		return isForwarding.load(std::memory_order_relaxed);
+	}
+
+	void CursorPosition(float& x, float& y)
+	{
+		if (!isForwarding.load(std::memory_order_relaxed)) return LocalCursorPosition(x, y);
+
+		x = std::round(forwardedX);
+		y = std::round(forwardedY);
+	}
+
+	bool Move(float x, float y)
+	{
+		if (!isForwarding.load(std::memory_order_relaxed)) return LocalMove(x, y);
+
+		forwardedX = x;
+		forwardedY = y;
+		sender.Move(x / screenWidth, y / screenHeight);
+		return true;
+	}
+
+	bool Button(MouseButton button, bool isDown)
+	{
+		if (!isForwarding.load(std::memory_order_relaxed)) return LocalButton(button, isDown);
+
+		sender.Button(button, isDown);
+		return true;
+	}
+
+	bool Scroll(int amount)
+	{
+		if (!isForwarding.load(std::memory_order_relaxed)) return LocalScroll(amount);
+
+		sender.Scroll(amount);
+		return true;
+	}
+
+	bool Key(uint16_t key, bool isDown)
+	{
+		if (!isForwarding.load(std::memory_order_relaxed)) return LocalKey(key, isDown);
+
+		sender.Key(key, isDown);
+		return true;
+	}
+
+	void Flush()
+	{
+		if (isTargetPending.load(std::memory_order_relaxed)) ApplyForwardTarget();
+		if (!isForwarding.load(std::memory_order_relaxed)) return;
+
+		Trace::Scope scope("Forward");
+		sender.Flush();
+	}
+
+	int ScreenWidth()
+	{
+		return screenWidth;
+	}
+
+	int ScreenHeight()
+	{
+		return screenHeight;
+	}
+}
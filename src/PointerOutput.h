@@ -0,0 +1,38 @@
+#pragma once
+#include <cstdint>
+#include <string>
+
+// Injects pointer events into the operating system. On platforms without an implementation the
+// pointer is virtual: it tracks a position on a VirtualScreenWidth x VirtualScreenHeight screen so
+// that the input pipeline can run headless against simulated transports.
+//
+// Events can instead be forwarded to another machine through NetworkOutput. They are then batched
+// until Flush, which the pipeline calls once per transport notification.
+namespace PointerOutput
+{
+	static constexpr auto VirtualScreenWidth = 1920;
+	static constexpr auto VirtualScreenHeight = 1080;
+
+	enum class MouseButton
+	{
+		Left,
+		Right,
+		Middle
+	};
+
+	void Initialize();
+	int ScreenWidth(); // largest valid x coordinate
+	int ScreenHeight(); // largest valid y coordinate
+	void CursorPosition(float& x, float& y);
+
+	bool Move(float x, float y);
+	bool Button(MouseButton button, bool isDown);
+	bool Scroll(int amount);
+	bool Key(uint16_t key, bool isDown); // Windows virtual key code
+
+	// An empty host returns to local injection. Safe from any thread; resolves host on the calling
+	// thread and applies the target at the next Flush.
+	void SetForwardTarget(const std::string& host, uint16_t port, const std::string& secret);
+	bool IsForwarding();
+	void Flush();
+}
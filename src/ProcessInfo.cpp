@@ -0,0 +1,52 @@
+#include "ProcessInfo.h"
+#include <chrono>
+#include <cstdio>
+
+#ifdef _WIN32
+#include <Windows.h>
+#include <psapi.h>
+#pragma comment(lib, "psapi.lib")
+#else
+#include <unistd.h>
+#endif
+
+namespace ProcessInfo
+{
+#ifdef _WIN32
+	uint64_t MicrosecondsSinceStart()
+	{
+		FILETIME creation, exit, kernel, user, now;
+		if (!GetProcessTimes(GetCurrentProcess(), &creation, &exit, &kernel, &user)) return 0;
+		GetSystemTimePreciseAsFileTime(&now);
+
+		auto ticks = [](FILETIME time) { return ((uint64_t)time.dwHighDateTime << 32) | time.dwLowDateTime; };
+		return (ticks(now) - ticks(creation)) / 10; // FILETIME counts 100 ns
+	}
+
+	uint64_t ResidentMemoryKiB()
+	{
+		PROCESS_MEMORY_COUNTERS counters{};
+		if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) return 0;
+		return counters.WorkingSetSize / 1024;
+	}
+#else
+	static const auto startTime = std::chrono::steady_clock::now();
+
+	uint64_t MicrosecondsSinceStart()
+	{
+		return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - startTime).count();
+	}
+
+	uint64_t ResidentMemoryKiB()
+	{
+		auto file = std::fopen("/proc/self/statm", "r");
+		if (file == nullptr) return 0;
+
+		unsigned long long size = 0, resident = 0;
+		auto fields = std::fscanf(file, "%llu %llu", &size, &resident);
+		std::fclose(file);
+
+		return fields == 2 ? resident * (uint64_t)sysconf(_SC_PAGESIZE) / 1024 : 0;
+	}
+#endif
+}
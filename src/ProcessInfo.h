@@ -0,0 +1,11 @@
+#pragma once
+#include <cstdint>
+
+// Startup and footprint figures that both the tray build and the daemon log once ready
+namespace ProcessInfo
+{
+	// On Windows this counts from process creation. Elsewhere it counts from static
+	// initialization, which misses only the dynamic loader.
+	uint64_t MicrosecondsSinceStart();
+	uint64_t ResidentMemoryKiB();
+}
@@ -0,0 +1,238 @@
+#include "Profiles.h"
+#include "Foreground.h"
+#include "Logger.h"
+#include "Trace.h"
+#include <algorithm>
+#include <cstdlib>
+#include <limits>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace Profiles
+{
+	static std::string Trim(const std::string& text)
+	{
+		auto first = text.find_first_not_of(" \t\r");
+		if (first == std::string::npos) return "";
+		auto last = text.find_last_not_of(" \t\r");
+		return text.substr(first, last - first + 1);
+	}
+
+	static bool ParseForwardTarget(const std::string& value, Profile& profile)
+	{
+		profile.forwardHost.clear();
+		profile.forwardPort = NetworkOutput::DefaultPort;
+		if (value == "local") return true;
+
+		// An IPv6 address needs brackets to carry a port, a bare one has more than one colon
+		std::string port;
+		if (!value.empty() && value[0] == '[')
+		{
+			auto close = value.find(']');
+			if (close == std::string::npos) return false;
+			profile.forwardHost = value.substr(1, close - 1);
+			if (close + 1 < value.size())
+			{
+				if (value[close + 1] != ':') return false;
+				port = value.substr(close + 2);
+			}
+		}
+		else if (value.find(':') != std::string::npos && value.find(':') == value.rfind(':'))
+		{
+			profile.forwardHost = value.substr(0, value.find(':'));
+			port = value.substr(value.find(':') + 1);
+		}
+		else
+		{
+			profile.forwardHost = value;
+		}
+
+		if (profile.forwardHost.empty()) return false;
+		if (port.empty()) return true;
+
+		char* end;
+		auto number = std::strtol(port.c_str(), &end, 10);
+		if (*end != '\0' || number < 1 || number > UINT16_MAX) return false;
+		profile.forwardPort = (uint16_t)number;
+		return true;
+	}
+
+	static bool ParseFloat(const std::string& value, float minimum, float maximum, float& result)
+	{
+		char* end;
+		auto number = std::strtof(value.c_str(), &end);
+		if (end == value.c_str() || *end != '\0' || !(number >= minimum && number <= maximum)) return false;
+		result = number;
+		return true;
+	}
+
+	static bool ParseSetting(const std::string& key, const std::string& value, Profile& profile)
+	{
+		if (key == "pointing_mode")
+		{
+			if (value == "relative") profile.pointingMode = Input::PointingMode::Relative;
+			else if (value == "absolute") profile.pointingMode = Input::PointingMode::Absolute;
+			else return false;
+			return true;
+		}
+
+		if (key == "prediction_latency_ms")
+		{
+			char* end;
+			auto latency = std::strtof(value.c_str(), &end);
+			if (end == value.c_str() || *end != '\0' || latency < 0 || latency > MaxPredictionLatencyMs) return false;
+			profile.predictionLatencyMs = latency;
+			return true;
+		}
+
+		if (key == "forward_to")
+		{
+			return ParseForwardTarget(value, profile);
+		}
+
+		if (key == "forward_secret")
+		{
+			profile.forwardSecret = value;
+			return !value.empty();
+		}
+
+		if (key == "trace_gap_ms")
+		{
+			char* end;
+			auto gap = std::strtol(value.c_str(), &end, 10);
+			if (end == value.c_str() || *end != '\0' || gap < 0 || gap > MaxTraceGapMs) return false;
+			profile.traceGapMs = (int)gap;
+			return true;
+		}
+
+		return false;
+	}
+
+	static bool ParseTuningSetting(const std::string& key, const std::string& value, Input::Tuning& tuning)
+	{
+		auto& curve = tuning.responseCurve;
+		auto positive = std::numeric_limits<float>::min();
+		auto unbounded = std::numeric_limits<float>::max();
+		if (key == "mouse_sensitivity") return ParseFloat(value, positive, unbounded, curve.mouseSensitivity);
+		if (key == "mouse_power") return ParseFloat(value, 1, MaxPowerFactor, curve.mousePowerFactor);
+		if (key == "mouse_dead_zone") return ParseFloat(value, 0, unbounded, curve.mouseDeadZone);
+		if (key == "scroll_sensitivity") return ParseFloat(value, positive, unbounded, curve.scrollSensitivity);
+		if (key == "scroll_power") return ParseFloat(value, 1, MaxPowerFactor, curve.scrollPowerFactor);
+		if (key == "scroll_dead_zone") return ParseFloat(value, 0, unbounded, curve.scrollDeadZone);
+		if (key == "scroll_tolerance") return ParseFloat(value, 0, unbounded, curve.scrollTolerance);
+		if (key == "drag_tolerance") return ParseFloat(value, 0, unbounded, curve.dragTolerance);
+
+		auto& click = tuning.clickStabilization;
+		if (key == "click_rewind_ms") return ParseFloat(value, 0, MaxClickWindowMs, click.rewindMs);
+		if (key == "click_hold_ms") return ParseFloat(value, 0, MaxClickWindowMs, click.holdMs);
+		if (key == "click_move_pixels") return ParseFloat(value, positive, unbounded, click.movePixels);
+
+		return ButtonMapper::ParseSetting(key, value, tuning.buttons);
+	}
+
+	// The current profile last. Those before it are retired, and each switch frees the ones whose
+	// tuning blocks Input no longer reads or compares, so only one Input is still on stays behind.
+	static std::mutex switchMutex;
+	static std::vector<std::unique_ptr<const Profile>> appliedProfiles;
+	static std::string foregroundApplication;
+
+	bool Load(const char* path, Profile& profile)
+	{
+		std::ifstream file(path);
+		if (!file) return false;
+
+		Profile loaded;
+		Input::Tuning* application = nullptr; // the section being read, none before the first
+		std::string line;
+		long long lineNumber = 0;
+
+		while (std::getline(file, line))
+		{
+			lineNumber++;
+			line = Trim(line);
+			if (line.empty() || line[0] == '#') continue;
+
+			auto isValid = false;
+			auto separator = line.find('=');
+			if (line.front() == '[' && line.back() == ']')
+			{
+				auto name = Foreground::Normalize(Trim(line.substr(1, line.size() - 2)));
+				isValid = !name.empty() && loaded.applications.count(name) == 0;
+				if (isValid) application = &loaded.applications.emplace(name, loaded.tuning).first->second;
+			}
+			else if (separator != std::string::npos)
+			{
+				auto key = Trim(line.substr(0, separator));
+				auto value = Trim(line.substr(separator + 1));
+				isValid = application ? ParseTuningSetting(key, value, *application)
+					: ParseSetting(key, value, loaded) || ParseTuningSetting(key, value, loaded.tuning);
+			}
+
+			if (!isValid)
+			{
+				Logger::Warning("Profile line %lld is not a valid setting, profile not loaded", lineNumber);
+				return false;
+			}
+		}
+
+		if (!loaded.forwardHost.empty() && loaded.forwardSecret.empty())
+		{
+			Logger::Warning("Profile forwards input without forward_secret, profile not loaded");
+			return false;
+		}
+
+		auto isCompiled = ButtonMapper::Compile(loaded.tuning.buttons);
+		for (auto& entry : loaded.applications) isCompiled &= ButtonMapper::Compile(entry.second.buttons);
+		if (!isCompiled)
+		{
+			Logger::Warning("Profile binds a button press together with a tap or hold, profile not loaded");
+			return false;
+		}
+
+		profile = loaded;
+		return true;
+	}
+
+	static bool IsInUse(const Profile& profile)
+	{
+		if (Input::IsTuningInUse(&profile.tuning)) return true;
+		for (auto& entry : profile.applications)
+		{
+			if (Input::IsTuningInUse(&entry.second)) return true;
+		}
+		return false;
+	}
+
+	// Caller holds switchMutex
+	static void SwitchTuning()
+	{
+		auto& profile = *appliedProfiles.back();
+		auto application = profile.applications.find(foregroundApplication);
+		Input::SetTuning(application == profile.applications.end() ? &profile.tuning : &application->second);
+
+		appliedProfiles.erase(std::remove_if(appliedProfiles.begin(), appliedProfiles.end() - 1,
+			[](const std::unique_ptr<const Profile>& retired) { return !IsInUse(*retired); }), appliedProfiles.end() - 1);
+	}
+
+	void Apply(const Profile& profile)
+	{
+		Input::SetPointingMode(profile.pointingMode);
+		Input::SetPredictionLatency(profile.predictionLatencyMs);
+		PointerOutput::SetForwardTarget(profile.forwardHost, profile.forwardPort, profile.forwardSecret);
+		Trace::SetGapTrigger(profile.traceGapMs);
+
+		std::lock_guard<std::mutex> lock(switchMutex);
+		appliedProfiles.push_back(std::make_unique<const Profile>(profile));
+		SwitchTuning();
+	}
+
+	void SetForegroundApplication(const std::string& application)
+	{
+		std::lock_guard<std::mutex> lock(switchMutex);
+		foregroundApplication = Foreground::Normalize(application);
+		if (!appliedProfiles.empty()) SwitchTuning();
+	}
+}
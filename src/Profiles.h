@@ -0,0 +1,55 @@
+#pragma once
+#include "Input.h"
+#include "NetworkOutput.h"
+#include <string>
+#include <unordered_map>
+
+// User settings loaded from a plain text file of "key = value" lines. Lines starting with # are
+// comments. Keys:
+//   pointing_mode = relative | absolute
+//   prediction_latency_ms = 0 .. MaxPredictionLatencyMs (0 disables prediction; longer latencies are left uncompensated)
+//   forward_to = host[:port] | [ipv6]:port | local (forwards input to a NetworkOutput receiver)
+//   forward_secret = text shared with the receiver, which authenticates every datagram (needed by forward_to)
+//   trace_gap_ms = 0 .. MaxTraceGapMs (dumps a trace when data stops for this long, 0 disables)
+//   mouse_sensitivity, scroll_sensitivity = greater than 0
+//   mouse_power, scroll_power = 1 .. MaxPowerFactor
+//   mouse_dead_zone, scroll_dead_zone, scroll_tolerance, drag_tolerance = 0 or more
+//   click_rewind_ms, click_hold_ms = 0 .. MaxClickWindowMs (0 disables that part of click stabilization)
+//   click_move_pixels = greater than 0
+// The response curve keys override Input::DefaultResponseCurve; tools/ResponseTuner.cpp writes them.
+// Button bindings, chord_window_ms and long_press_ms are described in ButtonMapper.h and override
+// single entries of ButtonMapper::DefaultTable.
+//
+// A line "[firefox.exe]" starts the settings for one application, named as Foreground reports it,
+// up to the next such line. They start from everything above the first one and may set the
+// response curve, click and button keys. These apply while that application is in the foreground.
+namespace Profiles
+{
+	static constexpr auto DefaultProfilePath = "GestureBackend.profile";
+	static constexpr auto MaxPredictionLatencyMs = 20.0f; // beyond this MotionPredictor overshoots reaches by tens of pixels
+	static constexpr auto MaxTraceGapMs = 60000;
+	static constexpr auto MaxPowerFactor = 3.0f;
+	static constexpr auto MaxClickWindowMs = 200.0f;
+
+	struct Profile
+	{
+		Input::PointingMode pointingMode = Input::PointingMode::Relative;
+		float predictionLatencyMs = Input::DefaultPredictionLatencyMs;
+		std::string forwardHost; // empty to inject locally
+		uint16_t forwardPort = NetworkOutput::DefaultPort;
+		std::string forwardSecret;
+		int traceGapMs = 0;
+		Input::Tuning tuning = Input::DefaultTuning();
+		std::unordered_map<std::string, Input::Tuning> applications; // by normalized application name
+	};
+
+	// Leaves profile untouched and returns false when the file is missing or has an invalid line
+	bool Load(const char* path, Profile& profile);
+
+	// Keeps a copy whose tuning follows the foreground application from then on
+	void Apply(const Profile& profile);
+
+	// Any thread, typically a Foreground listener. Switches Input to the application's tuning,
+	// resolved when the profile was applied, with one pointer store.
+	void SetForegroundApplication(const std::string& application);
+}
@@ -0,0 +1,236 @@
+#include "RemoteControl.h"
+#include "Logger.h"
+#include <iterator>
+
+namespace RemoteControl
+{
+	Configuration UsageModeConfiguration(UsageMode mode)
+	{
+		switch (mode)
+		{
+		case UsageMode::Precision: return { 100, 250, PacketFormat::Standard };
+		case UsageMode::Normal: return { 100, 500, PacketFormat::Standard };
+		case UsageMode::Fast: return { 200, 1000, PacketFormat::Standard };
+		}
+		return { DefaultSampleRateHz, DefaultGyroRange, PacketFormat::Standard };
+	}
+
+	int GyroRangeCode(uint16_t gyroRange)
+	{
+		for (int i = 0; i < (int)std::size(GyroRanges); i++)
+		{
+			if (GyroRanges[i] == gyroRange) return i;
+		}
+		return -1;
+	}
+
+	Controller::Controller(WriteFunction write) : write(std::move(write))
+	{
+	}
+
+	// Must be called with the mutex held
+	bool Controller::Send(Command command, uint16_t value)
+	{
+		PendingCommand* slot = nullptr;
+		for (auto& candidate : pending)
+		{
+			if (candidate.inUse) continue;
+			slot = &candidate;
+			break;
+		}
+
+		if (slot == nullptr)
+		{
+			Logger::Warning("Too many unacknowledged remote commands, dropped opcode %lld", (int)command);
+			return false;
+		}
+
+		slot->frame = { CommandMagic, nextSequence++, command, value };
+		slot->sentTime = Clock::now();
+		slot->attempts = 1;
+		slot->inUse = true;
+
+		// A failed write is retried by CheckTimeouts like a lost acknowledgement
+		if (!write || !write((const uint8_t*)&slot->frame, sizeof(CommandFrame)))
+			Logger::Warning("Failed to write remote command %lld", (int)command);
+
+		return true;
+	}
+
+	bool Controller::SetSampleRate(uint16_t sampleRateHz)
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		return Send(Command::SetSampleRate, sampleRateHz);
+	}
+
+	bool Controller::SetGyroRange(uint16_t gyroRange)
+	{
+		if (GyroRangeCode(gyroRange) < 0) return false;
+
+		std::lock_guard<std::mutex> lock(mutex);
+		return Send(Command::SetGyroRange, gyroRange);
+	}
+
+	bool Controller::RequestStatus()
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		return Send(Command::RequestStatus, 0);
+	}
+
+	bool Controller::SetPacketFormat(PacketFormat format)
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		return Send(Command::SetPacketFormat, (uint16_t)format);
+	}
+
+	bool Controller::SetUsageMode(UsageMode mode)
+	{
+		auto target = UsageModeConfiguration(mode);
+
+		std::lock_guard<std::mutex> lock(mutex);
+		bool sent = true;
+		if (configuration.sampleRateHz != target.sampleRateHz)
+			sent &= Send(Command::SetSampleRate, target.sampleRateHz);
+		if (configuration.gyroRange != target.gyroRange)
+			sent &= Send(Command::SetGyroRange, target.gyroRange);
+		return sent;
+	}
+
+	// Called from the parser thread. The remote applies a command before acknowledging it, so
+	// every packet after the response was sampled with the configuration the response carries.
+	// Only a response to a command in flight is applied. A repeated acknowledgement of a
+	// retransmitted command is accepted and ignored; anything else is misaligned data that
+	// happens to carry the response signature.
+	bool Controller::OnResponse(const ControlResponse& response)
+	{
+		bool rejected = false;
+		Command command = (Command)response.Opcode;
+		uint16_t value = 0;
+
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+
+			PendingCommand* answered = nullptr;
+			for (auto& candidate : pending)
+			{
+				if (!candidate.inUse || candidate.frame.Sequence != response.Sequence || candidate.frame.Opcode != command) continue;
+				answered = &candidate;
+				break;
+			}
+
+			if (answered == nullptr)
+			{
+				for (auto& recent : recentlyAnswered)
+				{
+					if (recent.isValid && recent.sequence == response.Sequence && recent.opcode == command) return true;
+				}
+				return false;
+			}
+
+			answered->inUse = false;
+			value = answered->frame.Value;
+			recentlyAnswered[nextRecentlyAnswered] = { response.Sequence, command, true };
+			nextRecentlyAnswered = (nextRecentlyAnswered + 1) % MaxPendingCommands;
+
+			rejected = response.Result != (uint8_t)CommandResult::Ok;
+
+			auto rangeCode = response.GyroRangeCode & GyroRangeCodeMask;
+			if ((size_t)rangeCode < std::size(GyroRanges) && response.SampleRateHz > 0)
+			{
+				configuration = {
+					response.SampleRateHz,
+					GyroRanges[rangeCode],
+					(response.GyroRangeCode & ExtendedFormatFlag) ? PacketFormat::Extended : PacketFormat::Standard
+				};
+			}
+		}
+
+		if (rejected && CommandRejected) CommandRejected(command, value, (CommandResult)response.Result);
+		Announce();
+		return true;
+	}
+
+	// Passes the configuration on to ConfigurationChanged if it differs from what was passed last
+	void Controller::Announce()
+	{
+		Configuration updated;
+
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			isAnnouncementDue.store(false, std::memory_order_relaxed);
+			if (configuration.sampleRateHz == announced.sampleRateHz && configuration.gyroRange == announced.gyroRange
+				&& configuration.packetFormat == announced.packetFormat) return;
+			announced = configuration;
+			updated = configuration;
+		}
+
+		if (ConfigurationChanged) ConfigurationChanged(updated);
+	}
+
+	void Controller::AnnounceReset()
+	{
+		if (isAnnouncementDue.load(std::memory_order_acquire)) Announce();
+	}
+
+	// Retransmits unacknowledged commands and gives up after MaxCommandAttempts
+	void Controller::CheckTimeouts()
+	{
+		CommandFrame timedOut[MaxPendingCommands];
+		int timedOutCount = 0;
+
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			auto now = Clock::now();
+
+			for (auto& command : pending)
+			{
+				if (!command.inUse) continue;
+				if (now - command.sentTime < std::chrono::milliseconds(CommandTimeoutMs)) continue;
+
+				if (command.attempts >= MaxCommandAttempts)
+				{
+					command.inUse = false;
+					timedOut[timedOutCount++] = command.frame;
+					continue;
+				}
+
+				command.attempts++;
+				command.sentTime = now;
+				if (write) write((const uint8_t*)&command.frame, sizeof(CommandFrame));
+			}
+		}
+
+		for (int i = 0; i < timedOutCount; i++)
+		{
+			Logger::Warning("Remote command %lld (sequence %lld) timed out", (int)timedOut[i].Opcode, timedOut[i].Sequence);
+			if (CommandTimedOut) CommandTimedOut(timedOut[i].Opcode, timedOut[i].Value);
+		}
+	}
+
+	// Forgets pending commands and assumes the remote's boot configuration, for use on disconnect.
+	// Any thread: ConfigurationChanged hears of it at the next AnnounceReset on the parser thread.
+	void Controller::Reset()
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		for (auto& command : pending) command.inUse = false;
+		for (auto& recent : recentlyAnswered) recent.isValid = false;
+		configuration = { DefaultSampleRateHz, DefaultGyroRange, PacketFormat::Standard };
+		isAnnouncementDue.store(true, std::memory_order_release);
+	}
+
+	void Controller::Restore(const Configuration& restored)
+	{
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			configuration = restored;
+		}
+
+		Announce();
+	}
+
+	Configuration Controller::CurrentConfiguration() const
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		return configuration;
+	}
+}
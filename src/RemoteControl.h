@@ -0,0 +1,123 @@
+#pragma once
+#include "Packet.h"
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+
+// Host to remote command channel. Commands are written to the data characteristic and
+// acknowledged by ControlResponse frames interleaved with the gyro packets.
+namespace RemoteControl
+{
+	static constexpr uint8_t CommandMagic = 0xC5;
+	static constexpr uint8_t ResponseSignature = 0b01010110;
+	static constexpr auto CommandTimeoutMs = 250;
+	static constexpr auto MaxCommandAttempts = 3;
+	static constexpr auto MaxPendingCommands = 8;
+
+	static constexpr uint16_t GyroRanges[] = { 250, 500, 1000, 2000 }; // indexed by GyroRangeCode
+	static constexpr uint16_t DefaultSampleRateHz = 100;
+	static constexpr uint16_t DefaultGyroRange = 500;
+
+	static constexpr uint8_t GyroRangeCodeMask = 0x0F;
+	static constexpr uint8_t ExtendedFormatFlag = 0x80; // set in GyroRangeCode while ExtendedPackets are streamed
+
+	enum class Command : uint8_t
+	{
+		SetSampleRate = 1,
+		SetGyroRange = 2,
+		RequestStatus = 3,
+		SetPacketFormat = 4 // takes effect after the acknowledgement, which still uses the old format
+	};
+
+	enum class CommandResult : uint8_t
+	{
+		Ok = 0,
+		Unsupported = 1,
+		InvalidValue = 2
+	};
+
+	enum class UsageMode
+	{
+		Precision,
+		Normal,
+		Fast
+	};
+
+	struct Configuration
+	{
+		uint16_t sampleRateHz;
+		uint16_t gyroRange; // full scale in degrees per second
+		PacketFormat packetFormat;
+	};
+
+#pragma pack(push, 1)
+	struct CommandFrame
+	{
+		uint8_t Magic;
+		uint8_t Sequence;
+		Command Opcode;
+		uint16_t Value;
+	};
+#pragma pack(pop)
+
+	Configuration UsageModeConfiguration(UsageMode mode);
+	int GyroRangeCode(uint16_t gyroRange); // -1 when the range is not supported
+
+	class Controller
+	{
+	public:
+		using WriteFunction = std::function<bool(const uint8_t* data, size_t length)>;
+
+		std::function<void(Configuration)> ConfigurationChanged;
+		std::function<void(Command, uint16_t, CommandResult)> CommandRejected;
+		std::function<void(Command, uint16_t)> CommandTimedOut;
+
+		explicit Controller(WriteFunction write);
+
+		bool SetSampleRate(uint16_t sampleRateHz);
+		bool SetGyroRange(uint16_t gyroRange);
+		bool RequestStatus();
+		bool SetPacketFormat(PacketFormat format);
+		bool SetUsageMode(UsageMode mode);
+
+		bool OnResponse(const ControlResponse& response); // false when it answers no command sent
+		void CheckTimeouts();
+		void Reset();
+		void AnnounceReset(); // parser thread, before parsing each notification
+		void Restore(const Configuration& restored); // what the remote is known to stream, from the parser thread
+
+		Configuration CurrentConfiguration() const;
+	private:
+		using Clock = std::chrono::steady_clock;
+
+		struct PendingCommand
+		{
+			CommandFrame frame;
+			Clock::time_point sentTime;
+			int attempts;
+			bool inUse;
+		};
+
+		struct AnsweredCommand
+		{
+			uint8_t sequence;
+			Command opcode;
+			bool isValid;
+		};
+
+		WriteFunction write;
+		PendingCommand pending[MaxPendingCommands] = {};
+		AnsweredCommand recentlyAnswered[MaxPendingCommands] = {}; // so repeated acknowledgements are known
+		int nextRecentlyAnswered = 0;
+		uint8_t nextSequence = 0;
+		Configuration configuration{ DefaultSampleRateHz, DefaultGyroRange, PacketFormat::Standard };
+		Configuration announced = configuration; // last passed to ConfigurationChanged
+		std::atomic<bool> isAnnouncementDue{ false };
+		mutable std::mutex mutex;
+
+		bool Send(Command command, uint16_t value);
+		void Announce();
+	};
+}
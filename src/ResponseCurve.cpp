@@ -0,0 +1,36 @@
+#include "ResponseCurve.h"
+#include <cmath>
+
+namespace ResponseCurve
+{
+	static float Cook(float rate, float powerFactor, float sensitivity)
+	{
+		return (float)(rate * std::pow(std::abs(rate), powerFactor - 1) / sensitivity);
+	}
+
+	Motion Apply(const Parameters& parameters, Vector3 gyro, float interval)
+	{
+		auto scale = interval * ReferenceSampleRateHz;
+
+		Motion motion;
+		motion.dx = std::abs(gyro.Z) < parameters.mouseDeadZone ? 0 : gyro.Z;
+		motion.dy = std::abs(gyro.X) < parameters.mouseDeadZone ? 0 : gyro.X;
+		motion.scroll = std::abs(gyro.Y) < parameters.scrollDeadZone ? 0 : gyro.Y;
+
+		// Positive Z turns the remote left
+		motion.cookedDx = -Cook(motion.dx, parameters.mousePowerFactor, parameters.mouseSensitivity) * scale;
+		motion.cookedDy = Cook(motion.dy, parameters.mousePowerFactor, parameters.mouseSensitivity) * scale;
+		motion.cookedScroll = Cook(motion.scroll, parameters.scrollPowerFactor, parameters.scrollSensitivity) * scale;
+		return motion;
+	}
+
+	bool IsScrollGesture(const Parameters& parameters, const Motion& motion)
+	{
+		return std::abs(motion.scroll) > parameters.scrollTolerance;
+	}
+
+	bool IsDragGesture(const Parameters& parameters, const Motion& motion)
+	{
+		return motion.dx * motion.dx + motion.dy * motion.dy > parameters.dragTolerance;
+	}
+}
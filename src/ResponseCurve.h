@@ -0,0 +1,43 @@
+#pragma once
+#include "Packet.h"
+
+// Maps gyro rates to cursor and scroll motion for relative pointing. Kept free of Input's state so
+// that offline tools run exactly the transform the packet thread does.
+//
+// Motion is the curved angular rate integrated over the time a sample stands for, so the cursor
+// covers the same distance whatever the remote's sample rate, and a faster rate only adds resolution.
+namespace ResponseCurve
+{
+	// The sensitivities are in pixels per sample at this rate (RemoteControl::DefaultSampleRateHz),
+	// which is what they were tuned as before motion was scaled by the sample interval
+	static constexpr auto ReferenceSampleRateHz = 100.0f;
+
+	struct Parameters
+	{
+		float mouseSensitivity; // the curved rate is divided by this into pixels per reference sample
+		float mousePowerFactor;
+		float mouseDeadZone; // degrees per second
+		float scrollSensitivity;
+		float scrollPowerFactor;
+		float scrollDeadZone;
+		float scrollTolerance; // scroll rate that turns a middle press into scrolling
+		float dragTolerance; // squared pointing rate that turns a middle press into dragging
+	};
+
+	struct Motion
+	{
+		float dx; // dead-zoned rates in degrees per second: Z moves horizontally, X vertically, Y scrolls
+		float dy;
+		float scroll;
+		float cookedDx; // pixels and scroll steps for this sample, fractional
+		float cookedDy;
+		float cookedScroll;
+	};
+
+	// interval is the time in seconds the sample stands for, normally one sample period
+	Motion Apply(const Parameters& parameters, Vector3 gyro, float interval);
+
+	// What an undetermined middle press becomes once motion passes the tolerances
+	bool IsScrollGesture(const Parameters& parameters, const Motion& motion);
+	bool IsDragGesture(const Parameters& parameters, const Motion& motion);
+}
@@ -0,0 +1,116 @@
+#include "Session.h"
+#include "Logger.h"
+#include <cstdint>
+
+namespace Session
+{
+	static FILE* OpenFile(const char* path, const char* mode)
+	{
+		FILE* file = nullptr;
+#ifdef _WIN32
+		if (fopen_s(&file, path, mode) != 0) file = nullptr;
+#else
+		file = fopen(path, mode);
+#endif
+		return file;
+	}
+
+	static bool WriteHeader(FILE* file)
+	{
+		Header header{ Magic, Version, (uint32_t)sizeof(Sample), 0 };
+		return fwrite(&header, sizeof(header), 1, file) == 1;
+	}
+
+	bool Load(const char* path, std::vector<Sample>& samples)
+	{
+		auto file = OpenFile(path, "rb");
+		if (!file) return false;
+
+		Header header;
+		auto isValid = fread(&header, sizeof(header), 1, file) == 1
+			&& header.magic == Magic && header.version == Version && header.sampleSize == sizeof(Sample);
+
+		samples.clear();
+		Sample sample;
+		while (isValid && fread(&sample, sizeof(sample), 1, file) == 1) samples.push_back(sample);
+
+		fclose(file);
+		return isValid;
+	}
+
+	bool Save(const char* path, const std::vector<Sample>& samples)
+	{
+		auto file = OpenFile(path, "wb");
+		if (!file) return false;
+
+		auto isWritten = WriteHeader(file)
+			&& fwrite(samples.data(), sizeof(Sample), samples.size(), file) == samples.size();
+		return fclose(file) == 0 && isWritten;
+	}
+
+	Vector3 Rates(const Sample& sample)
+	{
+		float range = sample.gyroRange;
+		return { sample.gyro.X * range / INT16_MAX, sample.gyro.Y * range / INT16_MAX, sample.gyro.Z * range / INT16_MAX };
+	}
+
+	Recorder::Recorder(PacketBroadcast& broadcast) : broadcast(broadcast)
+	{
+	}
+
+	Recorder::~Recorder()
+	{
+		uint64_t skippedCount;
+		Stop(skippedCount);
+	}
+
+	bool Recorder::Start(const std::string& path)
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		if (file) return false;
+
+		file = OpenFile(path.c_str(), "wb");
+		if (!file) return false;
+		if (!WriteHeader(file))
+		{
+			fclose(file);
+			file = nullptr;
+			return false;
+		}
+
+		sampleCount = 0;
+		auto output = file;
+		// Skips rather than detaches when lapped: a gap in a long recording is better than its end
+		subscription = std::make_unique<PacketBroadcast::Subscription>(broadcast, PacketBroadcast::LagPolicy::Skip,
+			[this, output](const PacketBroadcast::Entry& entry, bool) {
+				Sample sample{ entry.timestampNs, entry.packet.Gyro, entry.packet.Accel, entry.gyroRange,
+					entry.packet.ButtonData, entry.format };
+				if (fwrite(&sample, sizeof(sample), 1, output) == 1) sampleCount.fetch_add(1, std::memory_order_relaxed);
+			});
+
+		Logger::Info("Recording session");
+		return true;
+	}
+
+	uint64_t Recorder::Stop(uint64_t& skippedCount)
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		skippedCount = 0;
+		if (!file) return 0;
+
+		skippedCount = subscription->SkippedCount();
+		subscription.reset(); // joins the writing thread
+		fclose(file);
+		file = nullptr;
+
+		auto written = sampleCount.load();
+		Logger::Info("Recorded %lld samples, %lld skipped", written, skippedCount);
+		return written;
+	}
+
+	bool Recorder::IsRecording() const
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		return file != nullptr;
+	}
+}
@@ -0,0 +1,67 @@
+#pragma once
+#include "Packet.h"
+#include "PacketBroadcast.h"
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Recorded gyro sessions for offline tools such as tools/ResponseTuner.cpp. A session file is a
+// Header followed by one Sample per decoded packet, written in the host's byte order.
+namespace Session
+{
+	static constexpr uint32_t Magic = 0x53455347; // "GSES"
+	static constexpr uint32_t Version = 1;
+	static constexpr auto DefaultPath = "GestureSession.bin";
+
+	struct Header
+	{
+		uint32_t magic;
+		uint32_t version;
+		uint32_t sampleSize; // lets a reader reject files written with another Sample layout
+		uint32_t reserved;
+	};
+
+	struct Sample
+	{
+		int64_t timestampNs; // arrival at the parser, steady clock
+		Vector3Int16 gyro;
+		Vector3Int16 accel; // zero for standard packets
+		uint16_t gyroRange; // full scale in degrees per second
+		uint8_t buttons;
+		PacketFormat format;
+	};
+
+	static_assert(sizeof(Sample) == 24, "Sample layout is part of the file format");
+
+	// False when the file is missing, not a session or truncated mid-header
+	bool Load(const char* path, std::vector<Sample>& samples);
+	bool Save(const char* path, const std::vector<Sample>& samples);
+
+	// Gyro rates of a sample in degrees per second
+	Vector3 Rates(const Sample& sample);
+
+	// Appends every packet published on a PacketBroadcast to a session file, from its own thread
+	class Recorder
+	{
+	public:
+		explicit Recorder(PacketBroadcast& broadcast);
+		~Recorder();
+
+		// False when already recording or the file cannot be created
+		bool Start(const std::string& path);
+		// Returns how many samples were written. Packets the recorder fell too far behind to see
+		// leave a gap in the timestamps.
+		uint64_t Stop(uint64_t& skippedCount);
+		bool IsRecording() const;
+	private:
+		PacketBroadcast& broadcast;
+		mutable std::mutex mutex; // serializes Start and Stop
+		FILE* file = nullptr;
+		std::unique_ptr<PacketBroadcast::Subscription> subscription;
+		std::atomic<uint64_t> sampleCount{ 0 };
+	};
+}
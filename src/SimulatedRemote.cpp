@@ -0,0 +1,139 @@
+#include "SimulatedRemote.h"
+#include "PacketSchema.h"
+#include <algorithm>
+#include <cmath>
+
+SimulatedRemote::SimulatedRemote(TransmitFunction transmit, uint32_t seed) :
+	transmit(std::move(transmit)),
+	random(seed)
+{
+}
+
+int16_t SimulatedRemote::ToRaw(float value, float range)
+{
+	auto raw = std::round(value * INT16_MAX / range);
+	return (int16_t)std::clamp(raw, (float)-INT16_MAX, (float)INT16_MAX);
+}
+
+// Host write. Applies the command and queues its acknowledgement ahead of the next sample.
+bool SimulatedRemote::Receive(const uint8_t* data, size_t length)
+{
+	using namespace RemoteControl;
+
+	if (length != sizeof(CommandFrame)) return false;
+	if (chance(random) < commandLossRate) return true; // lost over the air, the host cannot tell
+
+	CommandFrame frame;
+	std::copy(data, data + length, (uint8_t*)&frame);
+	if (frame.Magic != CommandMagic) return false;
+
+	auto result = CommandResult::Ok;
+	auto responseFormat = configuration.packetFormat;
+
+	switch (frame.Opcode)
+	{
+	case Command::SetSampleRate:
+		if (frame.Value == 0 || frame.Value > 1000)
+			result = CommandResult::InvalidValue;
+		else
+			configuration.sampleRateHz = frame.Value;
+		break;
+	case Command::SetGyroRange:
+		if (GyroRangeCode(frame.Value) < 0)
+			result = CommandResult::InvalidValue;
+		else
+			configuration.gyroRange = frame.Value;
+		break;
+	case Command::SetPacketFormat:
+		if (frame.Value > (uint16_t)PacketFormat::Extended)
+			result = CommandResult::InvalidValue;
+		else
+			configuration.packetFormat = (PacketFormat)frame.Value;
+		break;
+	case Command::RequestStatus:
+		break;
+	default:
+		result = CommandResult::Unsupported;
+		break;
+	}
+
+	if (queuedResponseCount == MaxQueuedResponses) return true;
+
+	auto& queued = queuedResponses[queuedResponseCount++];
+	queued.format = responseFormat;
+
+	auto& response = queued.response;
+	response.Sequence = frame.Sequence;
+	response.Opcode = (uint8_t)frame.Opcode;
+	response.Result = (uint8_t)result;
+	response.SampleRateHz = configuration.sampleRateHz;
+	response.GyroRangeCode = (uint8_t)GyroRangeCode(configuration.gyroRange);
+	if (configuration.packetFormat == PacketFormat::Extended) response.GyroRangeCode |= ExtendedFormatFlag;
+	response.Signature = ResponseSignature;
+
+	return true;
+}
+
+void SimulatedRemote::Step(Vector3 angularVelocity, uint8_t buttons)
+{
+	Step(angularVelocity, { 0, 0, 1 }, buttons);
+}
+
+// Emits queued responses, then one sample. Angular velocity is in degrees per second and
+// acceleration in g; acceleration is only sent while the extended format is enabled.
+void SimulatedRemote::Step(Vector3 angularVelocity, Vector3 acceleration, uint8_t buttons)
+{
+	for (int i = 0; i < queuedResponseCount; i++)
+	{
+		const auto& queued = queuedResponses[i];
+
+		if (queued.format == PacketFormat::Standard)
+		{
+			transmit((const uint8_t*)&queued.response, sizeof(ControlResponse));
+			continue;
+		}
+
+		uint8_t padded[sizeof(ExtendedPacket)] = {};
+		std::copy((const uint8_t*)&queued.response, (const uint8_t*)&queued.response + sizeof(ControlResponse) - 1, padded);
+		padded[sizeof(padded) - 1] = queued.response.Signature;
+		transmit(padded, sizeof(padded));
+	}
+	queuedResponseCount = 0;
+
+	auto range = (float)configuration.gyroRange;
+	auto gyro = Vector3Int16{
+		ToRaw(angularVelocity.X, range),
+		ToRaw(angularVelocity.Y, range),
+		ToRaw(angularVelocity.Z, range)
+	};
+	ExtendedPacket packet{
+		gyro,
+		{
+			ToRaw(acceleration.X, AccelerometerRange),
+			ToRaw(acceleration.Y, AccelerometerRange),
+			ToRaw(acceleration.Z, AccelerometerRange)
+		},
+		(uint8_t)(buttons & PacketSchema::ButtonMask)
+	};
+	uint8_t frame[PacketSchema::MaxFrameSize];
+
+	if (configuration.packetFormat == PacketFormat::Standard)
+	{
+		PacketSchema::Decoder<PacketSchema::Standard>::Encode(packet, frame);
+		transmit(frame, PacketSchema::Standard.frameSize);
+		return;
+	}
+
+	PacketSchema::Decoder<PacketSchema::Extended>::Encode(packet, frame);
+	transmit(frame, PacketSchema::Extended.frameSize);
+}
+
+void SimulatedRemote::SetCommandLossRate(double lossRate)
+{
+	commandLossRate = lossRate;
+}
+
+RemoteControl::Configuration SimulatedRemote::Configuration() const
+{
+	return configuration;
+}
@@ -0,0 +1,47 @@
+#pragma once
+#include "Packet.h"
+#include "RemoteControl.h"
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <random>
+
+// Stand-in for the remote's firmware. Emits gyro packets scaled by its current configuration
+// and answers RemoteControl commands in-stream, the way the real remote does.
+class SimulatedRemote
+{
+public:
+	using TransmitFunction = std::function<void(const uint8_t* data, size_t length)>;
+
+	SimulatedRemote(TransmitFunction transmit, uint32_t seed);
+
+	static constexpr auto AccelerometerRange = 4.0f; // full scale in g
+
+	bool Receive(const uint8_t* data, size_t length);
+	void Step(Vector3 angularVelocity, uint8_t buttons);
+	void Step(Vector3 angularVelocity, Vector3 acceleration, uint8_t buttons);
+
+	void SetCommandLossRate(double lossRate);
+	RemoteControl::Configuration Configuration() const;
+private:
+	static constexpr auto MaxQueuedResponses = 8;
+
+	struct QueuedResponse
+	{
+		ControlResponse response;
+		PacketFormat format; // layout in effect when the command arrived
+	};
+
+	TransmitFunction transmit;
+	RemoteControl::Configuration configuration{
+		RemoteControl::DefaultSampleRateHz, RemoteControl::DefaultGyroRange, PacketFormat::Standard };
+
+	QueuedResponse queuedResponses[MaxQueuedResponses] = {};
+	int queuedResponseCount = 0;
+
+	double commandLossRate = 0;
+	std::mt19937 random;
+	std::uniform_real_distribution<double> chance{ 0.0, 1.0 };
+
+	static int16_t ToRaw(float value, float range);
+};
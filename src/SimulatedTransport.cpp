@@ -0,0 +1,134 @@
+#include "SimulatedTransport.h"
+#include "Logger.h"
+#include "Trace.h"
+#include <chrono>
+#include <cmath>
+
+SimulatedTransport::SimulatedTransport(uint32_t seed) :
+	remote([this](const uint8_t* data, size_t length) { pendingBytes.insert(pendingBytes.end(), data, data + length); }, seed)
+{
+	pendingBytes.reserve(BufferLength);
+}
+
+SimulatedTransport::~SimulatedTransport()
+{
+	Disconnect();
+}
+
+void SimulatedTransport::SetConnectionState(Metrics::ConnectionState state)
+{
+	connectionMetrics.state = state;
+	Metrics::Publish(Metrics::WriterPage()->connection, connectionMetrics);
+}
+
+// Angular velocity in degrees per second: slow figure eights, then a rest
+Vector3 SimulatedTransport::HandMotion(double seconds)
+{
+	constexpr auto Pi = 3.14159265358979;
+
+	auto phase = std::fmod(seconds, MotionSeconds + RestSeconds);
+	if (phase >= MotionSeconds) return { 0, 0, 0 };
+
+	auto envelope = std::sin(Pi * phase / MotionSeconds);
+	return {
+		(float)(40 * envelope * std::sin(2 * Pi * 0.5 * seconds)),
+		0,
+		(float)(60 * envelope * std::sin(2 * Pi * 0.25 * seconds))
+	};
+}
+
+void SimulatedTransport::Run()
+{
+	using Clock = std::chrono::steady_clock;
+
+	Trace::SetThreadName("Simulated remote");
+	if (Connected) Connected();
+
+	auto start = Clock::now();
+	auto wakeTime = start;
+	double sampleTime = 0;
+
+	while (!isStopping.load(std::memory_order_relaxed))
+	{
+		wakeTime += std::chrono::milliseconds(ConnectionIntervalMs);
+		std::this_thread::sleep_until(wakeTime);
+
+		auto elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+		size_t length;
+
+		{
+			std::lock_guard<std::mutex> lock(remoteMutex);
+
+			auto samplePeriod = 1.0 / remote.Configuration().sampleRateHz;
+			for (; sampleTime <= elapsed; sampleTime += samplePeriod)
+			{
+				remote.Step(HandMotion(sampleTime), 0);
+			}
+
+			// Only this thread touches the buffer, the parser reads it from ReceivedData below
+			length = pendingBytes.size();
+			buffer.WriteBuffer(pendingBytes.data(), (int)length);
+			pendingBytes.clear();
+		}
+
+		if (length == 0) continue;
+
+		Trace::Scope scope("Notification");
+		scope.Argument("bytes", (int64_t)length);
+
+		deviceMetrics.notifications++;
+		deviceMetrics.bytesReceived += length;
+		Metrics::Publish(Metrics::WriterPage()->device, deviceMetrics);
+
+		if (ReceivedData) ReceivedData();
+	}
+}
+
+void SimulatedTransport::AttemptConnection()
+{
+	std::lock_guard<std::mutex> lock(connectionMutex);
+	if (isConnected) return;
+
+	if (thread.joinable()) thread.join();
+
+	connectionMetrics.connectionAttempts++;
+	SetConnectionState(Metrics::ConnectionState::Connected);
+	Logger::Info("Simulated remote connected");
+
+	isStopping = false;
+	isConnected = true;
+	thread = std::thread(&SimulatedTransport::Run, this);
+}
+
+bool SimulatedTransport::IsConnected() const
+{
+	return isConnected;
+}
+
+std::string SimulatedTransport::DeviceId() const
+{
+	return "simulated";
+}
+
+void SimulatedTransport::Disconnect()
+{
+	{
+		std::lock_guard<std::mutex> lock(connectionMutex);
+		if (!isConnected) return;
+
+		isStopping = true;
+		if (thread.joinable()) thread.join();
+
+		isConnected = false;
+		SetConnectionState(Metrics::ConnectionState::Disconnected);
+		Logger::Info("Simulated remote disconnected");
+	}
+
+	if (Disconnected) Disconnected();
+}
+
+bool SimulatedTransport::Write(const uint8_t* data, size_t length)
+{
+	std::lock_guard<std::mutex> lock(remoteMutex);
+	return remote.Receive(data, length);
+}
@@ -0,0 +1,54 @@
+#pragma once
+#include "CircularBuffer.h"
+#include "Metrics.h"
+#include "SimulatedRemote.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Drop-in replacement for BluetoothLE::BLEDevice that connects to a SimulatedRemote instead of a
+// radio. The remote is stepped in real time at its configured sample rate and its packets are
+// delivered in batches, one batch per connection interval, on the transport's own thread.
+class SimulatedTransport
+{
+private:
+	SimulatedRemote remote;
+	std::mutex remoteMutex; // Write() arrives on other threads
+	std::vector<uint8_t> pendingBytes; // transmitted by the remote, not yet in the buffer
+
+	std::thread thread;
+	std::mutex connectionMutex;
+	std::atomic<bool> isConnected{ false };
+	std::atomic<bool> isStopping{ false };
+
+	Metrics::DeviceMetrics deviceMetrics{};
+	Metrics::ConnectionMetrics connectionMetrics{};
+
+	void Run();
+	void SetConnectionState(Metrics::ConnectionState state);
+	static Vector3 HandMotion(double seconds);
+public:
+	static constexpr auto ConnectionIntervalMs = 15;
+	static constexpr auto MotionSeconds = 4.0; // the simulated hand alternates between moving and resting
+	static constexpr auto RestSeconds = 4.0;
+
+	std::function<void()> Connected;
+	std::function<void()> Disconnected;
+	std::function<void()> ReceivedData;
+
+	CircularBuffer buffer;
+
+	explicit SimulatedTransport(uint32_t seed);
+	~SimulatedTransport();
+
+	void AttemptConnection();
+	bool IsConnected() const;
+	std::string DeviceId() const;
+	void Disconnect();
+	bool Write(const uint8_t* data, size_t length);
+};
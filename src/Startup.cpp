@@ -0,0 +1,44 @@
+#include "Startup.h"
+#include "Logger.h"
+#include "ProcessInfo.h"
+#include "Trace.h"
+#include <atomic>
+
+namespace Startup
+{
+	static std::atomic<uint64_t> reachedAt[(int)Milestone::Count] = {};
+
+	void Reached(Milestone milestone)
+	{
+		auto& slot = reachedAt[(int)milestone];
+		if (slot.load(std::memory_order_relaxed) != 0) return;
+
+		uint64_t expected = 0;
+		auto microseconds = ProcessInfo::MicrosecondsSinceStart();
+		if (microseconds == 0) microseconds = 1; // 0 means not reached
+		if (!slot.compare_exchange_strong(expected, microseconds, std::memory_order_relaxed)) return;
+
+		switch (milestone)
+		{
+		case Milestone::Tray:
+			Logger::Info("Time to tray: %lld us", microseconds);
+			Trace::Instant("Tray shown", "startup_us", (int64_t)microseconds);
+			break;
+		case Milestone::Scan:
+			Logger::Info("Time to scan: %lld us", microseconds);
+			Trace::Instant("Scan started", "startup_us", (int64_t)microseconds);
+			break;
+		case Milestone::FirstPacket:
+			Logger::Info("Time to first packet: %lld us", microseconds);
+			Trace::Instant("First packet", "startup_us", (int64_t)microseconds);
+			break;
+		default:
+			break;
+		}
+	}
+
+	uint64_t Microseconds(Milestone milestone)
+	{
+		return reachedAt[(int)milestone].load(std::memory_order_relaxed);
+	}
+}
@@ -0,0 +1,21 @@
+#pragma once
+#include <cstdint>
+
+// Startup milestones, in microseconds since the process started (see ProcessInfo). The tray build
+// reaches all three; the daemon has no tray. Each is logged and traced once when first reached.
+namespace Startup
+{
+	enum class Milestone
+	{
+		Tray, // the tray window is shown
+		Scan, // the transport is looking for the remote
+		FirstPacket, // the first packet reached Input
+		Count
+	};
+
+	// Any thread. Only the first call for each milestone counts, later ones cost an atomic load.
+	void Reached(Milestone milestone);
+
+	// 0 until reached
+	uint64_t Microseconds(Milestone milestone);
+}
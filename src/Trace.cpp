@@ -0,0 +1,269 @@
+#include "Trace.h"
+
+#if GESTURE_TRACING
+#include <algorithm>
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+#include <ctime>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace Trace
+{
+	static_assert((RingCapacity & (RingCapacity - 1)) == 0, "RingCapacity must be a power of two");
+
+	// Written only by its owning thread and overwritten in place. A reader copies the events, then
+	// discards any the owner may have started to overwrite meanwhile.
+	struct Ring
+	{
+		alignas(64) std::atomic<uint64_t> head{ 0 }; // events written so far
+		std::atomic<uint64_t> firstEvent{ 0 }; // head when the current thread took the ring
+		std::atomic<const char*> threadName{ nullptr };
+		int threadId = 0;
+		Event events[RingCapacity];
+	};
+
+	std::atomic<bool> IsEnabled{ false };
+
+	static std::mutex ringsMutex;
+	static std::vector<std::unique_ptr<Ring>> rings;
+	static std::vector<Ring*> freeRings; // reserved by Initialize, or left by threads that have exited
+
+	static void ReleaseRing(Ring* ring)
+	{
+		std::lock_guard<std::mutex> lock(ringsMutex);
+		freeRings.push_back(ring); // never grows past rings.size(), reserved in AddRing
+	}
+
+	// Hands the ring back when its thread exits, as Logger does, so that a new thread pool worker
+	// takes a free ring instead of allocating on its first event
+	struct LocalRing
+	{
+		Ring* ring = nullptr;
+		~LocalRing() { if (ring) ReleaseRing(ring); }
+	};
+	static thread_local LocalRing localRing;
+
+	static std::thread triggerThread;
+	static std::atomic<bool> isRunning{ false };
+	static std::atomic<bool> isDumpRequested{ false };
+	static std::mutex enableMutex;
+	static bool isRecording = false;
+	static std::atomic<int64_t> gapThresholdNs{ 0 };
+	static std::atomic<int64_t> lastArrivalNs{ 0 };
+	static std::atomic<int64_t> lastTriggerNs{ 0 };
+
+	// Call with ringsMutex held
+	static Ring* AddRing()
+	{
+		rings.push_back(std::make_unique<Ring>());
+		rings.back()->threadId = (int)rings.size();
+		freeRings.reserve(rings.size());
+		return rings.back().get();
+	}
+
+	// A reused ring hides the events of its previous thread, which would otherwise be dumped
+	// under the new thread's name
+	static Ring* AcquireRing()
+	{
+		std::lock_guard<std::mutex> lock(ringsMutex);
+		if (freeRings.empty()) return AddRing();
+
+		auto* ring = freeRings.back();
+		freeRings.pop_back();
+		ring->threadName.store(nullptr, std::memory_order_relaxed);
+		ring->firstEvent.store(ring->head.load(std::memory_order_relaxed), std::memory_order_relaxed);
+		return ring;
+	}
+
+	void Push(const Event& event)
+	{
+		auto*& ring = localRing.ring;
+		if (ring == nullptr) ring = AcquireRing(); // once per thread, off the steady-state path
+
+		auto head = ring->head.load(std::memory_order_relaxed);
+		// Orders the previous head store before the overwrite, as the odd store does in a seqlock
+		std::atomic_thread_fence(std::memory_order_release);
+		ring->events[head & (RingCapacity - 1)] = event;
+		ring->head.store(head + 1, std::memory_order_release);
+	}
+
+	void SetThreadName(const char* name)
+	{
+		auto*& ring = localRing.ring;
+		if (ring == nullptr) ring = AcquireRing();
+		ring->threadName.store(name, std::memory_order_relaxed);
+	}
+
+	static void CopyRing(const Ring& ring, ThreadEvents& copy)
+	{
+		auto head = ring.head.load(std::memory_order_acquire);
+		auto first = std::max(head > RingCapacity ? head - RingCapacity : 0, ring.firstEvent.load(std::memory_order_relaxed));
+
+		copy.events.resize((size_t)(head - first));
+		for (auto i = first; i < head; i++) copy.events[(size_t)(i - first)] = ring.events[i & (RingCapacity - 1)];
+
+		// While writing event n the owner's head is n, and event n replaces event n - RingCapacity
+		std::atomic_thread_fence(std::memory_order_acquire);
+		auto headAfter = ring.head.load(std::memory_order_relaxed);
+		if (headAfter + 1 > first + RingCapacity)
+		{
+			auto torn = std::min<uint64_t>(headAfter + 1 - RingCapacity - first, copy.events.size());
+			copy.events.erase(copy.events.begin(), copy.events.begin() + (ptrdiff_t)torn);
+		}
+	}
+
+	std::vector<ThreadEvents> Snapshot()
+	{
+		std::vector<Ring*> snapshot;
+		{
+			std::lock_guard<std::mutex> lock(ringsMutex);
+			for (auto& ring : rings) snapshot.push_back(ring.get());
+		}
+
+		std::vector<ThreadEvents> threads(snapshot.size());
+		for (size_t i = 0; i < snapshot.size(); i++)
+		{
+			threads[i].threadId = snapshot[i]->threadId;
+			threads[i].threadName = snapshot[i]->threadName.load(std::memory_order_relaxed);
+			CopyRing(*snapshot[i], threads[i]);
+		}
+
+		return threads;
+	}
+
+	static void WriteEvent(FILE* file, int threadId, const Event& event, bool& isFirst)
+	{
+		static const char* const PhaseCodes[] = { "X", "i" };
+
+		fprintf(file, "%s\n{\"name\":\"%s\",\"ph\":\"%s\",\"pid\":1,\"tid\":%d,\"ts\":%.3f",
+			isFirst ? "" : ",", event.name, PhaseCodes[(int)event.phase], threadId, event.timestampNs / 1000.0);
+		isFirst = false;
+
+		if (event.phase == Phase::Complete) fprintf(file, ",\"dur\":%.3f", event.durationNs / 1000.0);
+		if (event.phase == Phase::Instant) fprintf(file, ",\"s\":\"t\"");
+		if (event.argumentName) fprintf(file, ",\"args\":{\"%s\":%" PRId64 "}", event.argumentName, event.argument);
+		fprintf(file, "}");
+	}
+
+	bool Dump(const char* path)
+	{
+		auto threads = Snapshot();
+
+		FILE* file = nullptr;
+#ifdef _WIN32
+		if (fopen_s(&file, path, "w") != 0) file = nullptr;
+#else
+		file = fopen(path, "w");
+#endif
+		if (!file)
+		{
+			Logger::Error("Could not write trace file");
+			return false;
+		}
+
+		fprintf(file, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[");
+		auto isFirst = true;
+		size_t eventCount = 0;
+		for (auto& thread : threads)
+		{
+			if (thread.threadName)
+			{
+				fprintf(file, "%s\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"%s\"}}",
+					isFirst ? "" : ",", thread.threadId, thread.threadName);
+				isFirst = false;
+			}
+
+			for (auto& event : thread.events) WriteEvent(file, thread.threadId, event, isFirst);
+			eventCount += thread.events.size();
+		}
+		fprintf(file, "\n]}\n");
+
+		auto isWritten = ferror(file) == 0;
+		isWritten &= fclose(file) == 0;
+		if (isWritten) Logger::Info("Wrote %lld trace events from %lld threads", (long long)eventCount, (long long)threads.size());
+		return isWritten;
+	}
+
+	// Call with enableMutex held
+	static void UpdateEnabled()
+	{
+		IsEnabled.store(isRecording || gapThresholdNs.load(std::memory_order_relaxed) != 0, std::memory_order_relaxed);
+	}
+
+	void SetRecording(bool isOn)
+	{
+		std::lock_guard<std::mutex> lock(enableMutex);
+		isRecording = isOn;
+		UpdateEnabled();
+	}
+
+	bool IsRecording()
+	{
+		std::lock_guard<std::mutex> lock(enableMutex);
+		return isRecording;
+	}
+
+	void SetGapTrigger(int thresholdMs)
+	{
+		std::lock_guard<std::mutex> lock(enableMutex);
+		gapThresholdNs.store((int64_t)thresholdMs * 1000000, std::memory_order_relaxed);
+		UpdateEnabled();
+	}
+
+	void Arrival()
+	{
+		auto threshold = gapThresholdNs.load(std::memory_order_relaxed);
+		auto now = Logger::TimestampNs();
+		auto previous = lastArrivalNs.exchange(now, std::memory_order_relaxed);
+		if (threshold == 0 || previous == 0 || now - previous <= threshold) return;
+
+		Instant("Gap", "ms", (now - previous) / 1000000);
+
+		auto lastTrigger = lastTriggerNs.load(std::memory_order_relaxed);
+		if (lastTrigger != 0 && now - lastTrigger < (int64_t)MinTriggerIntervalMs * 1000000) return;
+
+		lastTriggerNs.store(now, std::memory_order_relaxed);
+		isDumpRequested.store(true, std::memory_order_release);
+	}
+
+	void ResetArrivals()
+	{
+		lastArrivalNs.store(0, std::memory_order_relaxed);
+	}
+
+	static void TriggerLoop()
+	{
+		while (isRunning.load(std::memory_order_acquire))
+		{
+			std::this_thread::sleep_for(std::chrono::milliseconds(TriggerPollMs));
+			if (!isDumpRequested.exchange(false, std::memory_order_acquire)) continue;
+
+			// Named by wall clock time so that dumps from earlier runs are kept
+			auto path = "GestureTrace-" + std::to_string((long long)std::time(nullptr)) + ".json";
+			if (Dump(path.c_str())) Logger::Info("Data gap triggered a trace dump");
+		}
+	}
+
+	void Initialize()
+	{
+		if (isRunning.exchange(true)) return;
+
+		{
+			std::lock_guard<std::mutex> lock(ringsMutex);
+			while ((int)freeRings.size() < ReservedRings) freeRings.push_back(AddRing());
+		}
+
+		triggerThread = std::thread(TriggerLoop);
+	}
+
+	void Shutdown()
+	{
+		if (!isRunning.exchange(false)) return;
+		triggerThread.join();
+	}
+}
+#endif
@@ -0,0 +1,125 @@
+#pragma once
+#include "Logger.h"
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+#ifndef GESTURE_TRACING
+#define GESTURE_TRACING 1 // define as 0 to compile every trace point out
+#endif
+
+// Flight recorder for the data path. Each thread appends fixed-size events to a ring of its own
+// without locking or waiting, and the rings keep the most recent RingCapacity events. Dump writes
+// them as Chrome trace JSON, which chrome://tracing and ui.perfetto.dev both open. Timestamps use
+// the Logger clock, so a trace lines up with the log. Trace points are off, costing one relaxed
+// load, until recording is started or a gap trigger is set.
+namespace Trace
+{
+	static constexpr auto RingCapacity = 8192; // events per thread, must be a power of two
+	static constexpr auto ReservedRings = 4; // created up front for threads that start tracing later
+	static constexpr auto TriggerPollMs = 100; // a triggered dump also captures what followed the trigger
+	static constexpr auto MinTriggerIntervalMs = 10000;
+	static constexpr auto DefaultPath = "GestureTrace.json";
+
+	enum class Phase : uint8_t
+	{
+		Complete, // a scope, from timestampNs for durationNs
+		Instant
+	};
+
+	struct Event
+	{
+		const char* name; // must outlive the trace and need no JSON escaping (use literals)
+		const char* argumentName; // nullptr without an argument
+		int64_t timestampNs;
+		int64_t durationNs;
+		int64_t argument;
+		Phase phase;
+	};
+
+	struct ThreadEvents
+	{
+		int threadId;
+		const char* threadName; // nullptr when never named
+		std::vector<Event> events; // oldest first
+	};
+
+#if GESTURE_TRACING
+	extern std::atomic<bool> IsEnabled; // while recording or a gap trigger is set
+
+	// Starts the thread that writes triggered dumps
+	void Initialize();
+	void Shutdown();
+
+	void Push(const Event& event);
+	void SetThreadName(const char* name);
+
+	void SetRecording(bool isRecording);
+	bool IsRecording();
+
+	// Consistent copy of every ring, safe while other threads keep tracing
+	std::vector<ThreadEvents> Snapshot();
+	bool Dump(const char* path);
+
+	// Dumps when data arrives more than thresholdMs after the previous arrival (0 disables), and
+	// traces meanwhile. At most one dump per MinTriggerIntervalMs, written by the trigger thread.
+	void SetGapTrigger(int thresholdMs);
+	void Arrival();
+	void ResetArrivals(); // on connect and disconnect, so reconnecting is not a gap
+
+	inline void Instant(const char* name, const char* argumentName = nullptr, int64_t argument = 0)
+	{
+		if (!IsEnabled.load(std::memory_order_relaxed)) return;
+		Push({ name, argumentName, Logger::TimestampNs(), 0, argument, Phase::Instant });
+	}
+
+	// Records one complete event covering its own lifetime
+	class Scope
+	{
+	public:
+		explicit Scope(const char* name) :
+			name(name),
+			startNs(IsEnabled.load(std::memory_order_relaxed) ? Logger::TimestampNs() : 0)
+		{
+		}
+
+		~Scope()
+		{
+			if (startNs != 0) Push({ name, argumentName, startNs, Logger::TimestampNs() - startNs, argument, Phase::Complete });
+		}
+
+		Scope(const Scope&) = delete;
+		Scope& operator=(const Scope&) = delete;
+
+		void Argument(const char* argumentName, int64_t value)
+		{
+			this->argumentName = argumentName;
+			argument = value;
+		}
+	private:
+		const char* name;
+		const char* argumentName = nullptr;
+		int64_t argument = 0;
+		int64_t startNs;
+	};
+#else
+	inline void Initialize() {}
+	inline void Shutdown() {}
+	inline void SetThreadName(const char*) {}
+	inline void SetRecording(bool) {}
+	inline bool IsRecording() { return false; }
+	inline std::vector<ThreadEvents> Snapshot() { return {}; }
+	inline bool Dump(const char*) { return false; }
+	inline void SetGapTrigger(int) {}
+	inline void Arrival() {}
+	inline void ResetArrivals() {}
+	inline void Instant(const char*, const char* = nullptr, int64_t = 0) {}
+
+	class Scope
+	{
+	public:
+		explicit Scope(const char*) {}
+		void Argument(const char*, int64_t) {}
+	};
+#endif
+}
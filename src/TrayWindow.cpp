@@ -22,10 +22,41 @@ void TrayWindow::SetConnectionButtonHandler(std::function<void(bool)> handler)
 	connectionButtonPressed = handler;
 }
 
+void TrayWindow::SetAbsolutePointingHandler(std::function<void(bool)> handler)
+{
+	absolutePointingToggled = handler;
+}
+
+void TrayWindow::SetMotionPredictionHandler(std::function<void(bool)> handler)
+{
+	motionPredictionToggled = handler;
+}
+
+void TrayWindow::SetRecordTraceHandler(std::function<void(bool)> handler)
+{
+	recordTraceToggled = handler;
+}
+
+void TrayWindow::SetSaveTraceHandler(std::function<bool()> handler)
+{
+	saveTracePressed = handler;
+}
+
+void TrayWindow::SetPlotFeed(const PlotFeed& feed)
+{
+	plotFeed = &feed;
+	showPlotsCheckBox.setEnabled(true);
+}
+
 TrayWindow::TrayWindow() :
 	statusLabel("Not connected"),
 	connectButton("Connect"),
 	autoReconnectCheckBox("Connect automatically"),
+	absolutePointingCheckBox("Air mouse (needs accelerometer)"),
+	motionPredictionCheckBox("Predict motion to hide latency"),
+	recordTraceCheckBox("Record a trace of the data path"),
+	saveTraceButton("Save trace"),
+	showPlotsCheckBox("Show live plots"),
 	mainLayout(this)
 {
 	//window.setWindowFlag(Qt::FramelessWindowHint, true);
@@ -35,4 +66,36 @@ TrayWindow::TrayWindow() :
 	mainLayout.addWidget(&statusLabel);
 	mainLayout.addWidget(&connectButton);
 	mainLayout.addWidget(&autoReconnectCheckBox);
+	mainLayout.addWidget(&absolutePointingCheckBox);
+	mainLayout.addWidget(&motionPredictionCheckBox);
+	mainLayout.addWidget(&recordTraceCheckBox);
+	mainLayout.addWidget(&saveTraceButton);
+	mainLayout.addWidget(&showPlotsCheckBox);
+	saveTraceButton.setEnabled(false);
+	showPlotsCheckBox.setEnabled(false);
+
+	connect(&absolutePointingCheckBox, &QCheckBox::toggled, [this](bool isChecked) {
+		if (absolutePointingToggled) absolutePointingToggled(isChecked);
+	});
+	connect(&motionPredictionCheckBox, &QCheckBox::toggled, [this](bool isChecked) {
+		if (motionPredictionToggled) motionPredictionToggled(isChecked);
+	});
+	connect(&recordTraceCheckBox, &QCheckBox::toggled, [this](bool isChecked) {
+		if (recordTraceToggled) recordTraceToggled(isChecked);
+		saveTraceButton.setEnabled(isChecked);
+		saveTraceButton.setText("Save trace");
+	});
+	connect(&saveTraceButton, &QPushButton::clicked, [this]() {
+		if (!saveTracePressed) return;
+		saveTraceButton.setText(saveTracePressed() ? "Trace saved" : "Could not save trace");
+	});
+	connect(&showPlotsCheckBox, &QCheckBox::toggled, [this](bool isChecked) {
+		if (isChecked && !plotView && plotFeed)
+		{
+			plotView = std::make_unique<PlotView>(*plotFeed); // built on first use, startup does not wait for it
+			mainLayout.addWidget(plotView.get());
+		}
+		if (plotView) plotView->setVisible(isChecked);
+		adjustSize();
+	});
 }
\ No newline at end of file
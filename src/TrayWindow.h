@@ -1,5 +1,6 @@
 #pragma once
 
+#include "PlotView.h"
 #include <QSystemTrayIcon>
 #include <QDialog>
 #include <QLabel>
@@ -7,6 +8,7 @@
 #include <QCheckBox>
 #include <QPushButton>
 #include <QVBoxLayout>
+#include <memory>
 
 class TrayWindow : public QDialog
 {
@@ -15,11 +17,27 @@ public:
 	void UpdateConnectionStatus(bool isConnected);
 	bool ShouldConnectAutomatically();
 	void SetConnectionButtonHandler(std::function<void(bool)> handler);
+	void SetAbsolutePointingHandler(std::function<void(bool)> handler);
+	void SetMotionPredictionHandler(std::function<void(bool)> handler);
+	void SetRecordTraceHandler(std::function<void(bool)> handler);
+	void SetSaveTraceHandler(std::function<bool()> handler);
+	void SetPlotFeed(const PlotFeed& feed); // enables live plots, built when first shown
 private:
 	QVBoxLayout mainLayout;
 	QLabel statusLabel;
 	QPushButton connectButton;
 	QCheckBox autoReconnectCheckBox;
+	QCheckBox absolutePointingCheckBox;
+	QCheckBox motionPredictionCheckBox;
+	QCheckBox recordTraceCheckBox;
+	QPushButton saveTraceButton;
+	QCheckBox showPlotsCheckBox;
+	const PlotFeed* plotFeed = nullptr;
+	std::unique_ptr<PlotView> plotView;
 	QSystemTrayIcon trayIcon;
 	std::function<void(bool)> connectionButtonPressed;
+	std::function<void(bool)> absolutePointingToggled;
+	std::function<void(bool)> motionPredictionToggled;
+	std::function<void(bool)> recordTraceToggled;
+	std::function<bool()> saveTracePressed;
 };
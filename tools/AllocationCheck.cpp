@@ -0,0 +1,296 @@
+// Enforces that the steady-state packet path never touches the heap. Replaces the global operator
+// new and delete, replays a long synthetic session from notification ingest through PacketParser,
+// the broadcast ring and Input, and fails if anything on the replaying thread allocates once the
+// session has run through once as warm-up.
+//
+// The session covers what a user does: pointing at every usage mode (so the remote is reconfigured
+// in-stream), clicks, middle button scrolling and dragging, air mouse pointing, prediction, idle
+// periods, forwarding over UDP to the loopback address, and a link that drops and corrupts bytes
+// so that the parser loses and regains alignment. Idle detection runs on the sample clock, so the
+// idle segment goes idle after IdleTimeoutMs of still packets without waiting. Each segment is
+// delivered by a new thread, as WinRT hands notifications to whichever thread pool worker is
+// free, so per-thread state must come from a pool rather than being allocated by a worker's
+// first packet.
+//
+// Linux: g++ -std=c++17 -O2 -I../src AllocationCheck.cpp ../src/SimulatedRemote.cpp ../src/RemoteControl.cpp
+//            ../src/PacketParser.cpp ../src/CircularBuffer.cpp ../src/Input.cpp ../src/PointerOutput.cpp
+//            ../src/IdleDetector.cpp ../src/OrientationFilter.cpp ../src/MotionPredictor.cpp ../src/GyroHistory.cpp
+//            ../src/Logger.cpp ../src/Metrics.cpp ../src/NetworkOutput.cpp ../src/PacketBroadcast.cpp ../src/Trace.cpp
+//            ../src/PlotFeed.cpp ../src/ResponseCurve.cpp ../src/ButtonMapper.cpp ../src/ClickStabilizer.cpp
+//            ../src/LinkSimulator.cpp ../src/Startup.cpp ../src/ProcessInfo.cpp -o AllocationCheck -lrt -pthread
+//
+// Usage: AllocationCheck [--passes n] [--abort]   (--abort stops at the first allocation, for a debugger)
+
+#include "CircularBuffer.h"
+#include "Input.h"
+#include "LinkSimulator.h"
+#include "Logger.h"
+#include "Metrics.h"
+#include "PacketParser.h"
+#include "Pipeline.h"
+#include "PointerOutput.h"
+#include "RemoteControl.h"
+#include "SimulatedRemote.h"
+#include "Trace.h"
+#include <atomic>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <new>
+#include <thread>
+#include <vector>
+
+static constexpr uint32_t Seed = 3;
+static constexpr auto ConnectionIntervalMs = 15.0;
+static constexpr uint16_t ForwardPort = 47899; // nothing needs to listen
+static constexpr auto ForwardSecret = "check";
+static constexpr auto Pi = 3.14159265358979;
+
+// Lost bytes and bursts force realignment. Bit flips are left out: a flipped button bit would keep
+// the idle segment from ever going idle.
+static const ImpairmentProfile Link = { "lossy", 0.0005, 0, 0, 0.0002, 40, 0, 0 };
+
+// Allocation accounting, for the replaying threads only
+static thread_local bool isCounting = false;
+static bool isCountingReplay = false; // copied by each delivering thread
+static std::atomic<uint64_t> allocationCount{ 0 };
+static std::atomic<uint64_t> allocatedBytes{ 0 };
+static std::atomic<size_t> firstAllocationSize{ 0 };
+static bool isAbortingOnAllocation = false;
+static int* volatile probe; // keeps the compiler from eliding the hook's self test
+
+static void* Allocate(size_t size, size_t alignment)
+{
+	if (isCounting)
+	{
+		if (allocationCount.fetch_add(1) == 0) firstAllocationSize = size;
+		allocatedBytes += size;
+		if (isAbortingOnAllocation) std::abort();
+	}
+
+	if (size == 0) size = 1;
+	void* memory = alignment > alignof(std::max_align_t)
+		? std::aligned_alloc(alignment, (size + alignment - 1) / alignment * alignment)
+		: std::malloc(size);
+	return memory;
+}
+
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete" // the replaced operators do pair malloc with free
+#endif
+
+void* operator new(size_t size)
+{
+	if (auto memory = Allocate(size, 0)) return memory;
+	throw std::bad_alloc();
+}
+
+void* operator new[](size_t size)
+{
+	if (auto memory = Allocate(size, 0)) return memory;
+	throw std::bad_alloc();
+}
+
+void* operator new(size_t size, std::align_val_t alignment)
+{
+	if (auto memory = Allocate(size, (size_t)alignment)) return memory;
+	throw std::bad_alloc();
+}
+
+void* operator new[](size_t size, std::align_val_t alignment)
+{
+	if (auto memory = Allocate(size, (size_t)alignment)) return memory;
+	throw std::bad_alloc();
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept { return Allocate(size, 0); }
+void* operator new[](size_t size, const std::nothrow_t&) noexcept { return Allocate(size, 0); }
+void operator delete(void* memory) noexcept { std::free(memory); }
+void operator delete[](void* memory) noexcept { std::free(memory); }
+void operator delete(void* memory, size_t) noexcept { std::free(memory); }
+void operator delete[](void* memory, size_t) noexcept { std::free(memory); }
+void operator delete(void* memory, std::align_val_t) noexcept { std::free(memory); }
+void operator delete[](void* memory, std::align_val_t) noexcept { std::free(memory); }
+void operator delete(void* memory, size_t, std::align_val_t) noexcept { std::free(memory); }
+void operator delete[](void* memory, size_t, std::align_val_t) noexcept { std::free(memory); }
+
+// What Pipeline::Connect needs from a transport, driven synchronously
+struct ReplayTransport
+{
+	std::function<void()> Connected;
+	std::function<void()> Disconnected;
+	std::function<void()> ReceivedData;
+
+	CircularBuffer buffer;
+	SimulatedRemote* remote = nullptr;
+
+	bool Write(const uint8_t* data, size_t length)
+	{
+		return remote->Receive(data, length);
+	}
+};
+
+struct Segment
+{
+	const char* name;
+	double seconds;
+	std::function<Vector3(double t)> rates; // degrees per second
+	uint8_t buttons;
+	std::function<void()> onStart;
+};
+
+class Replay
+{
+public:
+	Replay() :
+		remote([this](const uint8_t* data, size_t length) { link.Transmit(data, length); }, Seed),
+		remoteControl([this](const uint8_t* data, size_t length) { return transport.Write(data, length); }),
+		link(transport.buffer, Link, Seed)
+	{
+		transport.remote = &remote;
+		Pipeline::Connect(transport, remoteControl);
+		transport.Connected();
+	}
+
+	void Run(const std::vector<Segment>& segments)
+	{
+		for (auto& segment : segments)
+		{
+			if (segment.onStart) segment.onStart();
+
+			// Creating the thread allocates, but on this thread, which does not count
+			std::thread([this, &segment] {
+				isCounting = isCountingReplay;
+				Deliver(segment);
+				isCounting = false;
+			}).join();
+		}
+	}
+
+	uint64_t PacketCount() const { return packetCount; }
+private:
+	SimulatedRemote remote;
+	RemoteControl::Controller remoteControl;
+	ReplayTransport transport;
+	LinkSimulator link;
+	double sampleDebt = 0; // samples owed to the current connection interval
+	uint64_t packetCount = 0; // sent by the remote
+
+	void Deliver(const Segment& segment)
+	{
+		for (double t = 0; t < segment.seconds; t += ConnectionIntervalMs / 1000) ConnectionEvent(segment, t);
+	}
+
+	// One connection interval's worth of samples, then one notification
+	void ConnectionEvent(const Segment& segment, double t)
+	{
+		auto sampleRate = remote.Configuration().sampleRateHz;
+		for (sampleDebt += ConnectionIntervalMs * sampleRate / 1000; sampleDebt >= 1; sampleDebt--)
+		{
+			remote.Step(segment.rates(t), segment.buttons);
+			packetCount++;
+		}
+
+		transport.ReceivedData();
+		remoteControl.CheckTimeouts();
+	}
+};
+
+static std::vector<Segment> Session()
+{
+	auto still = [](double) { return Vector3{ 0.1f, -0.1f, 0.05f }; };
+	auto figureEight = [](double t) {
+		return Vector3{ (float)(40 * std::sin(2 * Pi * 0.5 * t)), 0, (float)(60 * std::sin(2 * Pi * 0.25 * t)) };
+	};
+	auto swing = [](double t) { return Vector3{ 0, 0, (float)(900 * std::sin(2 * Pi * 1.5 * t)) }; }; // saturates, widens the range
+	auto gentle = [](double t) { return Vector3{ (float)(15 * std::sin(2 * Pi * 0.3 * t)), 0, (float)(20 * std::cos(2 * Pi * 0.3 * t)) }; };
+	auto roll = [](double t) { return Vector3{ 0, (float)(120 * std::sin(2 * Pi * 0.5 * t)), 0 }; };
+
+	using Input::LeftMask;
+	using Input::MiddleMask;
+	using Input::RightMask;
+
+	return {
+		{ "settle", 0.5, still, 0, nullptr },
+		{ "point", 4, figureEight, 0, nullptr },
+		{ "left drag", 1, figureEight, LeftMask, nullptr },
+		{ "right click", 0.2, still, RightMask, nullptr },
+		{ "release", 0.2, still, 0, nullptr },
+		{ "middle scroll", 1.5, roll, MiddleMask, nullptr },
+		{ "middle drag", 1.5, figureEight, MiddleMask, nullptr },
+		{ "fast swing", 3, swing, 0, nullptr },
+		{ "slow pointing", 8, gentle, 0, nullptr }, // narrows the range again
+		{ "predicted", 3, figureEight, 0, [] { Input::SetPredictionLatency(Input::PredictionLatencyMs); } },
+		{ "air mouse", 3, figureEight, 0, [] {
+			Input::SetPredictionLatency(Input::DefaultPredictionLatencyMs);
+			Input::SetPointingMode(Input::PointingMode::Absolute);
+		} },
+		{ "air mouse click", 0.3, still, LeftMask, nullptr },
+		{ "relative", 1, figureEight, 0, [] { Input::SetPointingMode(Input::PointingMode::Relative); } },
+		{ "forwarded", 3, figureEight, LeftMask, [] { PointerOutput::SetForwardTarget("127.0.0.1", ForwardPort, ForwardSecret); } },
+		{ "local", 1, figureEight, 0, [] { PointerOutput::SetForwardTarget("", 0, ""); } },
+		{ "idle", Input::IdleTimeoutMs / 1000.0 + 0.3, still, 0, nullptr },
+		{ "wake", 1, figureEight, 0, nullptr },
+	};
+}
+
+int main(int argc, char* argv[])
+{
+	auto passes = 3;
+	for (int i = 1; i < argc; i++)
+	{
+		if (std::strcmp(argv[i], "--passes") == 0 && i + 1 < argc) passes = std::max(1, std::atoi(argv[++i]));
+		else if (std::strcmp(argv[i], "--abort") == 0) isAbortingOnAllocation = true;
+	}
+
+	Logger::MinimumLevel = Logger::Level::Error; // realignment warnings are expected on this link
+	Logger::Initialize(nullptr); // reserves the rings that delivering threads take
+	Trace::Initialize();
+	Trace::SetRecording(true); // off by default, but trace points must not allocate either
+	Input::Initialize();
+
+	auto segments = Session();
+	Replay replay;
+
+	// Warm-up: per-thread rings, the metrics page, the UDP socket and anything else created once
+	replay.Run(segments);
+	auto warmPackets = replay.PacketCount();
+
+	// The hook itself must see an allocation
+	isCounting = true;
+	probe = new int(0);
+	delete probe;
+	isCounting = false;
+	if (allocationCount.exchange(0) != 1 || allocatedBytes.exchange(0) != sizeof(int))
+	{
+		printf("FAIL: the operator new hook is not in use\n");
+		return 1;
+	}
+
+	isCountingReplay = true;
+	for (int pass = 0; pass < passes; pass++) replay.Run(segments);
+	isCountingReplay = false;
+
+	// Shows which paths the passes went through
+	Metrics::ParserMetrics parser{};
+	Metrics::InputMetrics input{};
+	Metrics::Read(Metrics::WriterPage()->parser, parser);
+	Metrics::Read(Metrics::WriterPage()->input, input);
+	printf("parsed %llu packets, %llu realignments, %llu control responses; %llu moves, %llu clicks, %llu scrolls, %llu idle\n",
+		(unsigned long long)parser.packets, (unsigned long long)parser.realignments, (unsigned long long)parser.controlResponses,
+		(unsigned long long)input.moves, (unsigned long long)input.clicks, (unsigned long long)input.scrolls,
+		(unsigned long long)input.idlePackets);
+
+	auto packets = replay.PacketCount() - warmPackets;
+	printf("%d passes, %llu packets after warm-up: %llu allocations, %llu bytes\n", passes,
+		(unsigned long long)packets, (unsigned long long)allocationCount.load(), (unsigned long long)allocatedBytes.load());
+	auto isAllocationFree = allocationCount == 0;
+	if (isAllocationFree) printf("ok\n");
+	else printf("FAIL: the first allocation was %zu bytes, rerun with --abort under a debugger to see where\n", firstAllocationSize.load());
+
+	Trace::Shutdown();
+	Logger::Shutdown();
+	return isAllocationFree ? 0 : 1;
+}
@@ -0,0 +1,222 @@
+// Checks that relative pointing is independent of the remote's sample rate. Replays the same hand
+// motion through SimulatedRemote, PacketParser and Input at several sample rates and connection
+// intervals, including links slow enough that the parser drops part of every notification as
+// backlog, and compares the cursor trajectories against the default rate at common checkpoints.
+// The motion includes slow, precise pointing of well under a pixel per sample, which only adds
+// up to the same distance when fractions of a pixel carry from one sample to the next.
+//
+// Linux: g++ -std=c++17 -O2 -I../src BallisticsCheck.cpp ../src/SimulatedRemote.cpp ../src/RemoteControl.cpp
+//            ../src/PacketParser.cpp ../src/CircularBuffer.cpp ../src/Input.cpp ../src/PointerOutput.cpp
+//            ../src/IdleDetector.cpp ../src/OrientationFilter.cpp ../src/MotionPredictor.cpp ../src/GyroHistory.cpp
+//            ../src/Logger.cpp ../src/Metrics.cpp ../src/NetworkOutput.cpp ../src/PacketBroadcast.cpp ../src/Trace.cpp
+//            ../src/PlotFeed.cpp ../src/ResponseCurve.cpp ../src/ButtonMapper.cpp ../src/ClickStabilizer.cpp
+//            ../src/Startup.cpp ../src/ProcessInfo.cpp -o BallisticsCheck -lrt -pthread
+
+#include "CircularBuffer.h"
+#include "Input.h"
+#include "Logger.h"
+#include "Metrics.h"
+#include "PacketParser.h"
+#include "Pipeline.h"
+#include "PointerOutput.h"
+#include "RemoteControl.h"
+#include "SimulatedRemote.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <functional>
+#include <vector>
+
+static constexpr auto Pi = 3.14159265358979;
+static constexpr auto SettleSeconds = 0.5; // still, while the sample rate is negotiated
+static constexpr auto MotionSeconds = 12.0;
+static constexpr auto CheckpointMs = 180; // a multiple of every connection interval and sample period below
+
+struct Scenario
+{
+	const char* name;
+	uint16_t sampleRateHz;
+	int connectionIntervalMs;
+	float maxDeviationPixels; // the cursor is read back in whole pixels
+};
+
+// More than PacketParser::MaxBacklogMs per notification is dropped, and the next sample kept then
+// stands for the dropped ones too, which only approximates their motion
+static const Scenario Scenarios[] = {
+	{ "100 Hz, 15 ms", 100, 15, 0 }, // the reference
+	{ "50 Hz, 15 ms", 50, 15, 2 },
+	{ "200 Hz, 15 ms", 200, 15, 2 },
+	{ "400 Hz, 15 ms", 400, 15, 2 },
+	{ "100 Hz, 45 ms", 100, 45, 8 }, // a third dropped
+	{ "200 Hz, 45 ms", 200, 45, 8 },
+	{ "100 Hz, 90 ms", 100, 90, 25 }, // two thirds dropped
+};
+
+// Sweeps and returns, then slow pointing that moves a fraction of a pixel per sample
+static Vector3 HandRates(double t)
+{
+	if (t < 8)
+	{
+		return { (float)(10 * std::sin(2 * Pi * 0.75 * t) + 4 * std::sin(2 * Pi * 1.5 * t)), 0,
+			(float)(15 * std::sin(2 * Pi * 0.5 * t) + 6 * std::sin(2 * Pi * 1.25 * t)) };
+	}
+	return { (float)(2.5 * std::sin(2 * Pi * 0.5 * t)), 0, (float)(3 + std::sin(2 * Pi * 0.25 * t)) };
+}
+
+// What a gyro reports for one sample: the mean rate over its sampling period
+static Vector3 AverageRates(double start, double end)
+{
+	constexpr auto Steps = 32;
+	Vector3 sum{ 0, 0, 0 };
+	for (int i = 0; i < Steps; i++)
+	{
+		auto t = start + (end - start) * (i + 0.5) / Steps;
+		auto rates = t > 0 ? HandRates(t) : Vector3{ 0, 0, 0 };
+		sum = { sum.X + rates.X / Steps, sum.Y + rates.Y / Steps, sum.Z + rates.Z / Steps };
+	}
+	return sum;
+}
+
+// What Pipeline::Connect needs from a transport, driven synchronously
+struct CheckTransport
+{
+	std::function<void()> Connected;
+	std::function<void()> Disconnected;
+	std::function<void()> ReceivedData;
+
+	CircularBuffer buffer;
+	SimulatedRemote* remote = nullptr;
+
+	bool Write(const uint8_t* data, size_t length)
+	{
+		return remote->Receive(data, length);
+	}
+};
+
+struct Point
+{
+	float x;
+	float y;
+};
+
+struct Trajectory
+{
+	std::vector<Point> checkpoints; // cursor relative to where the motion started
+	uint16_t sampleRateHz = 0; // the remote's at the end
+	uint64_t samples = 0;
+	uint64_t droppedBytes = 0;
+	double pathPixels = 0;
+};
+
+static Trajectory Run(const Scenario& scenario)
+{
+	CheckTransport transport;
+	SimulatedRemote remote([&transport](const uint8_t* data, size_t length) {
+		for (size_t i = 0; i < length; i++) transport.buffer.WriteBuffer(data[i]);
+	}, 1);
+	RemoteControl::Controller remoteControl([&transport](const uint8_t* data, size_t length) { return transport.Write(data, length); });
+	transport.remote = &remote;
+
+	// Input picks the cursor up again while the remote holds still
+	PointerOutput::Move(PointerOutput::ScreenWidth() / 2.0f, PointerOutput::ScreenHeight() / 2.0f);
+
+	Pipeline::Connect(transport, remoteControl);
+	Input::UsageModeRequested = nullptr; // usage modes would change the rate under test
+	PacketParser::ResetDataAlignment();
+	transport.Connected();
+
+	Metrics::ParserMetrics before{};
+	Metrics::Read(Metrics::WriterPage()->parser, before);
+
+	Trajectory trajectory;
+	auto isRateRequested = false;
+	uint64_t sampleCount = 0; // sent at the current rate
+	int rateChangeMs = 0;
+	float startX = 0, startY = 0, previousX = 0, previousY = 0;
+	auto isMoving = false;
+
+	for (int eventMs = scenario.connectionIntervalMs;; eventMs += scenario.connectionIntervalMs)
+	{
+		auto t = eventMs / 1000.0 - SettleSeconds; // motion time
+		if (t > MotionSeconds) break;
+
+		// A notification carries every sample taken since the last one
+		auto rate = remote.Configuration().sampleRateHz;
+		for (; (sampleCount + 1) * 1000 <= (uint64_t)(eventMs - rateChangeMs) * rate; sampleCount++)
+		{
+			auto sampleEnd = (rateChangeMs + (sampleCount + 1) * 1000.0 / rate) / 1000 - SettleSeconds;
+			remote.Step(AverageRates(sampleEnd - 1.0 / rate, sampleEnd), 0);
+			if (sampleEnd > 0) trajectory.samples++;
+		}
+		transport.ReceivedData();
+		remoteControl.CheckTimeouts();
+
+		// Commands sent before the parser has aligned are acknowledged in bytes it skips
+		if (!isRateRequested && PacketParser::IsDataAligned())
+		{
+			remoteControl.SetSampleRate(scenario.sampleRateHz);
+			isRateRequested = true;
+		}
+		if (remote.Configuration().sampleRateHz != rate)
+		{
+			rateChangeMs = eventMs;
+			sampleCount = 0;
+		}
+
+		float x, y;
+		PointerOutput::CursorPosition(x, y);
+		if (!isMoving && t >= 0)
+		{
+			isMoving = true;
+			startX = previousX = x;
+			startY = previousY = y;
+		}
+		if (!isMoving) continue;
+
+		trajectory.pathPixels += std::hypot(x - previousX, y - previousY);
+		previousX = x;
+		previousY = y;
+		if (eventMs % CheckpointMs == 0) trajectory.checkpoints.push_back({ x - startX, y - startY });
+	}
+
+	Metrics::ParserMetrics after{};
+	Metrics::Read(Metrics::WriterPage()->parser, after);
+	trajectory.droppedBytes = after.backlogDroppedBytes - before.backlogDroppedBytes;
+	trajectory.sampleRateHz = remote.Configuration().sampleRateHz;
+
+	transport.Disconnected();
+	PacketParser::SetBuffer(nullptr);
+	return trajectory;
+}
+
+int main()
+{
+	Logger::MinimumLevel = Logger::Level::Error;
+	Input::Initialize();
+
+	printf("%-16s %8s %14s %10s %12s %14s %6s\n", "scenario", "samples", "dropped bytes", "path px", "final px", "max deviation", "match");
+
+	auto isInvariant = true;
+	std::vector<Point> reference;
+	for (auto& scenario : Scenarios)
+	{
+		auto trajectory = Run(scenario);
+		if (reference.empty()) reference = trajectory.checkpoints;
+
+		auto deviation = 0.0f;
+		for (size_t i = 0; i < std::min(reference.size(), trajectory.checkpoints.size()); i++)
+		{
+			deviation = std::max(deviation, std::hypot(trajectory.checkpoints[i].x - reference[i].x, trajectory.checkpoints[i].y - reference[i].y));
+		}
+		auto isMatch = deviation <= scenario.maxDeviationPixels && trajectory.checkpoints.size() == reference.size()
+			&& trajectory.sampleRateHz == scenario.sampleRateHz;
+		isInvariant &= isMatch;
+
+		auto& last = trajectory.checkpoints.back();
+		printf("%-16s %8llu %14llu %10.0f %5.0f, %5.0f %14.2f %6s\n", scenario.name, (unsigned long long)trajectory.samples,
+			(unsigned long long)trajectory.droppedBytes, trajectory.pathPixels, last.x, last.y, deviation, isMatch ? "yes" : "NO");
+	}
+
+	printf("\ntrajectories independent of the sample rate: %s\n", isInvariant ? "yes" : "NO");
+	return isInvariant ? 0 : 1;
+}
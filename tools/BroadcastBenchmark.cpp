@@ -0,0 +1,170 @@
+// Measures PacketBroadcast with one to eight subscribed consumers: producer throughput, the share
+// of packets each consumer saw and publish-to-consume latency. A last run adds deliberately slow
+// consumers next to a fast one and checks that the fast one never misses a packet.
+//
+// Linux: g++ -std=c++17 -O2 -I../src BroadcastBenchmark.cpp ../src/PacketBroadcast.cpp -o BroadcastBenchmark -pthread
+
+#include "PacketBroadcast.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <thread>
+#include <vector>
+
+using Clock = std::chrono::steady_clock;
+
+static constexpr auto FloodPackets = 4000000;
+static constexpr auto BurstPackets = 400000;
+static constexpr auto BurstLength = 64; // packets per burst, about one BLE notification at a high sample rate
+static constexpr uint16_t GyroRange = 500;
+static constexpr auto BurstGapUs = 50;
+static constexpr int ConsumerCounts[] = { 1, 2, 4, 8 };
+static constexpr auto SlowRunSeconds = 2;
+static constexpr auto SlowRunRateHz = 1000;
+
+static int64_t NowNs()
+{
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now().time_since_epoch()).count();
+}
+
+struct Consumer
+{
+	std::atomic<uint64_t> received{ 0 };
+	std::atomic<int64_t> checksum{ 0 };
+	std::vector<int64_t> latenciesNs; // only touched by the consumer thread until it stops
+	std::unique_ptr<PacketBroadcast::Subscription> subscription;
+};
+
+static void Subscribe(PacketBroadcast& broadcast, Consumer& consumer, PacketBroadcast::LagPolicy policy, int workUs = 0)
+{
+	consumer.latenciesNs.reserve(1 << 20);
+	consumer.subscription = std::make_unique<PacketBroadcast::Subscription>(broadcast, policy,
+		[&consumer, workUs](const PacketBroadcast::Entry& entry, bool) {
+			if (consumer.latenciesNs.size() < consumer.latenciesNs.capacity()) consumer.latenciesNs.push_back(NowNs() - entry.timestampNs);
+			consumer.checksum.fetch_add(entry.packet.Gyro.X, std::memory_order_relaxed);
+			consumer.received.fetch_add(1, std::memory_order_relaxed);
+			if (workUs > 0) std::this_thread::sleep_for(std::chrono::microseconds(workUs));
+		});
+}
+
+static void WaitUntilDrained(PacketBroadcast& broadcast, std::vector<std::unique_ptr<Consumer>>& consumers)
+{
+	auto deadline = Clock::now() + std::chrono::seconds(2);
+	for (auto& consumer : consumers)
+	{
+		while (consumer->received + consumer->subscription->SkippedCount() < broadcast.PublishedCount()
+			&& !consumer->subscription->IsDetached() && Clock::now() < deadline)
+		{
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		}
+	}
+}
+
+static double Percentile(std::vector<int64_t> values, double fraction)
+{
+	if (values.empty()) return 0;
+	std::sort(values.begin(), values.end());
+	return (double)values[std::min(values.size() - 1, (size_t)(fraction * values.size()))];
+}
+
+static Packet MakePacket(int i)
+{
+	return { { (int16_t)(i & 0x7fff), (int16_t)(i >> 3), (int16_t)-i }, (uint8_t)(i & 7) };
+}
+
+static void RunThroughput(int consumerCount, bool isBursty)
+{
+	auto broadcast = std::make_unique<PacketBroadcast>();
+	std::vector<std::unique_ptr<Consumer>> consumers;
+	for (int i = 0; i < consumerCount; i++)
+	{
+		consumers.push_back(std::make_unique<Consumer>());
+		Subscribe(*broadcast, *consumers.back(), PacketBroadcast::LagPolicy::Skip);
+	}
+
+	auto packetCount = isBursty ? BurstPackets : FloodPackets;
+	auto start = Clock::now();
+	for (int i = 0; i < packetCount; i++)
+	{
+		broadcast->Publish(MakePacket(i), GyroRange, NowNs());
+		if (isBursty && i % BurstLength == BurstLength - 1) std::this_thread::sleep_for(std::chrono::microseconds(BurstGapUs));
+	}
+	auto publishSeconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+	WaitUntilDrained(*broadcast, consumers);
+
+	uint64_t received = 0;
+	std::vector<int64_t> latencies;
+	for (auto& consumer : consumers)
+	{
+		consumer->subscription.reset();
+		received += consumer->received;
+		latencies.insert(latencies.end(), consumer->latenciesNs.begin(), consumer->latenciesNs.end());
+	}
+
+	printf("%-6s %9d %12.1f %12.1f %9.1f%% %10.2f %10.2f\n",
+		isBursty ? "burst" : "flood",
+		consumerCount,
+		packetCount / publishSeconds / 1e6,
+		received / publishSeconds / 1e6,
+		100.0 * received / ((double)packetCount * consumerCount),
+		Percentile(latencies, 0.5) / 1000,
+		Percentile(latencies, 0.99) / 1000);
+}
+
+// A fast consumer next to one that needs every packet and one that may skip, both far too slow
+static void RunSlowConsumers()
+{
+	auto broadcast = std::make_unique<PacketBroadcast>();
+	std::vector<std::unique_ptr<Consumer>> consumers;
+	for (int i = 0; i < 3; i++) consumers.push_back(std::make_unique<Consumer>());
+
+	Subscribe(*broadcast, *consumers[0], PacketBroadcast::LagPolicy::Detach);
+	Subscribe(*broadcast, *consumers[1], PacketBroadcast::LagPolicy::Detach, 5000);
+	Subscribe(*broadcast, *consumers[2], PacketBroadcast::LagPolicy::Skip, 5000);
+
+	auto packetCount = SlowRunSeconds * SlowRunRateHz;
+	int64_t slowestPublishNs = 0;
+	auto wakeTime = Clock::now();
+	for (int i = 0; i < packetCount; i++)
+	{
+		wakeTime += std::chrono::microseconds(1000000 / SlowRunRateHz);
+		std::this_thread::sleep_until(wakeTime);
+
+		auto before = NowNs();
+		broadcast->Publish(MakePacket(i), GyroRange, before);
+		slowestPublishNs = std::max(slowestPublishNs, NowNs() - before);
+	}
+
+	WaitUntilDrained(*broadcast, consumers);
+
+	const char* names[] = { "fast, detach", "slow, detach", "slow, skip" };
+	printf("\n%d packets at %d Hz, slowest publish %.1f us\n", packetCount, SlowRunRateHz, slowestPublishNs / 1000.0);
+	printf("%-14s %9s %9s %9s %10s\n", "consumer", "received", "skipped", "detached", "p99 us");
+	for (int i = 0; i < 3; i++)
+	{
+		auto& consumer = *consumers[i];
+		auto skipped = consumer.subscription->SkippedCount();
+		auto isDetached = consumer.subscription->IsDetached();
+		consumer.subscription.reset();
+		printf("%-14s %9llu %9llu %9s %10.2f\n", names[i],
+			(unsigned long long)consumer.received.load(), (unsigned long long)skipped,
+			isDetached ? "yes" : "no", Percentile(consumer.latenciesNs, 0.99) / 1000);
+	}
+}
+
+int main()
+{
+	printf("%u hardware threads, ring of %d packets\n\n", std::thread::hardware_concurrency(), PacketBroadcast::Capacity);
+	printf("%-6s %9s %12s %12s %10s %10s %10s\n", "load", "consumers", "publish M/s", "deliver M/s", "seen", "p50 us", "p99 us");
+
+	for (auto isBursty : { false, true })
+	{
+		for (auto consumerCount : ConsumerCounts) RunThroughput(consumerCount, isBursty);
+	}
+
+	RunSlowConsumers();
+	return 0;
+}
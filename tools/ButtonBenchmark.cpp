@@ -0,0 +1,198 @@
+// Checks ButtonMapper's chord, tap, hold and mode timing on a virtual clock, then measures the cost
+// of dispatching a packet's buttons through the compiled table. Each check replays button edges as
+// 100 Hz packets and compares the outputs, stamped with the packet time, against what the bindings
+// should produce.
+//
+// Linux: g++ -std=c++17 -O2 -I../src ButtonBenchmark.cpp ../src/ButtonMapper.cpp -o ButtonBenchmark
+
+#include "ButtonMapper.h"
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+static constexpr auto PacketMs = 10;
+static constexpr auto DispatchPackets = 20000000;
+static constexpr uint32_t Seed = 12345;
+
+static constexpr uint8_t L = ButtonMapper::LeftButton;
+static constexpr uint8_t R = ButtonMapper::RightButton;
+static constexpr uint8_t M = ButtonMapper::MiddleButton;
+
+struct Edge
+{
+	int ms;
+	uint8_t buttons; // down from here on
+};
+
+struct Check
+{
+	const char* name;
+	std::vector<const char*> bindings; // profile lines over the default table
+	std::vector<Edge> edges;
+	const char* expected; // "<ms>:<output>" separated by spaces
+};
+
+static const Check Checks[] = {
+	{ "default click acts on the edge", {}, { { 0, L }, { 100, 0 } }, "0:L+ 100:L-" },
+	{ "default middle gesture", {}, { { 20, M }, { 70, 0 } }, "20:G+ 70:G-" },
+	{ "default buttons together", {}, { { 0, L | M }, { 50, M }, { 80, 0 } }, "0:L+ 0:G+ 50:L- 80:G-" },
+	{ "chord within the window", { "button.left+right = precision" },
+		{ { 0, L }, { 40, L | R }, { 200, R }, { 250, 0 } }, "40:P+ 200:P-" },
+	{ "chord window missed", { "button.left+right = precision" },
+		{ { 0, L }, { 60, L | R }, { 200, R }, { 250, 0 } }, "50:L+ 110:R+ 200:L- 250:R-" },
+	{ "released while waiting for a chord", { "button.left+right = precision" },
+		{ { 0, L }, { 20, 0 } }, "20:L+ 20:L-" },
+	{ "no chord window", { "button.left+right = precision", "chord_window_ms = 0" },
+		{ { 0, L }, { 10, L | R }, { 30, 0 } }, "0:L+ 10:R+ 30:R- 30:L-" },
+	{ "tap", { "button.right = none", "button.right.tap = key ctrl+w", "button.right.hold = key escape" },
+		{ { 0, R }, { 490, 0 } }, "490:K57/2+ 490:K57/2-" },
+	{ "hold", { "button.right = none", "button.right.tap = key ctrl+w", "button.right.hold = key escape" },
+		{ { 0, R }, { 800, 0 } }, "500:K1B/0+ 800:K1B/0-" },
+	{ "too long for a tap", { "button.right = none", "button.right.tap = key enter", "long_press_ms = 300" },
+		{ { 0, R }, { 310, 0 } }, "" },
+	{ "tap toggles", { "button.middle = none", "button.middle.tap = precision" },
+		{ { 0, M }, { 50, 0 }, { 100, L }, { 150, 0 }, { 200, M }, { 250, 0 } }, "50:P+ 100:L+ 150:L- 250:P-" },
+	{ "held and latched scroll", { "button.middle = scroll", "button.right = none", "button.right.tap = scroll" },
+		{ { 0, R }, { 50, 0 }, { 100, M }, { 150, 0 }, { 200, R }, { 250, 0 } }, "50:S+ 250:S-" },
+	{ "momentary mode", { "button.middle = mode 1", "mode1.button.left = key pagedown" },
+		{ { 0, M }, { 100, M | L }, { 150, M }, { 200, 0 }, { 300, L }, { 350, 0 } }, "100:K22/0+ 150:K22/0- 300:L+ 350:L-" },
+	{ "switched mode", { "button.middle = none", "button.middle.tap = mode 1", "mode1.button.left = key pagedown",
+		"mode1.button.middle.tap = mode 0" },
+		{ { 0, M }, { 50, 0 }, { 100, L }, { 150, 0 }, { 200, M }, { 250, 0 }, { 300, L }, { 350, 0 } },
+		"100:K22/0+ 150:K22/0- 300:L+ 350:L-" },
+	{ "chord prefix with its own tap", { "button.left = none", "button.left.tap = key a", "button.left+middle.hold = key b" },
+		{ { 0, L }, { 30, L | M }, { 600, 0 }, { 700, L }, { 780, 0 } }, "500:K42/0+ 600:K42/0- 780:K41/0+ 780:K41/0-" },
+};
+
+static std::string Describe(const ButtonMapper::Output& output)
+{
+	using ActionType = ButtonMapper::ActionType;
+
+	char text[32];
+	auto& action = output.action;
+	switch (action.type)
+	{
+	case ActionType::Mouse: snprintf(text, sizeof(text), "%c", "LRM"[action.value]); break;
+	case ActionType::Key: snprintf(text, sizeof(text), "K%X/%X", action.key, action.value); break;
+	case ActionType::MiddleGesture: snprintf(text, sizeof(text), "G"); break;
+	case ActionType::Scroll: snprintf(text, sizeof(text), "S"); break;
+	case ActionType::Precision: snprintf(text, sizeof(text), "P"); break;
+	default: snprintf(text, sizeof(text), "?"); break;
+	}
+	return std::string(text) + (output.isActive ? "+" : "-");
+}
+
+static bool Compile(const std::vector<const char*>& bindings, ButtonMapper::Table& table)
+{
+	table = ButtonMapper::DefaultTable();
+	for (auto binding : bindings)
+	{
+		std::string line = binding;
+		auto separator = line.find(" = ");
+		if (!ButtonMapper::ParseSetting(line.substr(0, separator), line.substr(separator + 3), table)) return false;
+	}
+	return ButtonMapper::Compile(table);
+}
+
+static std::string Replay(const Check& check, const ButtonMapper::Table& table)
+{
+	ButtonMapper mapper(table);
+	ButtonMapper::Output outputs[ButtonMapper::MaxOutputs];
+	std::string result;
+
+	uint8_t buttons = 0;
+	size_t next = 0;
+	for (int ms = 0; ms <= check.edges.back().ms + 1000; ms += PacketMs)
+	{
+		for (; next < check.edges.size() && check.edges[next].ms <= ms; next++) buttons = check.edges[next].buttons;
+
+		auto count = mapper.Update(buttons, ms, outputs);
+		for (int i = 0; i < count; i++)
+		{
+			if (!result.empty()) result += ' ';
+			result += std::to_string(ms) + ':' + Describe(outputs[i]);
+		}
+	}
+	return result;
+}
+
+// Buttons change every few packets, as in busy clicking, or are held for long stretches
+static std::vector<uint8_t> MakeTrace(int changeEvery)
+{
+	std::mt19937 random(Seed);
+	std::uniform_int_distribution<int> mask(0, ButtonMapper::MaskCount - 1);
+	std::vector<uint8_t> trace(4096);
+	uint8_t buttons = 0;
+	for (size_t i = 0; i < trace.size(); i++)
+	{
+		if (i % changeEvery == 0) buttons = (uint8_t)mask(random);
+		trace[i] = buttons;
+	}
+	return trace;
+}
+
+static double DispatchNanoseconds(const ButtonMapper::Table& table, const std::vector<uint8_t>& trace, uint64_t& outputTotal)
+{
+	ButtonMapper mapper(table);
+	ButtonMapper::Output outputs[ButtonMapper::MaxOutputs];
+
+	auto start = std::chrono::steady_clock::now();
+	for (int i = 0; i < DispatchPackets; i++)
+	{
+		outputTotal += mapper.Update(trace[i & (trace.size() - 1)], (int64_t)i * PacketMs, outputs);
+	}
+	return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / DispatchPackets;
+}
+
+int main()
+{
+	auto isCorrect = true;
+	for (auto& check : Checks)
+	{
+		ButtonMapper::Table table;
+		if (!Compile(check.bindings, table))
+		{
+			printf("%-40s bindings rejected\n", check.name);
+			isCorrect = false;
+			continue;
+		}
+
+		auto result = Replay(check, table);
+		auto isMatch = result == check.expected;
+		isCorrect &= isMatch;
+		printf("%-40s %s\n", check.name, isMatch ? "ok" : "WRONG");
+		if (!isMatch) printf("    expected \"%s\"\n    got      \"%s\"\n", check.expected, result.c_str());
+	}
+
+	auto defaults = ButtonMapper::DefaultTable();
+	ButtonMapper::Table chords;
+	Compile({ "button.left+right = precision", "button.right = none", "button.right.tap = key ctrl+w",
+		"button.right.hold = key escape", "button.middle = mode 1", "mode1.button.left = key pagedown",
+		"button.left+middle.hold = scroll" }, chords);
+
+	struct Workload
+	{
+		const char* name;
+		const ButtonMapper::Table& table;
+		int changeEvery;
+	};
+	const Workload workloads[] = {
+		{ "default, buttons idle", defaults, 1 << 30 },
+		{ "default, change every 4 packets", defaults, 4 },
+		{ "chords, change every 4 packets", chords, 4 },
+		{ "chords, change every 40 packets", chords, 40 },
+	};
+
+	printf("\n%d packets per workload\n%-34s %10s %10s\n", DispatchPackets, "workload", "ns/packet", "outputs");
+	for (auto& workload : workloads)
+	{
+		uint64_t outputTotal = 0;
+		auto nanoseconds = DispatchNanoseconds(workload.table, MakeTrace(workload.changeEvery), outputTotal);
+		printf("%-34s %10.2f %10llu\n", workload.name, nanoseconds, (unsigned long long)outputTotal);
+	}
+
+	printf("\nbutton timing correct: %s\n", isCorrect ? "yes" : "NO");
+	return isCorrect ? 0 : 1;
+}
@@ -0,0 +1,451 @@
+// Evaluates click stabilization on synthetic click traces. A hand holds the remote still on a target
+// and clicks; pressing and releasing the button rotate the remote with a short pulse that starts
+// before the switch closes, as a thumb pushing down does. The traces run through SimulatedRemote,
+// PacketParser and Input under several ClickStabilizer settings, and PointerOutput forwards to a
+// loopback NetworkOutput receiver so that the exact cursor position of every button event is seen.
+//
+// Every setting replays the same traces, so the settings differ only in what Input does with them:
+//   click        still, press, release: where the press and release land, and how often they land
+//                more than DragSlopPixels apart, which the system would take for the start of a drag
+//   click and go the hand moves on right after the release: time until the cursor follows
+//   drag         press, move, release: time until the drag moves the cursor
+//   pointing     motion without buttons: cursor deviation from the unstabilized run
+// Latencies are reported as added to the unstabilized run of the same trace.
+//
+// Linux: g++ -std=c++17 -O2 -I../src ClickBenchmark.cpp ../src/SimulatedRemote.cpp ../src/RemoteControl.cpp
+//            ../src/PacketParser.cpp ../src/CircularBuffer.cpp ../src/Input.cpp ../src/PointerOutput.cpp
+//            ../src/IdleDetector.cpp ../src/OrientationFilter.cpp ../src/MotionPredictor.cpp ../src/GyroHistory.cpp
+//            ../src/Logger.cpp ../src/Metrics.cpp ../src/NetworkOutput.cpp ../src/PacketBroadcast.cpp ../src/Trace.cpp
+//            ../src/PlotFeed.cpp ../src/ResponseCurve.cpp ../src/ButtonMapper.cpp ../src/ClickStabilizer.cpp
+//            ../src/Startup.cpp ../src/ProcessInfo.cpp -o ClickBenchmark -lrt -pthread
+//
+// Usage: ClickBenchmark [--seed n] [--trials n per kind]
+
+#include "CircularBuffer.h"
+#include "Input.h"
+#include "Logger.h"
+#include "NetworkOutput.h"
+#include "PacketParser.h"
+#include "Pipeline.h"
+#include "PointerOutput.h"
+#include "RemoteControl.h"
+#include "SimulatedRemote.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <functional>
+#include <random>
+#include <vector>
+
+static constexpr uint16_t ReceiverPort = 47910;
+static constexpr auto ForwardSecret = "benchmark";
+static constexpr auto Pi = 3.14159265358979;
+static constexpr auto ConnectionIntervalMs = 15;
+static constexpr auto SettleMs = 1000; // still, while the parser aligns
+static constexpr auto DragSlopPixels = 4.0; // Windows' default SM_CXDRAG: farther apart, a click becomes a drag
+static constexpr auto OnsetPixels = 5.0; // the cursor has visibly followed the hand
+static constexpr auto TremorHz = 9.0;
+static constexpr auto Tremor = 1.0; // peak degrees per second
+static constexpr auto SensorNoise = 0.3;
+
+struct Configuration
+{
+	const char* name;
+	ClickStabilizer::Parameters parameters;
+};
+
+static const Configuration Configurations[] = {
+	{ "off", { 0, 0, 8 } },
+	{ "rewind 40 ms", { 40, 0, 8 } },
+	{ "hold 60 ms, 8 px", { 0, 60, 8 } },
+	{ "20 / 40 ms, 8 px", { 20, 40, 8 } },
+	{ "40 / 60 ms, 8 px", { 40, 60, 8 } },
+	{ "40 / 60 ms, 16 px", { 40, 60, 16 } },
+	{ "60 / 100 ms, 16 px", { 60, 100, 16 } },
+};
+
+enum class Kind
+{
+	Click,
+	ClickAndGo,
+	Drag,
+	Pointing
+};
+
+// A rate pulse shaped as half a sine, in degrees per second on the remote's X (vertical) and Z axes
+struct Pulse
+{
+	double startMs;
+	double durationMs;
+	double peakX;
+	double peakZ;
+
+	void Add(double t, double& rateX, double& rateZ) const
+	{
+		if (t < startMs || t >= startMs + durationMs) return;
+		auto shape = std::sin(Pi * (t - startMs) / durationMs);
+		rateX += peakX * shape;
+		rateZ += peakZ * shape;
+	}
+};
+
+// One trial's hand motion and button, as functions of the time since the trial started
+struct ClickTrace
+{
+	Kind kind;
+	double lengthMs;
+	double pressMs; // button down in [pressMs, releaseMs), none when equal
+	double releaseMs;
+	Pulse pressPulse;
+	Pulse releasePulse;
+	Pulse motion; // the deliberate part, onset at motion.startMs
+	double tremorPhase;
+
+	void Rates(double t, double& rateX, double& rateZ) const
+	{
+		rateX = rateZ = 0;
+		pressPulse.Add(t, rateX, rateZ);
+		releasePulse.Add(t, rateX, rateZ);
+		motion.Add(t, rateX, rateZ);
+		auto tremor = Tremor * std::sin(2 * Pi * TremorHz * t / 1000 + tremorPhase);
+		rateX += tremor;
+		rateZ += tremor * 0.7;
+	}
+
+	uint8_t Buttons(double t) const
+	{
+		return t >= pressMs && t < releaseMs ? Input::LeftMask : 0;
+	}
+};
+
+// Press pulses of a thumb on a top button: mostly pitch, 0.15 to 0.65 degrees in all. The release
+// springs back with about half of it.
+static std::vector<ClickTrace> MakeTraces(uint32_t seed, int trialsPerKind)
+{
+	std::mt19937 random(seed);
+	auto uniform = [&random](double low, double high) { return std::uniform_real_distribution<double>(low, high)(random); };
+
+	std::vector<ClickTrace> traces;
+	for (auto kind : { Kind::Pointing, Kind::Click, Kind::ClickAndGo, Kind::Drag })
+	{
+		for (int i = 0; i < trialsPerKind; i++)
+		{
+			ClickTrace trace{ kind, 0, 0, 0, {}, {}, {}, uniform(0, 2 * Pi) };
+			// Every other trace mirrors the one before, so the cursor stays clear of the screen edges
+			if (i % 2)
+			{
+				auto mirrored = traces.back();
+				for (auto pulse : { &mirrored.pressPulse, &mirrored.releasePulse, &mirrored.motion })
+				{
+					pulse->peakX = -pulse->peakX;
+					pulse->peakZ = -pulse->peakZ;
+				}
+				mirrored.tremorPhase += Pi;
+				traces.push_back(mirrored);
+				continue;
+			}
+
+			auto direction = uniform(0, 2 * Pi);
+			auto peak = uniform(6, 15);
+			trace.pressMs = 300;
+			trace.pressPulse = { trace.pressMs - uniform(10, 30), uniform(40, 70), peak, peak * uniform(-0.3, 0.3) };
+
+			switch (kind)
+			{
+			case Kind::Click:
+				trace.releaseMs = trace.pressMs + uniform(80, 160);
+				trace.lengthMs = trace.releaseMs + 300;
+				break;
+			case Kind::ClickAndGo:
+				trace.releaseMs = trace.pressMs + uniform(80, 160);
+				trace.motion = { trace.releaseMs + uniform(0, 80), 250, 0, 0 };
+				trace.lengthMs = trace.motion.startMs + 400;
+				break;
+			case Kind::Drag:
+				trace.motion = { trace.pressMs + uniform(40, 120), 300, 0, 0 };
+				trace.releaseMs = trace.motion.startMs + trace.motion.durationMs + 100;
+				trace.lengthMs = trace.releaseMs + 300;
+				break;
+			case Kind::Pointing:
+				trace.pressMs = trace.releaseMs = 0;
+				trace.pressPulse = {};
+				trace.motion = { 100, uniform(200, 600), 0, 0 };
+				trace.lengthMs = trace.motion.startMs + trace.motion.durationMs + 200;
+				break;
+			}
+
+			auto speed = kind == Kind::Pointing ? uniform(10, 80) : uniform(30, 60);
+			trace.motion.peakX = speed * std::sin(direction);
+			trace.motion.peakZ = speed * std::cos(direction);
+			if (kind != Kind::Pointing)
+			{
+				auto& press = trace.pressPulse;
+				trace.releasePulse = { trace.releaseMs - 10, press.durationMs * 0.8, -press.peakX / 2, -press.peakZ / 2 };
+			}
+			traces.push_back(trace);
+		}
+	}
+	return traces;
+}
+
+// What Pipeline::Connect needs from a transport, driven synchronously
+struct BenchmarkTransport
+{
+	std::function<void()> Connected;
+	std::function<void()> Disconnected;
+	std::function<void()> ReceivedData;
+
+	CircularBuffer buffer;
+	SimulatedRemote* remote = nullptr;
+
+	bool Write(const uint8_t* data, size_t length)
+	{
+		return remote->Receive(data, length);
+	}
+};
+
+struct Sighting
+{
+	double timeMs; // since the trial started
+	float x;
+	float y;
+};
+
+struct TrialResult
+{
+	Sighting target; // the cursor just before the press pulse
+	Sighting down;
+	Sighting up;
+	std::vector<Sighting> path; // after every notification
+	bool hasDown = false;
+	bool hasUp = false;
+};
+
+class Simulation
+{
+public:
+	Simulation(uint32_t seed) :
+		remote([this](const uint8_t* data, size_t length) {
+			for (size_t i = 0; i < length; i++) transport.buffer.WriteBuffer(data[i]);
+		}, seed),
+		remoteControl([this](const uint8_t* data, size_t length) { return transport.Write(data, length); }),
+		noise(seed)
+	{
+		transport.remote = &remote;
+		Pipeline::Connect(transport, remoteControl);
+		Input::UsageModeRequested = nullptr; // keep the range fixed, the traces are small
+		PointerOutput::Move(PointerOutput::ScreenWidth() / 2.0f, PointerOutput::ScreenHeight() / 2.0f);
+		Input::Initialize(); // every setting starts from the centre, not where the last one left off
+		PacketParser::ResetDataAlignment();
+		transport.Connected();
+
+		ClickTrace still{ Kind::Pointing, SettleMs, 0, 0, {}, {}, {}, 0 };
+		TrialResult ignored;
+		Run(still, ignored);
+	}
+
+	~Simulation()
+	{
+		transport.Disconnected();
+		PacketParser::SetBuffer(nullptr);
+	}
+
+	void Run(const ClickTrace& trace, TrialResult& result)
+	{
+		auto trialStartMs = nowMs;
+		current = &result;
+		result.target = { 0, x, y };
+
+		for (; nowMs - trialStartMs < trace.lengthMs; nowMs++)
+		{
+			auto t = (double)(nowMs - trialStartMs);
+			if (t <= trace.pressPulse.startMs || trace.kind == Kind::Pointing) result.target = { t, x, y };
+
+			if (nowMs % SamplePeriodMs == 0)
+			{
+				// The mean rate over the sample period, as a gyro reports it
+				double sumX = 0, sumZ = 0;
+				for (int i = 0; i < SamplePeriodMs; i++)
+				{
+					double rateX, rateZ;
+					trace.Rates(t - SamplePeriodMs + i + 0.5, rateX, rateZ);
+					sumX += rateX / SamplePeriodMs;
+					sumZ += rateZ / SamplePeriodMs;
+				}
+				remote.Step({ (float)(sumX + SensorNoise * gaussian(noise)), (float)(SensorNoise * gaussian(noise)),
+					(float)(sumZ + SensorNoise * gaussian(noise)) }, trace.Buttons(t));
+			}
+
+			if (nowMs % ConnectionIntervalMs == 0)
+			{
+				transport.ReceivedData();
+				remoteControl.CheckTimeouts();
+				trialTimeMs = t;
+				while (receiver.Poll(0, [this](const NetworkOutput::Event& event) { OnEvent(event); })) {}
+				result.path.push_back({ t, x, y });
+			}
+		}
+		current = nullptr;
+	}
+
+	bool Open()
+	{
+		if (!receiver.Open("127.0.0.1", ReceiverPort, ForwardSecret)) return false;
+		PointerOutput::SetForwardTarget("127.0.0.1", ReceiverPort, ForwardSecret);
+		return true;
+	}
+private:
+	static constexpr auto SamplePeriodMs = 1000 / RemoteControl::DefaultSampleRateHz;
+
+	BenchmarkTransport transport;
+	SimulatedRemote remote;
+	RemoteControl::Controller remoteControl;
+	NetworkOutput::Receiver receiver;
+	std::mt19937 noise; // sensor noise, the same sequence for every setting
+	std::normal_distribution<double> gaussian{ 0, 1 };
+
+	int64_t nowMs = 0;
+	double trialTimeMs = 0;
+	float x = PointerOutput::VirtualScreenWidth / 2.0f;
+	float y = PointerOutput::VirtualScreenHeight / 2.0f;
+	TrialResult* current = nullptr;
+
+	void OnEvent(const NetworkOutput::Event& event)
+	{
+		if (event.type == NetworkOutput::EventType::Move)
+		{
+			x = event.x * PointerOutput::ScreenWidth();
+			y = event.y * PointerOutput::ScreenHeight();
+		}
+		if (event.type != NetworkOutput::EventType::Button || !current) return;
+
+		if (event.isDown && !current->hasDown) current->down = { trialTimeMs, x, y }, current->hasDown = true;
+		if (!event.isDown && current->hasDown) current->up = { trialTimeMs, x, y }, current->hasUp = true;
+	}
+};
+
+static double Distance(const Sighting& a, const Sighting& b)
+{
+	return std::hypot(a.x - b.x, a.y - b.y);
+}
+
+// When the cursor had moved OnsetPixels from where it was at fromMs
+static double OnsetMs(const TrialResult& result, double fromMs)
+{
+	const Sighting* start = nullptr;
+	for (auto& sighting : result.path)
+	{
+		if (!start && sighting.timeMs >= fromMs) start = &sighting;
+		if (start && Distance(sighting, *start) >= OnsetPixels) return sighting.timeMs;
+	}
+	return result.path.back().timeMs;
+}
+
+struct Summary
+{
+	double downError = 0; // pixels from the target, mean
+	double upError = 0;
+	double slips = 0; // share of clicks whose release lands more than DragSlopPixels from the press
+	double goLatencyMs = 0; // added, mean
+	double dragLatencyMs = 0;
+	double pointingDeviation = 0; // pixels, max
+};
+
+static std::vector<TrialResult> RunAll(const ClickStabilizer::Parameters& parameters, const std::vector<ClickTrace>& traces, uint32_t seed)
+{
+	static std::deque<Input::Tuning> tunings; // Input keeps a pointer to each
+	tunings.push_back(Input::DefaultTuning());
+	tunings.back().clickStabilization = parameters;
+	Input::SetTuning(&tunings.back());
+
+	Simulation simulation(seed);
+	std::vector<TrialResult> results(traces.size());
+	if (!simulation.Open())
+	{
+		printf("cannot open the loopback receiver on port %d\n", ReceiverPort);
+		exit(1);
+	}
+	for (size_t i = 0; i < traces.size(); i++) simulation.Run(traces[i], results[i]);
+	return results;
+}
+
+static Summary Summarize(const std::vector<ClickTrace>& traces, const std::vector<TrialResult>& results, const std::vector<TrialResult>& reference)
+{
+	Summary summary;
+	int clicks = 0, goes = 0, drags = 0;
+	for (size_t i = 0; i < traces.size(); i++)
+	{
+		auto& trace = traces[i];
+		auto& result = results[i];
+		switch (trace.kind)
+		{
+		case Kind::Click:
+			clicks++;
+			summary.downError += Distance(result.down, result.target);
+			summary.upError += Distance(result.up, result.target);
+			summary.slips += Distance(result.up, result.down) > DragSlopPixels;
+			break;
+		case Kind::ClickAndGo:
+			goes++;
+			summary.goLatencyMs += OnsetMs(result, trace.motion.startMs) - OnsetMs(reference[i], trace.motion.startMs);
+			break;
+		case Kind::Drag:
+			drags++;
+			summary.dragLatencyMs += OnsetMs(result, trace.motion.startMs) - OnsetMs(reference[i], trace.motion.startMs);
+			break;
+		case Kind::Pointing:
+			for (size_t j = 0; j < std::min(result.path.size(), reference[i].path.size()); j++)
+			{
+				auto& a = result.path[j];
+				auto& b = reference[i].path[j];
+				auto& startA = result.path.front();
+				auto& startB = reference[i].path.front();
+				summary.pointingDeviation = std::max(summary.pointingDeviation, (double)
+					std::hypot((a.x - startA.x) - (b.x - startB.x), (a.y - startA.y) - (b.y - startB.y)));
+			}
+			break;
+		}
+	}
+
+	summary.downError /= std::max(clicks, 1);
+	summary.upError /= std::max(clicks, 1);
+	summary.slips /= std::max(clicks, 1);
+	summary.goLatencyMs /= std::max(goes, 1);
+	summary.dragLatencyMs /= std::max(drags, 1);
+	return summary;
+}
+
+int main(int argc, char* argv[])
+{
+	uint32_t seed = 1;
+	int trialsPerKind = 200;
+	for (int i = 1; i < argc; i++)
+	{
+		if (std::strcmp(argv[i], "--seed") == 0 && i + 1 < argc) seed = (uint32_t)std::atoi(argv[++i]);
+		else if (std::strcmp(argv[i], "--trials") == 0 && i + 1 < argc) trialsPerKind = std::max(1, std::atoi(argv[++i]));
+	}
+
+	Logger::MinimumLevel = Logger::Level::Error;
+	Input::Initialize();
+
+	auto traces = MakeTraces(seed, trialsPerKind);
+	printf("seed %u, %d traces per kind, %d ms connection interval\n\n", seed, trialsPerKind, ConnectionIntervalMs);
+	printf("%-22s %9s %9s %8s %12s %12s %11s\n", "stabilization", "down err", "up err", "slips", "go latency", "drag latency", "pointing");
+	printf("%-22s %9s %9s %8s %12s %12s %11s\n", "rewind / hold, move", "px", "px", "%", "+ms", "+ms", "dev px");
+
+	std::vector<TrialResult> reference;
+	for (auto& configuration : Configurations)
+	{
+		auto results = RunAll(configuration.parameters, traces, seed);
+		if (reference.empty()) reference = results;
+
+		auto summary = Summarize(traces, results, reference);
+		printf("%-22s %9.2f %9.2f %8.1f %12.1f %12.1f %11.2f\n", configuration.name, summary.downError, summary.upError,
+			100 * summary.slips, summary.goLatencyMs, summary.dragLatencyMs, summary.pointingDeviation);
+	}
+
+	return 0;
+}
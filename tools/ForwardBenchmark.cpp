@@ -0,0 +1,238 @@
+// Runs input forwarding end to end over loopback: PointerOutput forwards a synthetic pointer stream
+// through NetworkOutput to a Receiver on another thread, optionally through a relay that drops
+// datagrams. Reports added latency, loss and whether the receiver ends in the sender's state.
+//
+// Linux: g++ -std=c++17 -O2 -I../src ForwardBenchmark.cpp ../src/NetworkOutput.cpp ../src/PointerOutput.cpp
+//            ../src/Logger.cpp ../src/Trace.cpp -o ForwardBenchmark -pthread
+
+#include "NetworkOutput.h"
+#include "PointerOutput.h"
+#include <algorithm>
+#include <arpa/inet.h>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <netinet/in.h>
+#include <poll.h>
+#include <random>
+#include <sys/socket.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+static constexpr uint16_t ReceiverPort = 47900;
+static constexpr uint16_t RelayPort = 47901;
+static constexpr auto ForwardSecret = "benchmark";
+static constexpr auto NotificationCount = 4000;
+static constexpr auto NotificationIntervalUs = 1000;
+static constexpr auto SamplesPerNotification = 4;
+static constexpr auto SettleNotifications = 8; // stationary tail, so a lost last datagram is repaired
+static constexpr uint32_t Seed = 7;
+
+struct Scenario
+{
+	const char* name;
+	bool isRelayed;
+	double dropRate;
+};
+
+static constexpr Scenario Scenarios[] = {
+	{ "direct", false, 0 },
+	{ "relay", true, 0 },
+	{ "relay 5% drop", true, 0.05 },
+	{ "relay 20% drop", true, 0.20 },
+};
+
+struct ReceivedState
+{
+	std::vector<double> latenciesUs;
+	float x = 0;
+	float y = 0;
+	uint8_t heldButtons = 0;
+	NetworkOutput::ReceiverStatistics statistics{};
+};
+
+static std::atomic<bool> isSenderDone{ false };
+
+static void Receive(NetworkOutput::Receiver& receiver, ReceivedState& state)
+{
+	auto handler = [&state](const NetworkOutput::Event& event) {
+		switch (event.type)
+		{
+		case NetworkOutput::EventType::Move:
+			state.x = event.x;
+			state.y = event.y;
+			break;
+		case NetworkOutput::EventType::Button:
+			if (event.isDown) state.heldButtons |= 1 << (int)event.button;
+			else state.heldButtons &= ~(1 << (int)event.button);
+			break;
+		case NetworkOutput::EventType::Scroll:
+		case NetworkOutput::EventType::Key:
+			break;
+		}
+	};
+
+	// Keep draining briefly after the sender finishes
+	auto quietPolls = 0;
+	while (quietPolls < 5)
+	{
+		NetworkOutput::Header header;
+		if (receiver.Poll(20, handler, &header))
+		{
+			state.latenciesUs.push_back((double)(NetworkOutput::NowMicroseconds() - header.senderTimeUs));
+			quietPolls = 0;
+		}
+		else if (isSenderDone)
+		{
+			quietPolls++;
+		}
+	}
+
+	state.statistics = receiver.Statistics();
+}
+
+// Forwards datagrams from RelayPort to ReceiverPort, dropping some of them
+static void Relay(int relaySocket, double dropRate, std::atomic<bool>& isStopping)
+{
+	std::mt19937 random(Seed);
+	std::bernoulli_distribution isDropped(dropRate);
+
+	sockaddr_in target{};
+	target.sin_family = AF_INET;
+	target.sin_port = htons(ReceiverPort);
+	target.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+	uint8_t data[NetworkOutput::MaxDatagramSize];
+	while (!isStopping)
+	{
+		pollfd descriptor{ relaySocket, POLLIN, 0 };
+		if (poll(&descriptor, 1, 20) <= 0) continue;
+
+		auto length = recv(relaySocket, data, sizeof(data), 0);
+		if (length <= 0 || isDropped(random)) continue;
+		sendto(relaySocket, data, (size_t)length, 0, (sockaddr*)&target, sizeof(target));
+	}
+}
+
+static double Percentile(std::vector<double> values, double fraction)
+{
+	if (values.empty()) return 0;
+	std::sort(values.begin(), values.end());
+	return values[std::min(values.size() - 1, (size_t)(fraction * values.size()))];
+}
+
+static void Run(const Scenario& scenario)
+{
+	NetworkOutput::Receiver receiver;
+	if (!receiver.Open("127.0.0.1", ReceiverPort, ForwardSecret)) return;
+
+	int relaySocket = -1;
+	std::atomic<bool> isRelayStopping{ false };
+	std::thread relayThread;
+	if (scenario.isRelayed)
+	{
+		relaySocket = socket(AF_INET, SOCK_DGRAM, 0);
+		sockaddr_in address{};
+		address.sin_family = AF_INET;
+		address.sin_port = htons(RelayPort);
+		address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+		if (bind(relaySocket, (sockaddr*)&address, sizeof(address)) != 0) return;
+		relayThread = std::thread(Relay, relaySocket, scenario.dropRate, std::ref(isRelayStopping));
+	}
+
+	isSenderDone = false;
+	ReceivedState received;
+	std::thread receiverThread(Receive, std::ref(receiver), std::ref(received));
+
+	PointerOutput::SetForwardTarget("127.0.0.1", scenario.isRelayed ? RelayPort : ReceiverPort, ForwardSecret);
+	PointerOutput::Flush();
+
+	auto width = (float)PointerOutput::ScreenWidth();
+	auto height = (float)PointerOutput::ScreenHeight();
+	float x = 0, y = 0;
+	uint8_t heldButtons = 0;
+	std::vector<double> flushUs;
+
+	auto wakeTime = std::chrono::steady_clock::now();
+	for (int notification = 0; notification < NotificationCount + SettleNotifications; notification++)
+	{
+		wakeTime += std::chrono::microseconds(NotificationIntervalUs);
+		std::this_thread::sleep_until(wakeTime);
+
+		// Same order as Input: buttons, then scrolling or movement for each sample
+		if (notification < NotificationCount)
+		{
+			if (notification % 50 == 0 || notification % 50 == 10)
+			{
+				auto isDown = notification % 50 == 0;
+				auto button = (PointerOutput::MouseButton)(notification / 50 % 3);
+				PointerOutput::Button(button, isDown);
+				heldButtons = isDown ? heldButtons | 1 << (int)button : heldButtons & ~(1 << (int)button);
+			}
+			if (notification % 30 == 0) PointerOutput::Scroll(notification % 60 == 0 ? 120 : -120);
+
+			for (int sample = 0; sample < SamplesPerNotification; sample++)
+			{
+				auto angle = (notification * SamplesPerNotification + sample) * 0.002;
+				x = width * (0.5f + 0.4f * (float)std::cos(angle));
+				y = height * (0.5f + 0.4f * (float)std::sin(3 * angle));
+				PointerOutput::Move(x, y);
+			}
+		}
+		else
+		{
+			PointerOutput::Move(x, y);
+		}
+
+		auto flushStart = std::chrono::steady_clock::now();
+		PointerOutput::Flush();
+		flushUs.push_back(std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - flushStart).count());
+	}
+
+	isSenderDone = true;
+	receiverThread.join();
+	PointerOutput::SetForwardTarget("", 0, "");
+	PointerOutput::Flush();
+
+	if (scenario.isRelayed)
+	{
+		isRelayStopping = true;
+		relayThread.join();
+		close(relaySocket);
+	}
+
+	const auto& statistics = received.statistics;
+	auto positionError = std::hypot(received.x * width - x, received.y * height - y);
+
+	printf("%-16s %7llu %6llu %6.2f%% %6llu %8.1f %8.1f %8.1f %8.1f %8.2f px  %s\n",
+		scenario.name,
+		(unsigned long long)statistics.datagrams,
+		(unsigned long long)statistics.lost,
+		100.0 * statistics.lost / std::max<uint64_t>(1, statistics.datagrams + statistics.lost),
+		(unsigned long long)statistics.buttonsReconciled,
+		Percentile(received.latenciesUs, 0.5),
+		Percentile(received.latenciesUs, 0.99),
+		Percentile(received.latenciesUs, 1.0),
+		Percentile(flushUs, 0.5),
+		positionError,
+		received.heldButtons == heldButtons ? "yes" : "NO");
+}
+
+int main()
+{
+	PointerOutput::Initialize();
+
+	printf("%d notifications %d us apart, %d moves each coalesced into one datagram, clicks and scrolls mixed in\n\n",
+		NotificationCount, NotificationIntervalUs, SamplesPerNotification);
+	printf("%-16s %7s %6s %7s %6s %8s %8s %8s %8s %11s  %s\n",
+		"path", "recv", "lost", "loss", "recon", "p50 us", "p99 us", "max us", "send us", "final err", "buttons");
+
+	for (const auto& scenario : Scenarios)
+	{
+		Run(scenario);
+	}
+
+	return 0;
+}
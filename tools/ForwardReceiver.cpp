@@ -0,0 +1,118 @@
+// Injects pointer events forwarded by a backend with forward_to set in its profile. Runs on the
+// machine that should be controlled and prints link statistics every few seconds.
+//
+// The secret must match forward_secret in the sender's profile; datagrams without its tag are
+// dropped. --bind limits the interfaces it listens on, --from the host it accepts datagrams from,
+// and at least one of them is needed, so it never takes input from the whole network by default.
+//
+// Usage: ForwardReceiver --secret <text> (--bind <address> | --from <host> | both) [--port <port>]
+//
+// Linux:   g++ -std=c++17 -O2 -I../src ForwardReceiver.cpp ../src/NetworkOutput.cpp ../src/PointerOutput.cpp
+//              ../src/Logger.cpp ../src/Trace.cpp -o ForwardReceiver -pthread
+// Windows: cl /std:c++17 /EHsc /I..\src ForwardReceiver.cpp ..\src\NetworkOutput.cpp ..\src\PointerOutput.cpp
+//              ..\src\Logger.cpp ..\src\Trace.cpp user32.lib gdi32.lib
+
+#include "Logger.h"
+#include "NetworkOutput.h"
+#include "PointerOutput.h"
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+static constexpr auto PollTimeoutMs = 250;
+static constexpr auto ReportIntervalSeconds = 5;
+
+static std::atomic<bool> isStopping{ false };
+
+static void OnSignal(int)
+{
+	isStopping = true;
+}
+
+static void Inject(const NetworkOutput::Event& event)
+{
+	switch (event.type)
+	{
+	case NetworkOutput::EventType::Move:
+		PointerOutput::Move(event.x * PointerOutput::ScreenWidth(), event.y * PointerOutput::ScreenHeight());
+		break;
+	case NetworkOutput::EventType::Button:
+		PointerOutput::Button(event.button, event.isDown);
+		break;
+	case NetworkOutput::EventType::Scroll:
+		PointerOutput::Scroll(event.amount);
+		break;
+	case NetworkOutput::EventType::Key:
+		PointerOutput::Key(event.key, event.isDown);
+		break;
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	auto port = NetworkOutput::DefaultPort;
+	std::string secret, bindAddress, allowedSender;
+	for (int i = 1; i < argc; i++)
+	{
+		if (std::strcmp(argv[i], "--port") == 0 && i + 1 < argc) port = (uint16_t)std::atoi(argv[++i]);
+		else if (std::strcmp(argv[i], "--secret") == 0 && i + 1 < argc) secret = argv[++i];
+		else if (std::strcmp(argv[i], "--bind") == 0 && i + 1 < argc) bindAddress = argv[++i];
+		else if (std::strcmp(argv[i], "--from") == 0 && i + 1 < argc) allowedSender = argv[++i];
+	}
+
+	if (secret.empty() || (bindAddress.empty() && allowedSender.empty()))
+	{
+		printf("usage: %s --secret <text> (--bind <address> | --from <host> | both) [--port <port>]\n", argv[0]);
+		return 1;
+	}
+
+	Logger::Initialize();
+	PointerOutput::Initialize();
+
+	NetworkOutput::Receiver receiver;
+	if (!receiver.Open(bindAddress, port, secret, allowedSender))
+	{
+		Logger::Shutdown();
+		return 1;
+	}
+
+	std::signal(SIGINT, OnSignal);
+	std::signal(SIGTERM, OnSignal);
+	printf("Listening on UDP port %d of %s, from %s\n", port, bindAddress.empty() ? "all interfaces" : bindAddress.c_str(),
+		allowedSender.empty() ? "any sender" : allowedSender.c_str());
+
+	auto lastReport = std::chrono::steady_clock::now();
+	NetworkOutput::ReceiverStatistics reported{};
+
+	while (!isStopping)
+	{
+		receiver.Poll(PollTimeoutMs, Inject);
+
+		auto now = std::chrono::steady_clock::now();
+		if (now - lastReport < std::chrono::seconds(ReportIntervalSeconds)) continue;
+		lastReport = now;
+
+		const auto& statistics = receiver.Statistics();
+		auto datagrams = statistics.datagrams - reported.datagrams;
+		auto lost = statistics.lost - reported.lost;
+		printf("%8.1f datagrams/s %8.1f events/s  lost %llu (%.2f%%)  late %llu  malformed %llu  unauthenticated %llu  buttons reconciled %llu\n",
+			(double)datagrams / ReportIntervalSeconds,
+			(double)(statistics.events - reported.events) / ReportIntervalSeconds,
+			(unsigned long long)lost,
+			datagrams + lost > 0 ? 100.0 * lost / (datagrams + lost) : 0.0,
+			(unsigned long long)(statistics.late - reported.late),
+			(unsigned long long)(statistics.malformed - reported.malformed),
+			(unsigned long long)(statistics.unauthenticated - reported.unauthenticated),
+			(unsigned long long)(statistics.buttonsReconciled - reported.buttonsReconciled));
+		fflush(stdout);
+		reported = statistics;
+	}
+
+	receiver.Close();
+	Logger::Shutdown();
+	return 0;
+}
@@ -0,0 +1,83 @@
+// Sends one command to a running backend's control endpoint and prints the reply.
+//
+// Usage: GestureControl connect | disconnect | status | reload-profile | start-trace | trace | stop-trace | record [path] | stop-recording | foreground app | shutdown
+//
+// Linux: g++ -std=c++17 -O2 -I../src GestureControl.cpp ../src/ControlServer.cpp ../src/Logger.cpp -o GestureControl -pthread
+
+#include "ControlServer.h"
+#include <cstdio>
+#include <string>
+
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+#ifdef _WIN32
+static bool Exchange(const std::string& request, std::string& response)
+{
+	auto pipe = CreateFileA(ControlServer::EndpointPath().c_str(), GENERIC_READ | GENERIC_WRITE, 0, NULL, OPEN_EXISTING, 0, NULL);
+	if (pipe == INVALID_HANDLE_VALUE) return false;
+
+	DWORD length;
+	bool isSent = WriteFile(pipe, request.data(), (DWORD)request.size(), &length, NULL) != FALSE;
+
+	char data[ControlServer::MaxCommandLength];
+	while (isSent && response.find('\n') == std::string::npos && ReadFile(pipe, data, sizeof(data), &length, NULL) && length > 0)
+	{
+		response.append(data, length);
+	}
+
+	CloseHandle(pipe);
+	return response.find('\n') != std::string::npos;
+}
+#else
+static bool Exchange(const std::string& request, std::string& response)
+{
+	auto path = ControlServer::EndpointPath();
+	sockaddr_un address{};
+	address.sun_family = AF_UNIX;
+	if (path.size() >= sizeof(address.sun_path)) return false;
+	path.copy(address.sun_path, path.size());
+
+	auto socketHandle = socket(AF_UNIX, SOCK_STREAM, 0);
+	if (socketHandle < 0) return false;
+
+	bool isSent = connect(socketHandle, (sockaddr*)&address, sizeof(address)) == 0
+		&& send(socketHandle, request.data(), request.size(), 0) == (ssize_t)request.size();
+
+	char data[ControlServer::MaxCommandLength];
+	ssize_t length;
+	while (isSent && response.find('\n') == std::string::npos && (length = recv(socketHandle, data, sizeof(data), 0)) > 0)
+	{
+		response.append(data, (size_t)length);
+	}
+
+	close(socketHandle);
+	return response.find('\n') != std::string::npos;
+}
+#endif
+
+int main(int argc, char* argv[])
+{
+	if (argc != 2 && !(argc == 3 && (std::string(argv[1]) == "record" || std::string(argv[1]) == "foreground")))
+	{
+		fprintf(stderr, "Usage: %s connect | disconnect | status | reload-profile | start-trace | trace | stop-trace | record [path] | stop-recording | foreground app | shutdown\n", argv[0]);
+		return 2;
+	}
+
+	std::string response;
+	auto command = std::string(argv[1]);
+	if (argc == 3) command += std::string(" ") + argv[2];
+	if (!Exchange(command + "\n", response))
+	{
+		fprintf(stderr, "No backend is listening on %s\n", ControlServer::EndpointPath().c_str());
+		return 1;
+	}
+
+	printf("%s", response.c_str());
+	return response.compare(0, 2, "ok") == 0 ? 0 : 1;
+}
@@ -0,0 +1,116 @@
+// Measures GyroHistory push and window min/max cost against recomputing them over the window for
+// every sample, and checks that both agree.
+//
+// Linux: g++ -std=c++17 -O2 -I../src HistoryBenchmark.cpp ../src/GyroHistory.cpp -o HistoryBenchmark
+
+#include "GyroHistory.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+static constexpr auto SampleCount = 2000000;
+static constexpr int WindowLengths[] = { 8, 32, 100, 256 };
+static constexpr uint32_t Seed = 12345;
+
+struct Totals
+{
+	int64_t minimums;
+	int64_t maximums;
+};
+
+static std::vector<Vector3Int16> MakeSamples()
+{
+	std::mt19937 random(Seed);
+	std::normal_distribution<double> noise(0, 400);
+	std::vector<Vector3Int16> samples(SampleCount);
+
+	for (int i = 0; i < SampleCount; i++)
+	{
+		auto motion = 12000 * std::sin(i * 0.01);
+		auto clamp = [](double v) { return (int16_t)std::clamp(v, (double)-INT16_MAX, (double)INT16_MAX); };
+		samples[i] = { clamp(motion + noise(random)), clamp(noise(random)), clamp(-motion * 0.5 + noise(random)) };
+	}
+
+	return samples;
+}
+
+static Totals RunIncremental(const std::vector<Vector3Int16>& samples, int windowLength, double& seconds)
+{
+	GyroHistory history(windowLength);
+	Totals totals{};
+
+	auto start = std::chrono::steady_clock::now();
+	for (int i = 0; i < SampleCount; i++)
+	{
+		history.Push(samples[i]);
+
+		for (int axis = 0; axis < GyroHistory::AxisCount; axis++)
+		{
+			totals.minimums += history.Min(axis);
+			totals.maximums += history.Max(axis);
+		}
+	}
+	seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	return totals;
+}
+
+// Same queries, recomputed from the contiguous window on every sample
+static Totals RunRecomputed(const std::vector<Vector3Int16>& samples, int windowLength, double& seconds)
+{
+	GyroHistory history(windowLength);
+	Totals totals{};
+
+	auto start = std::chrono::steady_clock::now();
+	for (int i = 0; i < SampleCount; i++)
+	{
+		history.Push(samples[i]);
+		auto count = history.Count();
+
+		for (int axis = 0; axis < GyroHistory::AxisCount; axis++)
+		{
+			auto window = history.Latest(axis, count);
+			int16_t min = INT16_MAX, max = INT16_MIN;
+
+			for (int j = 0; j < count; j++)
+			{
+				min = std::min(min, window[j]);
+				max = std::max(max, window[j]);
+			}
+
+			totals.minimums += min;
+			totals.maximums += max;
+		}
+	}
+	seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	return totals;
+}
+
+int main()
+{
+	auto samples = MakeSamples();
+
+	printf("%d samples, 3 axes, min and max queried after every push\n\n", SampleCount);
+	printf("%8s %18s %18s %9s %8s\n", "window", "incremental ns", "recomputed ns", "speedup", "agree");
+
+	for (auto windowLength : WindowLengths)
+	{
+		double incrementalSeconds, recomputedSeconds;
+		auto incremental = RunIncremental(samples, windowLength, incrementalSeconds);
+		auto recomputed = RunRecomputed(samples, windowLength, recomputedSeconds);
+
+		auto agree = incremental.minimums == recomputed.minimums && incremental.maximums == recomputed.maximums;
+
+		printf("%8d %18.1f %18.1f %8.1fx %8s\n", windowLength,
+			incrementalSeconds * 1e9 / SampleCount,
+			recomputedSeconds * 1e9 / SampleCount,
+			recomputedSeconds / incrementalSeconds,
+			agree ? "yes" : "NO");
+	}
+
+	return 0;
+}
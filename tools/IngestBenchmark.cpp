@@ -0,0 +1,144 @@
+// Compares copying notifications into CircularBuffer in bulk with the old byte by byte loop, which
+// allocated a reader per notification and made a virtual, bounds checked ReadByte call per byte
+// (modelled here on DataReader). Also checks that the bulk write leaves the ring exactly as the
+// byte by byte one does, across wrap-around and notifications longer than the ring.
+//
+// Linux: g++ -std=c++17 -O2 -I../src IngestBenchmark.cpp ../src/CircularBuffer.cpp -o IngestBenchmark
+
+#include "CircularBuffer.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+using Clock = std::chrono::steady_clock;
+
+static constexpr auto Notifications = 2000000;
+static constexpr auto Repeats = 5;
+static constexpr auto CheckRounds = 200000;
+static constexpr uint32_t Seed = 7;
+// One ATT payload at the default MTU, three standard and five extended frames, a full data length extension payload
+static constexpr int NotificationLengths[] = { 20, 21, 65, 244 };
+
+class ByteReader
+{
+public:
+	virtual ~ByteReader() = default;
+	virtual unsigned int UnconsumedBufferLength() const = 0;
+	virtual uint8_t ReadByte() = 0;
+};
+
+class NotificationReader : public ByteReader
+{
+public:
+	NotificationReader(const uint8_t* data, unsigned int length) : data(data), length(length) {}
+
+	unsigned int UnconsumedBufferLength() const override { return length - position; }
+
+	uint8_t ReadByte() override
+	{
+		if (position >= length) throw std::out_of_range("Read past the end of the notification");
+		return data[position++];
+	}
+private:
+	const uint8_t* data;
+	unsigned int length;
+	unsigned int position = 0;
+};
+
+// Called through a volatile pointer so the reader's type stays opaque, as a WinRT object is
+static std::unique_ptr<ByteReader> MakeReader(const uint8_t* data, unsigned int length)
+{
+	return std::make_unique<NotificationReader>(data, length);
+}
+static std::unique_ptr<ByteReader> (*volatile makeReader)(const uint8_t*, unsigned int) = MakeReader;
+
+static void IngestByteByByte(CircularBuffer& buffer, const uint8_t* data, int length)
+{
+	auto reader = makeReader(data, (unsigned int)length);
+	while (reader->UnconsumedBufferLength() > 0)
+	{
+		buffer.WriteBuffer(reader->ReadByte());
+	}
+}
+
+static void IngestBulk(CircularBuffer& buffer, const uint8_t* data, int length)
+{
+	buffer.WriteBuffer(data, length);
+}
+
+// Nothing drains the ring, so later notifications overwrite earlier ones and only the copy is timed
+template <typename Ingest>
+static double NsPerNotification(const std::vector<uint8_t>& stream, int length, Ingest ingest, int& checksum)
+{
+	auto best = 1e9;
+	for (int repeat = 0; repeat < Repeats; repeat++)
+	{
+		CircularBuffer buffer;
+		auto start = Clock::now();
+		size_t offset = 0;
+		for (int i = 0; i < Notifications; i++)
+		{
+			ingest(buffer, &stream[offset], length);
+			offset += (size_t)length;
+			if (offset + (size_t)length > stream.size()) offset = 0;
+		}
+		auto seconds = std::chrono::duration<double>(Clock::now() - start).count();
+		best = std::min(best, seconds * 1e9 / Notifications);
+		checksum += buffer.BufferCount() + buffer.ReadBuffer();
+	}
+	return best;
+}
+
+static bool CheckEquivalence()
+{
+	std::mt19937 random(Seed);
+	std::uniform_int_distribution<int> lengthDistribution(0, BufferLength + BufferLength / 2);
+	std::uniform_int_distribution<int> byteDistribution(0, 255);
+	std::uniform_int_distribution<int> drainDistribution(0, 3);
+
+	CircularBuffer byteByByte, bulk;
+	std::vector<uint8_t> notification(BufferLength * 2);
+	auto isEqual = true;
+
+	for (int round = 0; round < CheckRounds && isEqual; round++)
+	{
+		auto length = lengthDistribution(random);
+		for (int i = 0; i < length; i++) notification[i] = (uint8_t)byteDistribution(random);
+
+		IngestByteByByte(byteByByte, notification.data(), length);
+		IngestBulk(bulk, notification.data(), length);
+		isEqual &= byteByByte.BufferCount() == bulk.BufferCount();
+
+		if (drainDistribution(random) != 0) continue;
+
+		auto count = byteByByte.BufferCount();
+		for (int i = 0; i < count; i++) isEqual &= byteByByte.ReadBuffer() == bulk.ReadBuffer();
+	}
+
+	return isEqual;
+}
+
+int main()
+{
+	std::mt19937 random(Seed);
+	std::vector<uint8_t> stream(1 << 16);
+	for (auto& byte : stream) byte = (uint8_t)random();
+
+	auto isCorrect = CheckEquivalence();
+	printf("%d random notifications, bulk and byte by byte rings %s\n\n", CheckRounds, isCorrect ? "identical" : "DIFFER");
+
+	printf("%-8s %16s %12s %10s\n", "bytes", "byte by byte ns", "bulk ns", "speedup");
+	auto checksum = 0;
+	for (auto length : NotificationLengths)
+	{
+		auto byteByByteNs = NsPerNotification(stream, length, IngestByteByByte, checksum);
+		auto bulkNs = NsPerNotification(stream, length, IngestBulk, checksum);
+		printf("%-8d %16.1f %12.1f %9.1fx\n", length, byteByByteNs, bulkNs, byteByByteNs / bulkNs);
+	}
+
+	return isCorrect && checksum >= 0 ? 0 : 1;
+}
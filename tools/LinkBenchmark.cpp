@@ -0,0 +1,170 @@
+// Measures how PacketParser copes with an impaired link.
+//
+// For each impairment profile a synthetic packet stream is pushed through LinkSimulator into the
+// parser, one notification at a time. Every source packet carries a sequence number and two check
+// fields derived from it, so a parsed packet is either a genuine packet or a false accept (a corrupt
+// packet that still passed the 5-bit signature check).
+//
+// Linux: g++ -std=c++17 -O2 -I../src LinkBenchmark.cpp ../src/LinkSimulator.cpp ../src/PacketParser.cpp
+//            ../src/CircularBuffer.cpp ../src/Logger.cpp ../src/Metrics.cpp ../src/Trace.cpp -o LinkBenchmark -lrt -pthread
+
+#include "LinkSimulator.h"
+#include "Logger.h"
+#include "PacketParser.h"
+#include "PacketSchema.h"
+#include <chrono>
+#include <cstdio>
+#include <vector>
+
+static constexpr auto PacketsPerProfile = 60000; // fits the 16-bit sequence number
+static constexpr auto PacketsPerNotification = 3;
+static constexpr uint32_t Seed = 12345;
+
+static const ImpairmentProfile Profiles[] = {
+	// name, drop, flip, duplicate, burst, max burst, reorder, reorder distance
+	{ "clean", 0, 0, 0, 0, 0, 0, 0 },
+	{ "drop 0.1%", 0.001, 0, 0, 0, 0, 0, 0 },
+	{ "drop 1%", 0.01, 0, 0, 0, 0, 0, 0 },
+	{ "bit flip 0.1%", 0, 0.001, 0, 0, 0, 0, 0 },
+	{ "bit flip 1%", 0, 0.01, 0, 0, 0, 0, 0 },
+	{ "duplicate 0.1%", 0, 0, 0.001, 0, 0, 0, 0 },
+	{ "burst gap 0.05%", 0, 0, 0, 0.0005, 40, 0, 0 },
+	{ "reorder 0.1%", 0, 0, 0, 0, 0, 0.001, 3 },
+	{ "mixed", 0.001, 0.001, 0.0005, 0.0002, 40, 0.0005, 3 },
+};
+
+static Packet MakePacket(uint16_t sequence)
+{
+	Packet packet{};
+	packet.Gyro.X = (int16_t)sequence;
+	packet.Gyro.Y = (int16_t)(sequence * 31 + 7);
+	packet.Gyro.Z = (int16_t)(sequence ^ 0x5a5a);
+	packet.ButtonData = (uint8_t)(PacketSchema::Standard.signature | ((sequence >> 4) & PacketSchema::ButtonMask));
+	return packet;
+}
+
+static bool IsGenuine(const Packet& packet)
+{
+	auto expected = MakePacket((uint16_t)packet.Gyro.X);
+	return packet.Gyro.Y == expected.Gyro.Y && packet.Gyro.Z == expected.Gyro.Z
+		&& packet.ButtonData == (expected.ButtonData & PacketSchema::ButtonMask);
+}
+
+struct ProfileResult
+{
+	uint64_t accepted;
+	uint64_t genuine;
+	uint64_t falseAccepts;
+	uint64_t realignments;
+	uint64_t realignedBytes; // bytes fed between losing and regaining alignment, summed
+	uint64_t unrecovered; // alignment still lost at the end of the run
+	double parseSeconds;
+	LinkStatistics link;
+};
+
+static ProfileResult RunProfile(const ImpairmentProfile& profile)
+{
+	ProfileResult result{};
+	std::vector<bool> recovered(PacketsPerProfile, false);
+
+	CircularBuffer buffer;
+	LinkSimulator link(buffer, profile, Seed);
+
+	PacketParser::SetBuffer(&buffer);
+	PacketParser::ResetDataAlignment();
+	PacketParser::PacketReady = [&](Packet packet) {
+		result.accepted++;
+
+		auto sequence = (uint16_t)packet.Gyro.X;
+		if (!IsGenuine(packet) || sequence >= PacketsPerProfile)
+		{
+			result.falseAccepts++;
+			return;
+		}
+
+		if (!recovered[sequence]) result.genuine++;
+		recovered[sequence] = true;
+	};
+
+	bool wasAligned = false;
+	bool everAligned = false;
+	uint64_t bytesSinceLoss = 0;
+	std::chrono::nanoseconds parseTime{ 0 };
+
+	Packet notification[PacketsPerNotification];
+
+	for (int sequence = 0; sequence < PacketsPerProfile; sequence += PacketsPerNotification)
+	{
+		for (int i = 0; i < PacketsPerNotification; i++)
+		{
+			notification[i] = MakePacket((uint16_t)(sequence + i));
+		}
+
+		auto bytesBefore = link.Statistics().bytesOut;
+		link.Transmit((const uint8_t*)notification, sizeof(notification));
+
+		auto start = std::chrono::steady_clock::now();
+		PacketParser::OnReceivedData();
+		parseTime += std::chrono::steady_clock::now() - start;
+
+		auto isAligned = PacketParser::IsDataAligned();
+		if (!isAligned) bytesSinceLoss += link.Statistics().bytesOut - bytesBefore;
+
+		if (wasAligned && !isAligned)
+		{
+			result.realignments++;
+		}
+		else if (!wasAligned && isAligned && everAligned)
+		{
+			result.realignedBytes += bytesSinceLoss;
+		}
+
+		if (isAligned)
+		{
+			bytesSinceLoss = 0;
+			everAligned = true;
+		}
+
+		wasAligned = isAligned;
+	}
+
+	if (!wasAligned && everAligned) result.unrecovered = 1;
+
+	result.parseSeconds = std::chrono::duration<double>(parseTime).count();
+	result.link = link.Statistics();
+	PacketParser::PacketReady = nullptr;
+
+	return result;
+}
+
+int main()
+{
+	Logger::MinimumLevel = Logger::Level::Error; // the parser logs every realignment
+
+	printf("%d packets per profile, %d packets per notification, seed %u\n\n",
+		PacketsPerProfile, PacketsPerNotification, Seed);
+	printf("%-18s %12s %10s %12s %10s %14s %11s\n",
+		"profile", "Mpackets/s", "recovered", "false accept", "realigns", "bytes/realign", "unrecovered");
+
+	for (const auto& profile : Profiles)
+	{
+		auto result = RunProfile(profile);
+
+		auto packetsPerSecond = result.parseSeconds > 0 ? result.accepted / result.parseSeconds : 0;
+		auto recoveredFraction = (double)result.genuine / PacketsPerProfile;
+		auto falseAcceptRate = result.accepted > 0 ? (double)result.falseAccepts / result.accepted : 0;
+		auto recoveredRealigns = result.realignments - result.unrecovered;
+		auto bytesPerRealign = recoveredRealigns > 0 ? (double)result.realignedBytes / recoveredRealigns : 0;
+
+		printf("%-18s %12.2f %9.2f%% %11.4f%% %10llu %14.1f %11s\n",
+			profile.name,
+			packetsPerSecond / 1e6,
+			recoveredFraction * 100,
+			falseAcceptRate * 100,
+			(unsigned long long)result.realignments,
+			bytesPerRealign,
+			result.unrecovered ? "yes" : "no");
+	}
+
+	return 0;
+}
@@ -0,0 +1,120 @@
+// Measures what a Logger call costs the caller during a realignment burst, when the parser logs
+// "Data misaligned!" and "Data aligned!" back to back, with the writer thread formatting and
+// suppressing repeats behind it. Bursts of 10 to 10000 realignments are logged with a pause
+// between them, and each call is timed on its own. With more records than a ring holds in one
+// burst, calls start to drop records instead of waiting.
+//
+// Afterwards it checks from the log file that every call is accounted for: printed, counted in a
+// "similar suppressed" note, or reported dropped. Standard output is sent to /dev/null while the
+// logger runs.
+//
+// Linux: g++ -std=c++17 -O2 -I../src LoggerBenchmark.cpp ../src/Logger.cpp -o LoggerBenchmark -pthread
+
+#include "Logger.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+using Clock = std::chrono::steady_clock;
+
+static constexpr auto LogPath = "LoggerBenchmark.log";
+static constexpr int BurstSizes[] = { 10, 100, 1000, 10000 };
+static constexpr auto BurstsPerSize = 20;
+static constexpr auto BurstPause = std::chrono::milliseconds(25); // longer than Logger::FlushIntervalMs
+
+static double Percentile(std::vector<double> values, double fraction)
+{
+	std::sort(values.begin(), values.end());
+	return values[std::min(values.size() - 1, (size_t)(fraction * values.size()))];
+}
+
+// What timing an empty call costs, taken off every measurement
+static double ClockOverheadNs()
+{
+	std::vector<double> samples;
+	for (int i = 0; i < 100000; i++)
+	{
+		auto start = Clock::now();
+		samples.push_back(std::chrono::duration<double, std::nano>(Clock::now() - start).count());
+	}
+	return Percentile(samples, 0.5);
+}
+
+// Calls accounted for in the log: lines printed, plus suppressed and dropped counts
+static long long AccountedCalls()
+{
+	auto file = std::fopen(LogPath, "r");
+	if (!file) return -1;
+
+	long long calls = 0;
+	char line[512];
+	while (std::fgets(line, sizeof(line), file))
+	{
+		if (std::strstr(line, "Data misaligned!") || std::strstr(line, "Data aligned!")) calls++;
+		if (auto note = std::strstr(line, "(+")) calls += std::strtoll(note + 2, nullptr, 10);
+		if (auto note = std::strstr(line, "dropped ")) calls += std::strtoll(note + 8, nullptr, 10);
+	}
+	std::fclose(file);
+	return calls;
+}
+
+int main()
+{
+	std::remove(LogPath);
+	auto overheadNs = ClockOverheadNs();
+
+	fflush(stdout);
+	auto savedStdout = dup(STDOUT_FILENO);
+	if (!std::freopen("/dev/null", "w", stdout)) return 1;
+	Logger::Initialize(LogPath);
+
+	struct Row
+	{
+		int burstSize;
+		double p50, p99, max;
+	};
+	std::vector<Row> rows;
+	long long calls = 0;
+
+	for (auto burstSize : BurstSizes)
+	{
+		std::vector<double> callNs;
+		callNs.reserve((size_t)burstSize * 2 * BurstsPerSize);
+		for (int burst = 0; burst < BurstsPerSize; burst++)
+		{
+			for (int i = 0; i < burstSize; i++)
+			{
+				auto start = Clock::now();
+				Logger::Warning("Data misaligned! Attempting to realign...");
+				auto logged = Clock::now();
+				Logger::Info("Data aligned!");
+				auto end = Clock::now();
+				callNs.push_back(std::chrono::duration<double, std::nano>(logged - start).count() - overheadNs);
+				callNs.push_back(std::chrono::duration<double, std::nano>(end - logged).count() - overheadNs);
+			}
+			calls += burstSize * 2;
+			std::this_thread::sleep_for(BurstPause);
+		}
+		rows.push_back({ burstSize, Percentile(callNs, 0.5), Percentile(callNs, 0.99), Percentile(callNs, 1) });
+	}
+
+	Logger::Shutdown();
+	fflush(stdout);
+	dup2(savedStdout, STDOUT_FILENO);
+	close(savedStdout);
+
+	printf("%d bursts per size, %d records per ring, timing overhead %.0f ns taken off\n\n", BurstsPerSize,
+		Logger::RingCapacity, overheadNs);
+	printf("%14s %10s %10s %10s\n", "realignments", "p50 ns", "p99 ns", "max ns");
+	for (auto& row : rows) printf("%14d %10.1f %10.1f %10.1f\n", row.burstSize, row.p50, row.p99, row.max);
+
+	auto accounted = AccountedCalls();
+	std::remove(LogPath);
+	printf("\n%lld calls, %lld accounted for in the log: %s\n", calls, accounted, accounted == calls ? "yes" : "NO");
+	return accounted == calls ? 0 : 1;
+}
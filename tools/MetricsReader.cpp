@@ -0,0 +1,178 @@
+// Samples the live metrics page published by GestureBackend.
+//
+// Usage: MetricsReader [--csv] [--interval <ms>]
+//
+// Linux:   g++ -std=c++17 -O2 -I../src MetricsReader.cpp ../src/Metrics.cpp -o MetricsReader -lrt
+// Windows: cl /std:c++17 /EHsc /I..\src MetricsReader.cpp ..\src\Metrics.cpp
+
+#include "Metrics.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+
+static constexpr auto DefaultIntervalMs = 1000;
+
+struct Sample
+{
+	Metrics::ParserMetrics parser;
+	Metrics::DeviceMetrics device;
+	Metrics::ConnectionMetrics connection;
+	Metrics::InputMetrics input;
+	double seconds;
+};
+
+static const char* ConnectionStateName(Metrics::ConnectionState state)
+{
+	switch (state)
+	{
+	case Metrics::ConnectionState::Disconnected: return "Disconnected";
+	case Metrics::ConnectionState::Scanning: return "Scanning";
+	case Metrics::ConnectionState::Connecting: return "Connecting";
+	case Metrics::ConnectionState::Connected: return "Connected";
+	}
+	return "Unknown";
+}
+
+static bool TakeSample(const Metrics::Page* page, Sample& sample)
+{
+	using namespace std::chrono;
+	sample.seconds = duration<double>(steady_clock::now().time_since_epoch()).count();
+
+	return Metrics::Read(page->parser, sample.parser)
+		&& Metrics::Read(page->device, sample.device)
+		&& Metrics::Read(page->connection, sample.connection)
+		&& Metrics::Read(page->input, sample.input);
+}
+
+static double Rate(uint64_t current, uint64_t previous, double elapsed)
+{
+	return elapsed > 0 ? (double)(current - previous) / elapsed : 0;
+}
+
+static void PrintTop(const Sample& current, const Sample& previous, uint64_t processId)
+{
+	auto elapsed = current.seconds - previous.seconds;
+
+	printf("\033[H\033[2J");
+	printf("GestureBackend (pid %llu)  connection: %s  attempts: %u\n\n", (unsigned long long)processId,
+		ConnectionStateName(current.connection.state), current.connection.connectionAttempts);
+
+	printf("%-24s %14s %12s\n", "", "total", "per second");
+	printf("%-24s %14llu %12.1f\n", "notifications", (unsigned long long)current.device.notifications,
+		Rate(current.device.notifications, previous.device.notifications, elapsed));
+	printf("%-24s %14llu %12.1f\n", "bytes received", (unsigned long long)current.device.bytesReceived,
+		Rate(current.device.bytesReceived, previous.device.bytesReceived, elapsed));
+	printf("%-24s %14llu %12.1f\n", "packets parsed", (unsigned long long)current.parser.packets,
+		Rate(current.parser.packets, previous.parser.packets, elapsed));
+	printf("%-24s %14llu %12.1f\n", "realignments", (unsigned long long)current.parser.realignments,
+		Rate(current.parser.realignments, previous.parser.realignments, elapsed));
+	printf("%-24s %14llu %12.1f\n", "backlog dropped bytes", (unsigned long long)current.parser.backlogDroppedBytes,
+		Rate(current.parser.backlogDroppedBytes, previous.parser.backlogDroppedBytes, elapsed));
+	printf("%-24s %14llu %12.1f\n", "control responses", (unsigned long long)current.parser.controlResponses,
+		Rate(current.parser.controlResponses, previous.parser.controlResponses, elapsed));
+	printf("%-24s %14llu %12.1f\n", "packets processed", (unsigned long long)current.input.packetsProcessed,
+		Rate(current.input.packetsProcessed, previous.input.packetsProcessed, elapsed));
+	printf("%-24s %14llu %12.1f\n", "moves", (unsigned long long)current.input.moves,
+		Rate(current.input.moves, previous.input.moves, elapsed));
+	printf("%-24s %14llu %12.1f\n", "clicks", (unsigned long long)current.input.clicks,
+		Rate(current.input.clicks, previous.input.clicks, elapsed));
+	printf("%-24s %14llu %12.1f\n", "scrolls", (unsigned long long)current.input.scrolls,
+		Rate(current.input.scrolls, previous.input.scrolls, elapsed));
+	printf("%-24s %14llu %12.1f\n", "idle packets", (unsigned long long)current.input.idlePackets,
+		Rate(current.input.idlePackets, previous.input.idlePackets, elapsed));
+	printf("%-24s %14llu %12.1f\n", "SendInput failures", (unsigned long long)current.input.sendInputFailures,
+		Rate(current.input.sendInputFailures, previous.input.sendInputFailures, elapsed));
+
+	printf("\nbacklog: %u bytes  aligned: %s\n", current.parser.backlogBytes, current.parser.isAligned ? "yes" : "no");
+	fflush(stdout);
+}
+
+static void PrintCsvHeader()
+{
+	printf("time,connection,notifications,bytes_received,packets,realignments,backlog_dropped_bytes,"
+		"backlog_bytes,aligned,packets_processed,moves,clicks,scrolls,send_input_failures,idle_packets,control_responses\n");
+}
+
+static void PrintCsv(const Sample& sample)
+{
+	printf("%.6f,%s,%llu,%llu,%llu,%llu,%llu,%u,%u,%llu,%llu,%llu,%llu,%llu,%llu,%llu\n",
+		sample.seconds,
+		ConnectionStateName(sample.connection.state),
+		(unsigned long long)sample.device.notifications,
+		(unsigned long long)sample.device.bytesReceived,
+		(unsigned long long)sample.parser.packets,
+		(unsigned long long)sample.parser.realignments,
+		(unsigned long long)sample.parser.backlogDroppedBytes,
+		sample.parser.backlogBytes,
+		sample.parser.isAligned,
+		(unsigned long long)sample.input.packetsProcessed,
+		(unsigned long long)sample.input.moves,
+		(unsigned long long)sample.input.clicks,
+		(unsigned long long)sample.input.scrolls,
+		(unsigned long long)sample.input.sendInputFailures,
+		(unsigned long long)sample.input.idlePackets,
+		(unsigned long long)sample.parser.controlResponses);
+	fflush(stdout);
+}
+
+int main(int argc, char* argv[])
+{
+	bool csv = false;
+	int intervalMs = DefaultIntervalMs;
+
+	for (int i = 1; i < argc; i++)
+	{
+		if (strcmp(argv[i], "--csv") == 0)
+		{
+			csv = true;
+		}
+		else if (strcmp(argv[i], "--interval") == 0 && i + 1 < argc)
+		{
+			intervalMs = atoi(argv[++i]);
+			if (intervalMs <= 0) intervalMs = DefaultIntervalMs;
+		}
+		else
+		{
+			fprintf(stderr, "Usage: %s [--csv] [--interval <ms>]\n", argv[0]);
+			return 1;
+		}
+	}
+
+	auto page = Metrics::OpenReaderPage();
+	if (page == nullptr)
+	{
+		fprintf(stderr, "GestureBackend metrics page not found. Is the backend running?\n");
+		return 1;
+	}
+
+	if (csv) PrintCsvHeader();
+
+	Sample previous{};
+	bool hasPrevious = false;
+
+	while (page->magic == Metrics::PageMagic)
+	{
+		Sample current{};
+
+		// The writer was mid-update on every attempt, try again next tick
+		if (TakeSample(page, current))
+		{
+			if (csv)
+				PrintCsv(current);
+			else if (hasPrevious)
+				PrintTop(current, previous, page->processId);
+
+			previous = current;
+			hasPrevious = true;
+		}
+
+		std::this_thread::sleep_for(std::chrono::milliseconds(intervalMs));
+	}
+
+	fprintf(stderr, "GestureBackend exited\n");
+
+	Metrics::ClosePage();
+	return 0;
+}
@@ -0,0 +1,173 @@
+// Checks OrientationFilter against rotation traces with a known orientation and measures what it
+// costs per sample. Each trace is a 60 s body rate signal at 100 Hz; the true orientation is
+// integrated from it in double precision with fine substeps, and the filter gets the sampled rate
+// and gravity as the remote would measure it at that orientation.
+//
+// Reported per trace: the tilt error (angle between the true and estimated gravity direction,
+// which the accelerometer corrects) and the pointing error (angle between the true and estimated
+// pointing axis, which includes yaw drift the filter cannot correct), mean and maximum, and the
+// filter's cost in ns per sample. The last trace adds a gyro bias of a degree per second on every
+// axis, which FusionBeta only partly corrects: tilt lags behind it and yaw drifts freely.
+//
+// Linux: g++ -std=c++17 -O2 -I../src OrientationBenchmark.cpp ../src/OrientationFilter.cpp -o OrientationBenchmark
+
+#include "Input.h"
+#include "OrientationFilter.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+using Clock = std::chrono::steady_clock;
+
+static constexpr auto SampleRateHz = 100;
+static constexpr auto TraceSeconds = 60;
+static constexpr auto Substeps = 20; // per sample, for the true orientation
+static constexpr auto Pi = 3.14159265358979;
+static constexpr auto RadiansPerDegree = Pi / 180;
+static constexpr auto MaxTiltErrorDegrees = 2.0; // without bias
+static constexpr auto TimedRuns = 50;
+
+struct Rotation
+{
+	double w, x, y, z;
+
+	// Rotates v from the body frame into the world frame
+	void Apply(const double v[3], double out[3]) const
+	{
+		double cx = y * v[2] - z * v[1], cy = z * v[0] - x * v[2], cz = x * v[1] - y * v[0];
+		out[0] = v[0] + 2 * (w * cx + y * cz - z * cy);
+		out[1] = v[1] + 2 * (w * cy + z * cx - x * cz);
+		out[2] = v[2] + 2 * (w * cz + x * cy - y * cx);
+	}
+
+	// Turns by a body frame rate over dt, exactly for a constant rate
+	void Turn(const double rate[3], double dt)
+	{
+		auto speed = std::sqrt(rate[0] * rate[0] + rate[1] * rate[1] + rate[2] * rate[2]);
+		if (speed == 0) return;
+		auto half = speed * dt / 2;
+		auto s = std::sin(half) / speed;
+		double dw = std::cos(half), dx = rate[0] * s, dy = rate[1] * s, dz = rate[2] * s;
+		*this = {
+			w * dw - x * dx - y * dy - z * dz,
+			w * dx + x * dw + y * dz - z * dy,
+			w * dy - x * dz + y * dw + z * dx,
+			w * dz + x * dy - y * dx + z * dw
+		};
+	}
+};
+
+struct Trace
+{
+	const char* name;
+	double amplitudeDegrees[3]; // body rate amplitude per axis, degrees per second
+	double frequencyHz[3];
+	double noiseDegrees; // gyro noise per sample, degrees per second
+	double biasDegrees; // constant gyro bias on every axis
+};
+
+static const Trace Traces[] = {
+	{ "rest", { 0, 0, 0 }, { 0, 0, 0 }, 0, 0 },
+	{ "yaw sweep", { 0, 0, 90 }, { 0, 0, 0.5 }, 0, 0 },
+	{ "pitch nod", { 60, 0, 0 }, { 0.7, 0, 0 }, 0, 0 },
+	{ "three axis pointing", { 50, 25, 80 }, { 0.8, 0.3, 0.4 }, 0, 0 },
+	{ "three axis, noise", { 50, 25, 80 }, { 0.8, 0.3, 0.4 }, 0.5, 0 },
+	{ "three axis, noise + bias", { 50, 25, 80 }, { 0.8, 0.3, 0.4 }, 0.5, 1.0 },
+};
+
+static double AngleDegrees(const double a[3], const Vector3& b)
+{
+	auto dot = a[0] * b.X + a[1] * b.Y + a[2] * b.Z;
+	auto norm = std::sqrt(b.X * b.X + b.Y * b.Y + b.Z * b.Z);
+	return std::acos(std::clamp(dot / norm, -1.0, 1.0)) / RadiansPerDegree;
+}
+
+int main()
+{
+	constexpr auto Samples = SampleRateHz * TraceSeconds;
+	constexpr auto Dt = 1.0 / SampleRateHz;
+
+	printf("%d s traces at %d Hz, beta %.3f\n\n", TraceSeconds, SampleRateHz, Input::FusionBeta);
+	printf("%-26s %12s %12s %12s %12s %10s\n", "", "tilt mean", "tilt max", "point mean", "point max", "ns/sample");
+
+	auto isAccurate = true;
+	for (auto& trace : Traces)
+	{
+		std::mt19937 random(1);
+		std::normal_distribution<double> noise(0, trace.noiseDegrees * RadiansPerDegree + 1e-12);
+
+		// Sampled inputs and the true orientation after each sample
+		std::vector<Vector3> gyro(Samples), acceleration(Samples);
+		std::vector<Rotation> truth(Samples);
+		Rotation rotation{ 1, 0, 0, 0 };
+		for (int i = 0; i < Samples; i++)
+		{
+			double rate[3];
+			for (int sub = 0; sub < Substeps; sub++)
+			{
+				auto t = (i + (sub + 0.5) / Substeps) * Dt;
+				for (int axis = 0; axis < 3; axis++)
+				{
+					rate[axis] = trace.amplitudeDegrees[axis] * RadiansPerDegree * std::sin(2 * Pi * trace.frequencyHz[axis] * t);
+				}
+				rotation.Turn(rate, Dt / Substeps);
+			}
+			truth[i] = rotation;
+
+			// The remote samples the rate at the end of the period and gravity where it ended up
+			auto t = (i + 1) * Dt;
+			for (int axis = 0; axis < 3; axis++)
+			{
+				rate[axis] = trace.amplitudeDegrees[axis] * RadiansPerDegree * std::sin(2 * Pi * trace.frequencyHz[axis] * t)
+					+ trace.biasDegrees * RadiansPerDegree + noise(random);
+			}
+			gyro[i] = { (float)rate[0], (float)rate[1], (float)rate[2] };
+
+			const double up[3] = { 0, 0, 1 };
+			double gravity[3];
+			Rotation{ rotation.w, -rotation.x, -rotation.y, -rotation.z }.Apply(up, gravity);
+			acceleration[i] = { (float)gravity[0], (float)gravity[1], (float)gravity[2] };
+		}
+
+		OrientationFilter filter(Input::FusionBeta);
+		filter.Update({ 0, 0, 0 }, { 0, 0, 1 }, 0); // starts level, like the truth
+
+		double tiltSum = 0, tiltMax = 0, pointSum = 0, pointMax = 0;
+		for (int i = 0; i < Samples; i++)
+		{
+			filter.Update(gyro[i], acceleration[i], (float)Dt);
+
+			const double up[3] = { 0, 0, 1 }, forward[3] = { 0, 1, 0 };
+			double trueUp[3], trueForward[3];
+			truth[i].Apply(up, trueUp);
+			truth[i].Apply(forward, trueForward);
+
+			auto tilt = AngleDegrees(trueUp, filter.Rotate({ 0, 0, 1 }));
+			auto point = AngleDegrees(trueForward, filter.Rotate({ 0, 1, 0 }));
+			tiltSum += tilt;
+			pointSum += point;
+			tiltMax = std::max(tiltMax, tilt);
+			pointMax = std::max(pointMax, point);
+		}
+
+		auto start = Clock::now();
+		for (int run = 0; run < TimedRuns; run++)
+		{
+			filter.Reset();
+			for (int i = 0; i < Samples; i++) filter.Update(gyro[i], acceleration[i], (float)Dt);
+		}
+		auto ns = std::chrono::duration<double, std::nano>(Clock::now() - start).count() / ((double)TimedRuns * Samples);
+		volatile auto sink = filter.Orientation().W;
+		(void)sink;
+
+		printf("%-26s %12.3f %12.3f %12.3f %12.3f %10.1f\n", trace.name, tiltSum / Samples, tiltMax, pointSum / Samples, pointMax, ns);
+		if (trace.biasDegrees == 0 && tiltMax > MaxTiltErrorDegrees) isAccurate = false;
+	}
+
+	printf("\nerrors in degrees; tilt within %.1f degrees on every trace without bias: %s\n", MaxTiltErrorDegrees,
+		isAccurate ? "yes" : "NO");
+	return isAccurate ? 0 : 1;
+}
@@ -0,0 +1,152 @@
+// Measures what PlotFeed::Push costs the input thread with no reader, with a plot window reading
+// at its frame rate, and with a reader polling as fast as it can. Pushes a ramp so that the reader
+// can check every column it copies, and checks Decimate against a direct scan.
+//
+// Linux: g++ -std=c++17 -O2 -I../src PlotBenchmark.cpp ../src/PlotFeed.cpp -o PlotBenchmark -pthread
+
+#include "PlotFeed.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <random>
+#include <thread>
+#include <vector>
+
+using Clock = std::chrono::steady_clock;
+
+static constexpr auto Samples = 8000000; // a ramp stays exact in float up to 2^24
+static constexpr auto Repeats = 5;
+static constexpr auto ReadColumns = 1024;
+static constexpr auto PlotWidth = 412;
+static constexpr auto FrameIntervalMs = 33;
+
+enum class ReaderLoad
+{
+	None,
+	Frames,
+	Flat
+};
+
+struct ReaderResult
+{
+	uint64_t reads = 0;
+	uint64_t columns = 0;
+	bool isConsistent = true;
+};
+
+// Column c of a ramp holds samples SamplesPerColumn * c onwards on every channel
+static bool IsRampColumn(const PlotFeed::Column& column)
+{
+	auto first = column.minimum[0];
+	for (int channel = 0; channel < PlotFeed::ChannelCount; channel++)
+	{
+		if (column.minimum[channel] != first || column.maximum[channel] != first + PlotFeed::SamplesPerColumn - 1) return false;
+	}
+	return (int64_t)first % PlotFeed::SamplesPerColumn == 0;
+}
+
+static void Read(const PlotFeed& feed, ReaderLoad load, const std::atomic<bool>& isStopping, ReaderResult& result)
+{
+	std::vector<PlotFeed::Column> columns, decimated;
+	while (!isStopping.load(std::memory_order_relaxed))
+	{
+		feed.Read(columns, ReadColumns);
+		for (size_t i = 0; i < columns.size(); i++)
+		{
+			result.isConsistent &= IsRampColumn(columns[i]);
+			if (i > 0) result.isConsistent &= columns[i].minimum[0] > columns[i - 1].minimum[0];
+		}
+		PlotFeed::Decimate(columns, PlotWidth, decimated);
+
+		result.reads++;
+		result.columns += columns.size();
+
+		if (load == ReaderLoad::Frames) std::this_thread::sleep_for(std::chrono::milliseconds(FrameIntervalMs));
+		else std::this_thread::yield(); // on a single core the input thread still gets to run
+	}
+}
+
+static double Run(ReaderLoad load, ReaderResult& result)
+{
+	auto best = 1e9;
+	for (int repeat = 0; repeat < Repeats; repeat++)
+	{
+		auto feed = std::make_unique<PlotFeed>();
+		std::atomic<bool> isStopping{ false };
+		std::thread reader;
+		if (load != ReaderLoad::None) reader = std::thread(Read, std::cref(*feed), load, std::cref(isStopping), std::ref(result));
+
+		auto start = Clock::now();
+		for (int i = 0; i < Samples; i++)
+		{
+			auto value = (float)i;
+			feed->Push({ value, value, value, value, value, value, value });
+		}
+		auto seconds = std::chrono::duration<double>(Clock::now() - start).count();
+		best = std::min(best, seconds * 1e9 / Samples);
+
+		isStopping = true;
+		if (reader.joinable()) reader.join();
+	}
+	return best;
+}
+
+static bool CheckDecimate()
+{
+	std::mt19937 random(3);
+	std::uniform_real_distribution<float> value(-500, 500);
+	auto isCorrect = true;
+
+	for (int count : { 1, 7, 411, 412, 413, 1024, 2048 })
+	{
+		std::vector<PlotFeed::Column> columns(count), decimated;
+		for (auto& column : columns)
+		{
+			for (int channel = 0; channel < PlotFeed::ChannelCount; channel++)
+			{
+				auto a = value(random), b = value(random);
+				column.minimum[channel] = std::min(a, b);
+				column.maximum[channel] = std::max(a, b);
+			}
+		}
+
+		PlotFeed::Decimate(columns, PlotWidth, decimated);
+		isCorrect &= (int)decimated.size() == std::min(count, PlotWidth);
+
+		// Every source column belongs to exactly one bucket, and the extremes survive
+		for (int channel = 0; channel < PlotFeed::ChannelCount; channel++)
+		{
+			auto minimum = 1e9f, maximum = -1e9f, decimatedMinimum = 1e9f, decimatedMaximum = -1e9f;
+			for (auto& column : columns) minimum = std::min(minimum, column.minimum[channel]), maximum = std::max(maximum, column.maximum[channel]);
+			for (auto& column : decimated) decimatedMinimum = std::min(decimatedMinimum, column.minimum[channel]), decimatedMaximum = std::max(decimatedMaximum, column.maximum[channel]);
+			isCorrect &= minimum == decimatedMinimum && maximum == decimatedMaximum;
+		}
+	}
+
+	return isCorrect;
+}
+
+int main()
+{
+	printf("%u hardware threads, %d samples per column, %d columns kept\n\n",
+		std::thread::hardware_concurrency(), PlotFeed::SamplesPerColumn, PlotFeed::Capacity);
+	printf("%-22s %10s %10s %14s %12s\n", "reader", "push ns", "reads", "columns read", "consistent");
+
+	auto isCorrect = true;
+	const char* names[] = { "none", "30 frames/s", "flat out" };
+	for (auto load : { ReaderLoad::None, ReaderLoad::Frames, ReaderLoad::Flat })
+	{
+		ReaderResult result;
+		auto ns = Run(load, result);
+		isCorrect &= result.isConsistent;
+		printf("%-22s %10.2f %10llu %14llu %12s\n", names[(int)load], ns,
+			(unsigned long long)result.reads, (unsigned long long)result.columns, result.isConsistent ? "yes" : "NO");
+	}
+
+	auto isDecimateCorrect = CheckDecimate();
+	printf("\ndecimation keeps every extreme: %s\n", isDecimateCorrect ? "yes" : "NO");
+
+	return isCorrect && isDecimateCorrect ? 0 : 1;
+}
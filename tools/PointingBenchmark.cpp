@@ -0,0 +1,467 @@
+// End-to-end pointing benchmark. A simulated hand performs Fitts's law target acquisition through the
+// whole pipeline: SimulatedRemote encodes its rotation into packets, which are batched per BLE
+// connection event, delayed, parsed by PacketParser and turned into cursor motion by Input on the
+// virtual pointer, with RemoteControl and usage mode changes in the loop.
+//
+// The hand sees the cursor a visual reaction time late and steers it towards the target with a
+// delayed proportional controller, the classic model that yields Fitts's law. It maps the cursor
+// velocity it wants to a rotation through the default response curve at the default sample rate,
+// adds signal-dependent motor noise and tremor, and clicks once the cursor has looked settled on
+// the target for a moment. Everything runs on a virtual clock, so the results other than CPU cost are
+// a function of the seed alone.
+//
+// Reported per scenario: effective throughput (ISO 9241-9, from the spread of click points along
+// the task axis), mean movement time, clicks outside the target, trials that timed out, and the CPU
+// time the parser and Input spend per packet.
+//
+// Linux: g++ -std=c++17 -O2 -I../src PointingBenchmark.cpp ../src/SimulatedRemote.cpp ../src/RemoteControl.cpp
+//            ../src/PacketParser.cpp ../src/CircularBuffer.cpp ../src/Input.cpp ../src/PointerOutput.cpp
+//            ../src/IdleDetector.cpp ../src/OrientationFilter.cpp ../src/MotionPredictor.cpp ../src/GyroHistory.cpp
+//            ../src/Logger.cpp ../src/Metrics.cpp ../src/NetworkOutput.cpp ../src/PacketBroadcast.cpp ../src/Trace.cpp
+//            ../src/PlotFeed.cpp ../src/ResponseCurve.cpp ../src/ButtonMapper.cpp ../src/ClickStabilizer.cpp
+//            ../src/Startup.cpp ../src/ProcessInfo.cpp -o PointingBenchmark -lrt -pthread
+//
+// Usage: PointingBenchmark [--seed n] [--trials n per distance and width]
+
+#include "CircularBuffer.h"
+#include "Input.h"
+#include "Logger.h"
+#include "PacketParser.h"
+#include "Pipeline.h"
+#include "PointerOutput.h"
+#include "RemoteControl.h"
+#include "SimulatedRemote.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <functional>
+#include <random>
+#include <vector>
+
+using Clock = std::chrono::steady_clock;
+
+static constexpr double Distances[] = { 256, 512, 1024 }; // pixels
+static constexpr double Widths[] = { 16, 32, 64 }; // target diameters
+static constexpr auto ScreenMargin = 40.0;
+
+// Hand model
+static constexpr auto ReactionMs = 100.0; // visual feedback delay, on top of the transport's
+static constexpr auto AimingGain = 6.0; // per second: wanted cursor velocity per pixel of seen error
+static constexpr auto MaxCursorSpeed = 4000.0; // pixels per second
+static constexpr auto MotorNoiseMs = 50.0; // correlation time of the signal-dependent noise
+static constexpr auto TremorHz = 9.0;
+static constexpr auto SensorNoise = 0.3; // degrees per second, white
+static constexpr auto SettledSpeed = 60.0; // pixels per second the cursor must look slower than to click
+static constexpr auto DwellMs = 60.0;
+static constexpr auto ClickMs = 100.0; // button held down
+static constexpr auto PauseMs = 300.0; // between a release and the next target
+static constexpr auto TimeoutMs = 5000.0;
+static constexpr auto HandStepMs = 1.0;
+static constexpr auto SettleSeconds = 1.0; // still hand after connecting, for alignment and format changes
+
+struct Scenario
+{
+	const char* name;
+	double connectionIntervalMs;
+	double latencyMs; // from a sample to the connection event that may carry it, beyond batching
+	double motorNoise; // standard deviation as a share of the commanded rate
+	double tremor; // peak degrees per second
+};
+
+static const Scenario Scenarios[] = {
+	{ "ideal", 7.5, 0, 0, 0 },
+	{ "typical", 15, 10, 0.05, 1.0 },
+	{ "noisy hand", 15, 10, 0.15, 3.0 },
+	{ "slow link", 30, 40, 0.05, 1.0 },
+	{ "slow link, noisy hand", 30, 40, 0.15, 3.0 },
+};
+
+// What Pipeline::Connect needs from a transport, driven synchronously on the virtual clock
+struct BenchmarkTransport
+{
+	std::function<void()> Connected;
+	std::function<void()> Disconnected;
+	std::function<void()> ReceivedData;
+
+	CircularBuffer buffer;
+	SimulatedRemote* remote = nullptr;
+
+	bool Write(const uint8_t* data, size_t length)
+	{
+		return remote->Receive(data, length);
+	}
+};
+
+struct Sighting
+{
+	double timeMs;
+	float x;
+	float y;
+};
+
+struct TrialResult
+{
+	double distance;
+	double width;
+	double movementMs;
+	double along; // click point along the task axis, relative to the target centre
+	bool isHit;
+	bool isTimedOut;
+};
+
+struct ScenarioResult
+{
+	std::vector<TrialResult> trials;
+	uint64_t packets = 0;
+	double pipelineSeconds = 0;
+};
+
+class Simulation
+{
+public:
+	Simulation(const Scenario& scenario, uint32_t seed) :
+		scenario(scenario),
+		random(seed),
+		remote([this](const uint8_t* data, size_t length) { OnTransmit(data, length); }, seed),
+		remoteControl([this](const uint8_t* data, size_t length) { return transport.Write(data, length); })
+	{
+		transport.remote = &remote;
+		Pipeline::Connect(transport, remoteControl);
+
+		// Observe what Input is handed, after it has handled it
+		auto forward = PacketParser::PacketReady;
+		PacketParser::PacketReady = [this, forward](Packet packet) {
+			forward(packet);
+			OnPacket(packet.ButtonData);
+		};
+		auto forwardExtended = PacketParser::ExtendedPacketReady;
+		PacketParser::ExtendedPacketReady = [this, forwardExtended](ExtendedPacket packet) {
+			forwardExtended(packet);
+			OnPacket(packet.ButtonData);
+		};
+
+		std::uniform_real_distribution<double> phase(0, 2 * 3.14159265358979);
+		tremorPhaseX = phase(random);
+		tremorPhaseZ = phase(random);
+
+		transport.Connected();
+		Advance(SettleSeconds * 1000, 0, 0, 0);
+	}
+
+	~Simulation()
+	{
+		transport.Disconnected();
+		PacketParser::SetBuffer(nullptr);
+	}
+
+	TrialResult Trial(double distance, double width)
+	{
+		float startX, startY;
+		PointerOutput::CursorPosition(startX, startY);
+
+		// A target at the given distance that stays on screen
+		std::uniform_real_distribution<double> angle(0, 2 * 3.14159265358979);
+		double targetX, targetY;
+		do
+		{
+			auto direction = angle(random);
+			targetX = startX + distance * std::cos(direction);
+			targetY = startY + distance * std::sin(direction);
+		} while (targetX < ScreenMargin || targetX > PointerOutput::ScreenWidth() - ScreenMargin
+			|| targetY < ScreenMargin || targetY > PointerOutput::ScreenHeight() - ScreenMargin);
+
+		TrialResult result{ distance, width, 0, 0, false, false };
+		auto start = nowMs;
+		double settledMs = 0;
+		isClickPending = false;
+
+		while (true)
+		{
+			if (nowMs - start > TimeoutMs)
+			{
+				result.isTimedOut = true;
+				result.movementMs = TimeoutMs;
+				break;
+			}
+
+			Sighting seen, before;
+			Seen(nowMs - ReactionMs, seen);
+			Seen(nowMs - ReactionMs - DwellMs / 2, before);
+			auto errorX = targetX - seen.x, errorY = targetY - seen.y;
+			auto seenSpeed = std::hypot(seen.x - before.x, seen.y - before.y) / (DwellMs / 2000);
+
+			auto isOnTarget = std::hypot(errorX, errorY) <= width / 2 && seenSpeed < SettledSpeed;
+			settledMs = isOnTarget ? settledMs + HandStepMs : 0;
+			if (settledMs >= DwellMs) break;
+
+			auto velocityX = errorX * AimingGain, velocityY = errorY * AimingGain;
+			auto speed = std::hypot(velocityX, velocityY);
+			if (speed > MaxCursorSpeed) velocityX *= MaxCursorSpeed / speed, velocityY *= MaxCursorSpeed / speed;
+
+			Step(velocityX, velocityY, 0);
+		}
+
+		if (result.isTimedOut) return result;
+
+		// Press: the click lands wherever Input has the cursor when it handles the press
+		isClickPending = true;
+		auto pressEnd = nowMs + ClickMs;
+		while (nowMs < pressEnd || isClickPending) Step(0, 0, Input::LeftMask);
+		result.movementMs = clickMs - start;
+
+		auto pauseEnd = nowMs + PauseMs;
+		while (nowMs < pauseEnd) Step(0, 0, 0);
+
+		// Signed distance along the task axis, positive past the target centre
+		auto axisX = targetX - startX, axisY = targetY - startY;
+		auto length = std::hypot(axisX, axisY);
+		result.along = ((clickX - targetX) * axisX + (clickY - targetY) * axisY) / length;
+		result.isHit = std::hypot(clickX - targetX, clickY - targetY) <= width / 2;
+		return result;
+	}
+
+	uint64_t PacketCount() const { return packetCount; }
+	double PipelineSeconds() const { return pipelineSeconds; }
+private:
+	struct Transmission
+	{
+		double readyMs;
+		std::vector<uint8_t> bytes;
+	};
+
+	const Scenario& scenario;
+	std::mt19937 random;
+	std::normal_distribution<double> gaussian{ 0, 1 };
+
+	SimulatedRemote remote;
+	RemoteControl::Controller remoteControl;
+	BenchmarkTransport transport;
+
+	double nowMs = 0;
+	double nextSampleMs = 0;
+	double nextEventMs = 0;
+	std::deque<Transmission> inFlight;
+	std::vector<uint8_t> notification;
+
+	std::vector<Sighting> sightings; // cursor after every notification
+	double motorNoiseX = 0, motorNoiseZ = 0;
+	double tremorPhaseX = 0, tremorPhaseZ = 0;
+
+	uint8_t previousButtons = 0;
+	bool isClickPending = false;
+	double clickMs = 0;
+	float clickX = 0, clickY = 0;
+
+	uint64_t packetCount = 0;
+	double pipelineSeconds = 0;
+
+	void OnTransmit(const uint8_t* data, size_t length)
+	{
+		inFlight.push_back({ nowMs + scenario.latencyMs, std::vector<uint8_t>(data, data + length) });
+	}
+
+	void OnPacket(uint8_t buttons)
+	{
+		packetCount++;
+		if ((buttons & Input::LeftMask) && !(previousButtons & Input::LeftMask) && isClickPending)
+		{
+			PointerOutput::CursorPosition(clickX, clickY);
+			clickMs = nowMs;
+			isClickPending = false;
+		}
+		previousButtons = buttons;
+	}
+
+	void Seen(double timeMs, Sighting& seen) const
+	{
+		auto after = std::upper_bound(sightings.begin(), sightings.end(), timeMs,
+			[](double time, const Sighting& sighting) { return time < sighting.timeMs; });
+		if (after == sightings.begin())
+		{
+			seen = { timeMs, (float)PointerOutput::ScreenWidth() / 2, (float)PointerOutput::ScreenHeight() / 2 };
+			return;
+		}
+		seen = *(after - 1);
+	}
+
+	// Inverse of the default curve: the gain the hand has learned, the same at any sample rate
+	static double RateFor(double pixelsPerSecond)
+	{
+		auto curve = Input::DefaultResponseCurve;
+		auto perSample = std::abs(pixelsPerSecond) / ResponseCurve::ReferenceSampleRateHz;
+		if (perSample == 0) return 0;
+		auto rate = std::pow(perSample * curve.mouseSensitivity, 1 / curve.mousePowerFactor) + curve.mouseDeadZone;
+		return pixelsPerSecond < 0 ? -rate : rate;
+	}
+
+	// Advances the clock by one hand step while the hand asks for this cursor velocity
+	void Step(double velocityX, double velocityY, uint8_t buttons)
+	{
+		// Input moves right for negative Z and down for positive X
+		auto rateZ = -RateFor(velocityX), rateX = RateFor(velocityY);
+
+		auto decay = std::exp(-HandStepMs / MotorNoiseMs);
+		auto spread = std::sqrt(1 - decay * decay);
+		motorNoiseX = motorNoiseX * decay + spread * gaussian(random);
+		motorNoiseZ = motorNoiseZ * decay + spread * gaussian(random);
+		rateX *= 1 + scenario.motorNoise * motorNoiseX;
+		rateZ *= 1 + scenario.motorNoise * motorNoiseZ;
+
+		auto tremorAngle = 2 * 3.14159265358979 * TremorHz * nowMs / 1000;
+		rateX += scenario.tremor * std::sin(tremorAngle + tremorPhaseX);
+		rateZ += scenario.tremor * std::sin(tremorAngle + tremorPhaseZ);
+
+		Advance(HandStepMs, rateX, rateZ, buttons);
+	}
+
+	void Advance(double durationMs, double rateX, double rateZ, uint8_t buttons)
+	{
+		auto endMs = nowMs + durationMs;
+		while (std::min(nextSampleMs, nextEventMs) <= endMs)
+		{
+			nowMs = std::min(nextSampleMs, nextEventMs);
+
+			if (nowMs == nextSampleMs)
+			{
+				Vector3 rates{ (float)(rateX + SensorNoise * gaussian(random)), (float)(SensorNoise * gaussian(random)),
+					(float)(rateZ + SensorNoise * gaussian(random)) };
+				remote.Step(rates, buttons);
+				nextSampleMs += 1000.0 / remote.Configuration().sampleRateHz;
+			}
+
+			if (nowMs == nextEventMs)
+			{
+				ConnectionEvent();
+				nextEventMs += scenario.connectionIntervalMs;
+			}
+		}
+		nowMs = endMs;
+	}
+
+	// Everything ready by now goes out in one notification
+	void ConnectionEvent()
+	{
+		notification.clear();
+		while (!inFlight.empty() && inFlight.front().readyMs <= nowMs)
+		{
+			notification.insert(notification.end(), inFlight.front().bytes.begin(), inFlight.front().bytes.end());
+			inFlight.pop_front();
+		}
+		if (notification.empty()) return;
+
+		transport.buffer.WriteBuffer(notification.data(), (int)notification.size());
+		auto start = Clock::now();
+		transport.ReceivedData();
+		pipelineSeconds += std::chrono::duration<double>(Clock::now() - start).count();
+
+		float x, y;
+		PointerOutput::CursorPosition(x, y);
+		sightings.push_back({ nowMs, x, y });
+	}
+};
+
+static ScenarioResult Run(const Scenario& scenario, uint32_t seed, int trialsPerCondition)
+{
+	struct Condition
+	{
+		double distance;
+		double width;
+	};
+
+	std::vector<Condition> conditions;
+	for (auto distance : Distances)
+	{
+		for (auto width : Widths)
+		{
+			for (int i = 0; i < trialsPerCondition; i++) conditions.push_back({ distance, width });
+		}
+	}
+	std::mt19937 order(seed);
+	std::shuffle(conditions.begin(), conditions.end(), order);
+
+	ScenarioResult result;
+	Simulation simulation(scenario, seed);
+	for (auto& condition : conditions) result.trials.push_back(simulation.Trial(condition.distance, condition.width));
+	result.packets = simulation.PacketCount();
+	result.pipelineSeconds = simulation.PipelineSeconds();
+	return result;
+}
+
+// ISO 9241-9 effective throughput: per distance and width, the effective width is 4.133 standard
+// deviations of the click points along the task axis
+static double Throughput(const std::vector<TrialResult>& trials)
+{
+	double sum = 0;
+	int conditionCount = 0;
+	for (auto distance : Distances)
+	{
+		for (auto width : Widths)
+		{
+			std::vector<const TrialResult*> matching;
+			for (auto& trial : trials)
+			{
+				if (trial.distance == distance && trial.width == width && !trial.isTimedOut) matching.push_back(&trial);
+			}
+			if (matching.size() < 2) continue;
+
+			double mean = 0, movementMs = 0;
+			for (auto trial : matching) mean += trial->along / matching.size(), movementMs += trial->movementMs / matching.size();
+			double variance = 0;
+			for (auto trial : matching) variance += (trial->along - mean) * (trial->along - mean) / (matching.size() - 1);
+
+			auto effectiveWidth = 4.133 * std::sqrt(variance);
+			auto effectiveDistance = distance + mean;
+			if (effectiveWidth <= 0) continue;
+
+			sum += std::log2(effectiveDistance / effectiveWidth + 1) / (movementMs / 1000);
+			conditionCount++;
+		}
+	}
+	return conditionCount ? sum / conditionCount : 0;
+}
+
+int main(int argc, char* argv[])
+{
+	uint32_t seed = 1;
+	int trialsPerCondition = 20;
+	for (int i = 1; i < argc; i++)
+	{
+		if (std::strcmp(argv[i], "--seed") == 0 && i + 1 < argc) seed = (uint32_t)std::atoi(argv[++i]);
+		else if (std::strcmp(argv[i], "--trials") == 0 && i + 1 < argc) trialsPerCondition = std::max(2, std::atoi(argv[++i]));
+	}
+
+	Logger::MinimumLevel = Logger::Level::Error; // alignment and configuration changes are logged
+	Input::Initialize();
+
+	printf("seed %u, %d trials per distance and width, %zu distances x %zu widths\n\n", seed, trialsPerCondition,
+		std::size(Distances), std::size(Widths));
+	printf("%-24s %9s %9s %11s %8s %9s %9s %12s\n", "scenario", "interval", "latency", "throughput", "time", "errors",
+		"timeouts", "pipeline");
+	printf("%-24s %9s %9s %11s %8s %9s %9s %12s\n", "", "ms", "ms", "bits/s", "ms", "%", "", "ns/packet");
+
+	for (auto& scenario : Scenarios)
+	{
+		auto result = Run(scenario, seed, trialsPerCondition);
+
+		int errors = 0, timeouts = 0, completed = 0;
+		double movementMs = 0;
+		for (auto& trial : result.trials)
+		{
+			if (trial.isTimedOut) { timeouts++; continue; }
+			completed++;
+			movementMs += trial.movementMs;
+			errors += !trial.isHit;
+		}
+
+		printf("%-24s %9.1f %9.0f %11.2f %8.0f %9.1f %9d %12.0f\n", scenario.name, scenario.connectionIntervalMs,
+			scenario.latencyMs, Throughput(result.trials), completed ? movementMs / completed : 0,
+			completed ? 100.0 * errors / completed : 0, timeouts,
+			result.packets ? result.pipelineSeconds * 1e9 / result.packets : 0);
+	}
+
+	return 0;
+}
@@ -0,0 +1,220 @@
+// Measures how well MotionPredictor compensates for transport latency.
+//
+// Each synthetic trace describes the "true" cursor trajectory p(t) in pixels. The host only sees
+// p(t - latency), sampled at the remote's rate with a little sensor jitter added, and the error of
+// the displayed position (with and without prediction) is measured against p(t). Reaching traces
+// also report the overshoot past each target, which is where a naive extrapolator hurts most.
+//
+// Linux: g++ -std=c++17 -O2 -I../src PredictionBenchmark.cpp ../src/MotionPredictor.cpp -o PredictionBenchmark
+
+#include "MotionPredictor.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+static constexpr auto SampleRateHz = 100.0;
+static constexpr auto TraceSeconds = 60.0;
+static constexpr auto JitterPixels = 0.3; // standard deviation of the per-sample position noise
+static constexpr uint32_t Seed = 12345;
+static constexpr double Latencies[] = { 10, 20, 40, 60 };
+static constexpr auto Pi = 3.14159265358979;
+
+struct Point
+{
+	double x;
+	double y;
+};
+
+// Minimum jerk reach from one target to the next, followed by a hold
+struct Reach
+{
+	double start;
+	double duration;
+	double hold;
+	Point from;
+	Point to;
+};
+
+class Trace
+{
+public:
+	virtual ~Trace() = default;
+	virtual const char* Name() const = 0;
+	virtual Point Position(double t) const = 0;
+	virtual const std::vector<Reach>* Reaches() const { return nullptr; }
+};
+
+class SweepTrace : public Trace
+{
+public:
+	const char* Name() const override { return "sweep 0.7 Hz"; }
+	Point Position(double t) const override
+	{
+		return { 400 * std::sin(2 * Pi * 0.7 * t), 150 * std::sin(2 * Pi * 0.35 * t) };
+	}
+};
+
+class CircleTrace : public Trace
+{
+public:
+	const char* Name() const override { return "circle 1.5 Hz"; }
+	Point Position(double t) const override
+	{
+		return { 200 * std::cos(2 * Pi * 1.5 * t), 200 * std::sin(2 * Pi * 1.5 * t) };
+	}
+};
+
+class ReachTrace : public Trace
+{
+private:
+	std::vector<Reach> reaches;
+public:
+	explicit ReachTrace(uint32_t seed)
+	{
+		std::mt19937 random(seed);
+		std::uniform_real_distribution<double> distance(100, 800);
+		std::uniform_real_distribution<double> angle(0, 2 * Pi);
+		std::uniform_real_distribution<double> duration(0.25, 0.6);
+		std::uniform_real_distribution<double> hold(0.2, 0.5);
+
+		Point position{ 0, 0 };
+		for (double t = 0; t < TraceSeconds;)
+		{
+			auto length = distance(random);
+			auto direction = angle(random);
+			Point target{ position.x + length * std::cos(direction), position.y + length * std::sin(direction) };
+
+			reaches.push_back({ t, duration(random), hold(random), position, target });
+			t += reaches.back().duration + reaches.back().hold;
+			position = target;
+		}
+	}
+
+	const char* Name() const override { return "reaches"; }
+	const std::vector<Reach>* Reaches() const override { return &reaches; }
+
+	Point Position(double t) const override
+	{
+		if (t <= 0) return reaches.front().from;
+
+		auto reach = std::upper_bound(reaches.begin(), reaches.end(), t,
+			[](double time, const Reach& r) { return time < r.start; }) - 1;
+
+		auto s = std::min(1.0, (t - reach->start) / reach->duration);
+		auto shape = s * s * s * (10 - 15 * s + 6 * s * s);
+		return {
+			reach->from.x + (reach->to.x - reach->from.x) * shape,
+			reach->from.y + (reach->to.y - reach->from.y) * shape
+		};
+	}
+};
+
+struct Result
+{
+	double rmsError;
+	double maxError;
+	double meanOvershoot; // pixels past the target along the reach direction, per reach
+	double maxOvershoot;
+};
+
+static Result Evaluate(const Trace& trace, double latencyMs, bool predict)
+{
+	std::mt19937 random(Seed);
+	std::normal_distribution<double> jitter(0, JitterPixels);
+
+	MotionPredictor predictor((float)latencyMs);
+	auto dt = 1 / SampleRateHz;
+	auto latency = latencyMs / 1000;
+	auto sampleCount = (int)(TraceSeconds * SampleRateHz);
+
+	std::vector<Point> displayed(sampleCount);
+	Point previous = trace.Position(-latency);
+	double squaredError = 0;
+	Result result{};
+
+	for (int i = 0; i < sampleCount; i++)
+	{
+		auto t = i * dt;
+		auto observed = trace.Position(t - latency);
+		observed.x += jitter(random);
+		observed.y += jitter(random);
+
+		float offsetX = 0, offsetY = 0;
+		if (predict)
+			predictor.Update((float)(observed.x - previous.x), (float)(observed.y - previous.y), (float)dt, offsetX, offsetY);
+		previous = observed;
+
+		displayed[i] = { observed.x + offsetX, observed.y + offsetY };
+
+		auto truth = trace.Position(t);
+		auto error = std::hypot(displayed[i].x - truth.x, displayed[i].y - truth.y);
+		squaredError += error * error;
+		result.maxError = std::max(result.maxError, error);
+	}
+
+	result.rmsError = std::sqrt(squaredError / sampleCount);
+
+	if (auto reaches = trace.Reaches())
+	{
+		int counted = 0;
+		for (const auto& reach : *reaches)
+		{
+			auto length = std::hypot(reach.to.x - reach.from.x, reach.to.y - reach.from.y);
+			Point direction{ (reach.to.x - reach.from.x) / length, (reach.to.y - reach.from.y) / length };
+
+			auto first = (int)(reach.start * SampleRateHz);
+			auto last = std::min(sampleCount, (int)((reach.start + reach.duration + reach.hold) * SampleRateHz));
+			if (last <= first) continue;
+
+			double overshoot = 0;
+			for (int i = first; i < last; i++)
+			{
+				auto along = (displayed[i].x - reach.to.x) * direction.x + (displayed[i].y - reach.to.y) * direction.y;
+				overshoot = std::max(overshoot, along);
+			}
+
+			result.meanOvershoot += overshoot;
+			result.maxOvershoot = std::max(result.maxOvershoot, overshoot);
+			counted++;
+		}
+		if (counted > 0) result.meanOvershoot /= counted;
+	}
+
+	return result;
+}
+
+int main()
+{
+	SweepTrace sweep;
+	CircleTrace circle;
+	ReachTrace reaches(Seed);
+	const Trace* traces[] = { &sweep, &circle, &reaches };
+
+	printf("%.0f Hz, %.0f s per trace, %.1f px jitter, seed %u\n\n", SampleRateHz, TraceSeconds, JitterPixels, Seed);
+	printf("%-14s %8s %22s %22s %22s\n", "", "", "rms error (px)", "max error (px)", "mean/max overshoot");
+	printf("%-14s %8s %10s %11s %10s %11s %10s %11s\n",
+		"trace", "latency", "delayed", "predicted", "delayed", "predicted", "delayed", "predicted");
+
+	for (auto trace : traces)
+	{
+		for (auto latencyMs : Latencies)
+		{
+			auto delayed = Evaluate(*trace, latencyMs, false);
+			auto predicted = Evaluate(*trace, latencyMs, true);
+
+			printf("%-14s %6.0fms %10.1f %11.1f %10.1f %11.1f",
+				trace->Name(), latencyMs,
+				delayed.rmsError, predicted.rmsError,
+				delayed.maxError, predicted.maxError);
+
+			if (trace->Reaches())
+				printf("  %4.1f/%-5.1f %5.1f/%-5.1f", delayed.meanOvershoot, delayed.maxOvershoot,
+					predicted.meanOvershoot, predicted.maxOvershoot);
+			printf("\n");
+		}
+	}
+
+	return 0;
+}
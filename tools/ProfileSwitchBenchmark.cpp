@@ -0,0 +1,237 @@
+// Measures how long a foreground change takes to reach the packet path. A profile with a section
+// per application is loaded and applied, a fake foreground provider reports application changes
+// through Foreground::Report, and a packet thread feeds Input side to side rotation back to back.
+// Applications alternate between two mouse sensitivities, so the packet thread tells from how far
+// each packet moves the cursor which tuning it ran with.
+//
+// For each switch it reports how long Report took, which covers the lookup in the profile and the
+// pointer store, and how long until the first packet moved the cursor with the new tuning. With a
+// real remote a packet arrives once per sample period, which comes on top. It also reports what a
+// packet costs while switches keep arriving against none at all, for profiles of 2 to 1024
+// applications.
+//
+// Linux: g++ -std=c++17 -O2 -I../src ProfileSwitchBenchmark.cpp ../src/Profiles.cpp ../src/Foreground.cpp
+//            ../src/Input.cpp ../src/PointerOutput.cpp ../src/IdleDetector.cpp ../src/OrientationFilter.cpp
+//            ../src/MotionPredictor.cpp ../src/GyroHistory.cpp ../src/Logger.cpp ../src/Metrics.cpp
+//            ../src/NetworkOutput.cpp ../src/PacketBroadcast.cpp ../src/Trace.cpp ../src/PlotFeed.cpp
+//            ../src/ResponseCurve.cpp ../src/ButtonMapper.cpp ../src/ClickStabilizer.cpp ../src/RemoteControl.cpp
+//            -o ProfileSwitchBenchmark -lrt -pthread
+
+#include "Foreground.h"
+#include "Input.h"
+#include "Logger.h"
+#include "PointerOutput.h"
+#include "Profiles.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using Clock = std::chrono::steady_clock;
+
+static constexpr auto ProfilePath = "ProfileSwitchBenchmark.profile";
+static constexpr auto Switches = 2000;
+static constexpr auto SwitchPause = std::chrono::microseconds(100); // between a switch taking effect and the next
+static constexpr auto SlowSensitivity = 20.0f; // the curved rate is divided by it
+static constexpr auto FastSensitivity = 10.0f;
+static constexpr auto RateDps = 100.0f;
+
+static std::string ApplicationName(int index)
+{
+	return "App" + std::to_string(index) + ".exe"; // reported in mixed case, as Windows names them
+}
+
+// Even applications point slowly, odd ones fast
+static bool WriteProfile(int applicationCount)
+{
+	std::ofstream file(ProfilePath);
+	file << "mouse_sensitivity = " << SlowSensitivity << "\n";
+	for (int i = 0; i < applicationCount; i++)
+	{
+		file << "\n[" << ApplicationName(i) << "]\n";
+		file << "mouse_sensitivity = " << (i % 2 ? FastSensitivity : SlowSensitivity) << "\n";
+	}
+	return (bool)file;
+}
+
+class PacketPump
+{
+public:
+	explicit PacketPump(float thresholdPixels) :
+		thresholdPixels(thresholdPixels)
+	{
+	}
+
+	void Start()
+	{
+		isRunning = true;
+		thread = std::thread([this] { Run(); });
+	}
+
+	void Stop()
+	{
+		isRunning = false;
+		thread.join();
+	}
+
+	bool IsFast() const
+	{
+		return isFast.load(std::memory_order_acquire);
+	}
+
+	// When the packet thread first saw the current tuning, stamped there so that waiting on it
+	// does not count
+	Clock::time_point ChangedAt() const
+	{
+		return Clock::time_point(Clock::duration(changedAt.load(std::memory_order_acquire)));
+	}
+
+	uint64_t Packets() const
+	{
+		return packets.load(std::memory_order_relaxed);
+	}
+
+	// Pixels one packet moves the cursor with the current tuning, on the calling thread
+	static float Step(int16_t rawRate)
+	{
+		float startX, startY, x, y;
+		PointerOutput::CursorPosition(startX, startY);
+		Input::ProcessPacket({ { 0, 0, rawRate }, 0 });
+		PointerOutput::CursorPosition(x, y);
+		return std::abs(x - startX);
+	}
+
+	static int16_t RawRate()
+	{
+		return (int16_t)(RateDps * INT16_MAX / Input::DefaultDegreeRange);
+	}
+private:
+	float thresholdPixels;
+	std::thread thread;
+	std::atomic<bool> isRunning{ false };
+	std::atomic<bool> isFast{ false };
+	std::atomic<Clock::rep> changedAt{ 0 };
+	std::atomic<uint64_t> packets{ 0 };
+
+	// Side to side, so the cursor stays put
+	void Run()
+	{
+		auto rate = RawRate();
+		for (uint64_t i = 0; isRunning.load(std::memory_order_relaxed); i++)
+		{
+			auto isNowFast = Step(i % 2 ? rate : (int16_t)-rate) > thresholdPixels;
+			if (isNowFast != isFast.load(std::memory_order_relaxed))
+			{
+				changedAt.store(Clock::now().time_since_epoch().count(), std::memory_order_relaxed);
+				isFast.store(isNowFast, std::memory_order_release);
+			}
+			packets.store(i + 1, std::memory_order_relaxed);
+		}
+	}
+};
+
+static double Percentile(std::vector<double> values, double fraction)
+{
+	std::sort(values.begin(), values.end());
+	return values[std::min(values.size() - 1, (size_t)(fraction * values.size()))];
+}
+
+// Packet cost over a fixed time, while a provider thread reports a change every switchEvery or never
+static double NanosecondsPerPacket(PacketPump& pump, int applicationCount, std::chrono::microseconds switchEvery)
+{
+	constexpr auto Duration = std::chrono::milliseconds(500);
+	auto startPackets = pump.Packets();
+	auto start = Clock::now();
+	for (int i = 0; Clock::now() - start < Duration; i++)
+	{
+		if (switchEvery.count() > 0) Foreground::Report(ApplicationName(i % applicationCount));
+		std::this_thread::sleep_for(switchEvery.count() > 0 ? switchEvery : Duration);
+	}
+	auto elapsed = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+	return elapsed / (pump.Packets() - startPackets);
+}
+
+int main()
+{
+	Logger::MinimumLevel = Logger::Level::Error;
+	Input::UsageModeRequested = nullptr;
+	Input::Initialize();
+	PointerOutput::Move(PointerOutput::ScreenWidth() / 2.0f, PointerOutput::ScreenHeight() / 2.0f);
+	Foreground::Start(Profiles::SetForegroundApplication);
+
+	printf("%d switches per profile, fake foreground provider, packets back to back, %u cores\n\n", Switches,
+		std::thread::hardware_concurrency());
+	printf("%12s %11s %11s %11s %11s %11s %11s %12s %12s\n", "applications", "report", "report", "report",
+		"to packet", "to packet", "to packet", "packet", "packet");
+	printf("%12s %11s %11s %11s %11s %11s %11s %12s %12s\n", "", "p50 ns", "p99 ns", "max ns",
+		"p50 ns", "p99 ns", "max ns", "ns, still", "ns, 1/ms");
+
+	auto isCorrect = true;
+	for (auto applicationCount : { 2, 64, 1024 })
+	{
+		Profiles::Profile profile;
+		if (!WriteProfile(applicationCount) || !Profiles::Load(ProfilePath, profile))
+		{
+			printf("could not write and load %s\n", ProfilePath);
+			return 1;
+		}
+		std::remove(ProfilePath);
+		Profiles::Apply(profile);
+
+		// Both tunings once, on this thread, to tell them apart by distance
+		auto rate = PacketPump::RawRate();
+		Foreground::Report(ApplicationName(0));
+		PacketPump::Step(rate);
+		auto slowPixels = PacketPump::Step((int16_t)-rate);
+		Foreground::Report(ApplicationName(1));
+		PacketPump::Step(rate);
+		auto fastPixels = PacketPump::Step((int16_t)-rate);
+		if (fastPixels <= slowPixels + 1)
+		{
+			printf("sensitivities not told apart: %.1f and %.1f pixels\n", slowPixels, fastPixels);
+			return 1;
+		}
+
+		PacketPump pump((slowPixels + fastPixels) / 2);
+		pump.Start();
+
+		std::vector<double> reportNs, effectNs;
+		for (int i = 0; i < Switches; i++)
+		{
+			// Alternately a slow and a fast application, anywhere in the profile
+			auto application = (i * 7919) % (applicationCount / 2) * 2 + i % 2;
+			auto isFast = application % 2 == 1;
+
+			auto start = Clock::now();
+			Foreground::Report(ApplicationName(application));
+			auto reported = Clock::now();
+			while (pump.IsFast() != isFast && Clock::now() - reported < std::chrono::seconds(1))
+			{
+				std::this_thread::yield(); // on a single core the packet thread needs the time
+			}
+			isCorrect &= pump.IsFast() == isFast;
+			auto effective = pump.ChangedAt();
+
+			reportNs.push_back(std::chrono::duration<double, std::nano>(reported - start).count());
+			effectNs.push_back(std::chrono::duration<double, std::nano>(effective - start).count());
+			std::this_thread::sleep_for(SwitchPause);
+		}
+
+		auto stillNs = NanosecondsPerPacket(pump, applicationCount, std::chrono::microseconds(0));
+		auto switchingNs = NanosecondsPerPacket(pump, applicationCount, std::chrono::microseconds(1000));
+		pump.Stop();
+
+		printf("%12d %11.0f %11.0f %11.0f %11.0f %11.0f %11.0f %12.1f %12.1f\n", applicationCount,
+			Percentile(reportNs, 0.5), Percentile(reportNs, 0.99), Percentile(reportNs, 1),
+			Percentile(effectNs, 0.5), Percentile(effectNs, 0.99), Percentile(effectNs, 1), stillNs, switchingNs);
+	}
+
+	Foreground::Stop();
+	printf("\nevery switch reached the packet path: %s\n", isCorrect ? "yes" : "NO");
+	return isCorrect ? 0 : 1;
+}
@@ -0,0 +1,200 @@
+// Drives RemoteControl::Controller against SimulatedRemote through PacketParser, the way the
+// pipeline wires them, and checks each path of the command channel: an acknowledged command, a
+// rejected one, a lost command retried and then acknowledged, a command that is never answered,
+// a repeated acknowledgement, a frame that carries the response signature but answers no
+// command, and a reset that reaches ConfigurationChanged only on the parser thread's next
+// notification. Timeouts run on the wall clock, so the check takes about two seconds.
+//
+// Linux: g++ -std=c++17 -O2 -I../src RemoteControlCheck.cpp ../src/RemoteControl.cpp ../src/SimulatedRemote.cpp
+//            ../src/PacketParser.cpp ../src/CircularBuffer.cpp ../src/Logger.cpp ../src/Metrics.cpp ../src/Trace.cpp
+//            -o RemoteControlCheck -lrt -pthread
+
+#include "CircularBuffer.h"
+#include "Logger.h"
+#include "Metrics.h"
+#include "PacketParser.h"
+#include "RemoteControl.h"
+#include "SimulatedRemote.h"
+#include <chrono>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+using namespace RemoteControl;
+
+class Channel
+{
+public:
+	std::vector<Configuration> changes;
+	std::vector<CommandResult> rejections;
+	std::vector<Command> timeouts;
+	int writes = 0;
+	int lostWrites = 0; // the next this many writes never reach the remote
+
+	Channel() :
+		remote([this](const uint8_t* data, size_t length) { buffer.WriteBuffer(data, (int)length); }, 1),
+		controller([this](const uint8_t* data, size_t length) {
+			writes++;
+			if (lostWrites > 0)
+			{
+				lostWrites--;
+				return true;
+			}
+			return remote.Receive(data, length);
+		})
+	{
+		controller.ConfigurationChanged = [this](Configuration configuration) { changes.push_back(configuration); };
+		controller.CommandRejected = [this](Command, uint16_t, CommandResult result) { rejections.push_back(result); };
+		controller.CommandTimedOut = [this](Command command, uint16_t) { timeouts.push_back(command); };
+
+		PacketParser::ControlResponseReady = [this](ControlResponse response) { return controller.OnResponse(response); };
+		PacketParser::PacketReady = nullptr;
+		PacketParser::ExtendedPacketReady = nullptr;
+		PacketParser::SetBuffer(&buffer);
+		PacketParser::ResetDataAlignment();
+		Step(40); // until the parser has aligned
+	}
+
+	~Channel()
+	{
+		PacketParser::ControlResponseReady = nullptr;
+		PacketParser::SetBuffer(nullptr);
+	}
+
+	// Samples from the remote, each parsed as its own notification
+	void Step(int samples)
+	{
+		for (int i = 0; i < samples; i++)
+		{
+			remote.Step({ 10, 0, 0 }, 0);
+			controller.AnnounceReset();
+			PacketParser::OnReceivedData();
+		}
+	}
+
+	// Waits out a command timeout, then lets the controller retransmit or give up
+	void Timeout()
+	{
+		std::this_thread::sleep_for(std::chrono::milliseconds(CommandTimeoutMs + 20));
+		controller.CheckTimeouts();
+	}
+
+	// Puts a frame in the stream that only looks like a response
+	void Inject(const ControlResponse& response)
+	{
+		buffer.WriteBuffer((const uint8_t*)&response, (int)sizeof(response));
+	}
+
+	static uint64_t Realignments()
+	{
+		Metrics::ParserMetrics metrics{};
+		Metrics::Read(Metrics::WriterPage()->parser, metrics);
+		return metrics.realignments;
+	}
+
+	CircularBuffer buffer;
+	SimulatedRemote remote;
+	Controller controller;
+};
+
+static bool isCorrect = true;
+
+static void Expect(bool condition, const char* what)
+{
+	printf("%-58s %s\n", what, condition ? "ok" : "FAILED");
+	isCorrect &= condition;
+}
+
+static bool Is(const Configuration& configuration, uint16_t sampleRateHz, uint16_t gyroRange)
+{
+	return configuration.sampleRateHz == sampleRateHz && configuration.gyroRange == gyroRange;
+}
+
+int main()
+{
+	Logger::MinimumLevel = Logger::Level::Error;
+
+	{
+		Channel channel;
+		channel.controller.SetSampleRate(200);
+		channel.Step(2);
+		Expect(channel.changes.size() == 1 && Is(channel.changes[0], 200, DefaultGyroRange), "acknowledged command changes the configuration");
+		channel.Timeout();
+		Expect(channel.writes == 1 && channel.timeouts.empty(), "acknowledged command is not retransmitted");
+	}
+
+	{
+		Channel channel;
+		channel.controller.SetSampleRate(5000);
+		channel.Step(2);
+		Expect(channel.rejections.size() == 1 && channel.rejections[0] == CommandResult::InvalidValue, "invalid value is rejected");
+		Expect(channel.changes.empty() && Is(channel.controller.CurrentConfiguration(), DefaultSampleRateHz, DefaultGyroRange),
+			"rejected command leaves the configuration");
+	}
+
+	{
+		Channel channel;
+		channel.lostWrites = 1;
+		channel.controller.SetGyroRange(1000);
+		channel.Step(2);
+		Expect(channel.changes.empty(), "lost command changes nothing");
+		channel.Timeout();
+		channel.Step(2);
+		Expect(channel.writes == 2 && channel.changes.size() == 1 && Is(channel.changes[0], DefaultSampleRateHz, 1000),
+			"lost command is retransmitted and acknowledged");
+	}
+
+	{
+		Channel channel;
+		channel.lostWrites = MaxCommandAttempts;
+		channel.controller.SetGyroRange(2000);
+		for (int attempt = 0; attempt < MaxCommandAttempts; attempt++) channel.Timeout();
+		Expect(channel.writes == MaxCommandAttempts && channel.timeouts.size() == 1 && channel.timeouts[0] == Command::SetGyroRange,
+			"unanswered command times out after the last attempt");
+		Expect(channel.changes.empty(), "timed out command changes nothing");
+	}
+
+	{
+		// The first acknowledgement arrives after the retransmission went out, so both are answered
+		Channel channel;
+		channel.controller.SetSampleRate(200);
+		channel.Timeout();
+		auto realignments = Channel::Realignments();
+		channel.Step(4);
+		Expect(channel.writes == 2 && channel.changes.size() == 1, "repeated acknowledgement is applied once");
+		Expect(Channel::Realignments() == realignments, "repeated acknowledgement is not misaligned data");
+	}
+
+	{
+		Channel channel;
+		ControlResponse forged{};
+		forged.Sequence = 77;
+		forged.Opcode = (uint8_t)Command::SetSampleRate;
+		forged.SampleRateHz = 400;
+		forged.GyroRangeCode = (uint8_t)GyroRangeCode(2000);
+		forged.Signature = ResponseSignature;
+
+		auto realignments = Channel::Realignments();
+		channel.Inject(forged);
+		channel.Step(40);
+		Expect(channel.changes.empty() && Is(channel.controller.CurrentConfiguration(), DefaultSampleRateHz, DefaultGyroRange),
+			"response to no command in flight is not applied");
+		Expect(Channel::Realignments() == realignments + 1 && PacketParser::IsDataAligned(),
+			"response to no command in flight realigns the parser");
+	}
+
+	{
+		Channel channel;
+		channel.controller.SetSampleRate(200);
+		channel.Step(2);
+		channel.changes.clear();
+		channel.controller.Reset();
+		Expect(channel.changes.empty(), "reset does not call back on the resetting thread");
+		channel.Step(1);
+		Expect(channel.changes.size() == 1 && Is(channel.changes[0], DefaultSampleRateHz, DefaultGyroRange),
+			"reset is announced before the next notification is parsed");
+	}
+
+	printf("\n%s\n", isCorrect ? "all checks passed" : "SOME CHECKS FAILED");
+	return isCorrect ? 0 : 1;
+}
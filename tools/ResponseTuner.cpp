@@ -0,0 +1,638 @@
+// Searches the relative pointing response curve (sensitivity, power factor, dead zone, drag
+// tolerance) offline. Recorded sessions (Session::Recorder, "GestureControl record") are replayed
+// through ResponseCurve, the transform Input applies, once per candidate; candidates are evaluated
+// in parallel by a work-stealing pool and ranked by a weighted score:
+//
+//   overshoot   how far each reach travels past where it ends, as a share of its length
+//   efficiency  straight-line displacement of each reach over the path it took
+//   jitter      RMS cursor motion per packet while the hand is holding still
+//   gain        drift of the total reach distance from the recording parameters', so the search
+//               cannot trade speed for steadiness
+//   gestures    middle presses that become a drag when the hand scrolled, or the other way round
+//
+// The replay is open loop: the recorded hand motion does not react to the candidate's cursor, so
+// scores compare curves on the same motion rather than predict how a user would adapt. Without
+// session files a synthetic session of reaches, holds and middle presses is generated.
+//
+// Linux: g++ -std=c++17 -O2 -I../src ResponseTuner.cpp ../src/ResponseCurve.cpp ../src/Session.cpp
+//            ../src/PacketBroadcast.cpp ../src/Logger.cpp -o ResponseTuner -pthread
+//
+// Usage: ResponseTuner [--search grid|random|es] [--candidates n] [--threads n] [--seed n] [--top n]
+//                      [--output profile] [--synthesize session] [--scaling] [session ...]
+
+#include "Input.h"
+#include "ResponseCurve.h"
+#include "Session.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+using Clock = std::chrono::steady_clock;
+
+static constexpr auto MovingRate = 20.0f; // degrees per second of pointing motion that makes a reach
+static constexpr auto HoldRate = 5.0f; // slower than this, the hand is holding still
+static constexpr int64_t ReachMergeNs = 100000000; // a reach ends once the hand has held still this long
+static constexpr int64_t MinimumReachNs = 100000000;
+static constexpr auto MinimumReachPixels = 1.0f;
+
+static constexpr auto OvershootWeight = 1.0;
+static constexpr auto EfficiencyWeight = 1.0;
+static constexpr auto JitterWeight = 1.0; // per pixel
+static constexpr auto GainWeight = 2.0; // per unit of |ln(gain)|
+static constexpr auto GestureWeight = 1.0;
+
+static constexpr auto EsGenerations = 8;
+static constexpr auto EsParents = 8; // best candidates the next generation is sampled around
+
+// Synthetic session
+static constexpr auto SyntheticSeconds = 300.0;
+static constexpr auto SyntheticRateHz = 100.0;
+static constexpr auto Pi = 3.14159265358979;
+
+struct Dimension
+{
+	const char* key; // profile key
+	float ResponseCurve::Parameters::*field;
+	float minimum;
+	float maximum;
+};
+
+static const Dimension Dimensions[] = {
+	{ "mouse_sensitivity", &ResponseCurve::Parameters::mouseSensitivity, 4, 20 },
+	{ "mouse_power", &ResponseCurve::Parameters::mousePowerFactor, 1, 2 },
+	{ "mouse_dead_zone", &ResponseCurve::Parameters::mouseDeadZone, 0, 2 },
+	{ "drag_tolerance", &ResponseCurve::Parameters::dragTolerance, 5, 80 },
+};
+static constexpr auto DimensionCount = (int)(sizeof(Dimensions) / sizeof(Dimensions[0]));
+
+// What a session looks like to every candidate, worked out once
+struct Span
+{
+	int first;
+	int last; // exclusive
+};
+
+struct Press
+{
+	Span span;
+	bool isScroll; // the hand rolled more than it pointed while the button was held
+};
+
+struct PreparedSession
+{
+	std::string name;
+	float sampleInterval; // seconds, the mean over the session since samples arrive in batches
+	std::vector<Vector3> rates;
+	std::vector<uint8_t> buttons;
+	std::vector<Span> reaches;
+	std::vector<int> holds; // samples
+	std::vector<Press> presses;
+};
+
+struct Objectives
+{
+	double overshoot = 0; // summed over reaches
+	double efficiency = 0;
+	int reachCount = 0;
+	double reachPixels = 0;
+	double jitterSquared = 0; // summed over hold samples
+	int holdCount = 0;
+	int misclassified = 0;
+	int pressCount = 0;
+};
+
+struct Candidate
+{
+	ResponseCurve::Parameters parameters;
+	Objectives objectives;
+	double gain = 0;
+	double score = 0;
+};
+
+// Each worker drains its own deque from the back and steals from the front of the others' once it
+// is empty, so uneven candidates (long dead zones skip work, long sessions do not) still balance.
+class WorkStealingPool
+{
+public:
+	using Task = std::function<void(int task)>;
+
+	explicit WorkStealingPool(int threadCount) : queues(threadCount) {}
+
+	void Run(int taskCount, const Task& task)
+	{
+		auto threadCount = (int)queues.size();
+		for (int i = 0; i < taskCount; i++) queues[(size_t)(i * threadCount / taskCount)].tasks.push_back(i);
+
+		std::vector<std::thread> threads;
+		for (int worker = 1; worker < threadCount; worker++) threads.emplace_back(&WorkStealingPool::Work, this, worker, std::cref(task));
+		Work(0, task);
+		for (auto& thread : threads) thread.join();
+	}
+private:
+	struct Queue
+	{
+		std::mutex mutex;
+		std::deque<int> tasks;
+	};
+
+	std::vector<Queue> queues;
+
+	bool Pop(int worker, int& task)
+	{
+		auto& queue = queues[(size_t)worker];
+		std::lock_guard<std::mutex> lock(queue.mutex);
+		if (queue.tasks.empty()) return false;
+		task = queue.tasks.back();
+		queue.tasks.pop_back();
+		return true;
+	}
+
+	bool Steal(int worker, int& task)
+	{
+		auto threadCount = (int)queues.size();
+		for (int offset = 1; offset < threadCount; offset++)
+		{
+			auto& queue = queues[(size_t)((worker + offset) % threadCount)];
+			std::lock_guard<std::mutex> lock(queue.mutex);
+			if (queue.tasks.empty()) continue;
+			task = queue.tasks.front();
+			queue.tasks.pop_front();
+			return true;
+		}
+		return false;
+	}
+
+	void Work(int worker, const Task& run)
+	{
+		int task;
+		while (Pop(worker, task) || Steal(worker, task)) run(task);
+	}
+};
+
+static float PointingRate(Vector3 rates)
+{
+	return std::sqrt(rates.X * rates.X + rates.Z * rates.Z);
+}
+
+static PreparedSession Prepare(const std::string& name, const std::vector<Session::Sample>& samples)
+{
+	PreparedSession session;
+	session.name = name;
+	for (auto& sample : samples)
+	{
+		session.rates.push_back(Session::Rates(sample));
+		session.buttons.push_back(sample.buttons);
+	}
+
+	session.sampleInterval = 1 / ResponseCurve::ReferenceSampleRateHz;
+	if (samples.size() > 1 && samples.back().timestampNs > samples.front().timestampNs)
+	{
+		session.sampleInterval = (float)((samples.back().timestampNs - samples.front().timestampNs) / 1e9 / (samples.size() - 1));
+	}
+
+	// Reaches: fast pointing, from where the hand leaves a hold until it settles into the next one,
+	// so that corrections and overshoot stay part of the reach
+	auto count = (int)samples.size();
+	std::vector<bool> isInReach((size_t)count, false);
+	auto isMoving = [&session](int i) { return PointingRate(session.rates[(size_t)i]) >= HoldRate; };
+	for (int i = 0; i < count;)
+	{
+		if (PointingRate(session.rates[(size_t)i]) <= MovingRate) { i++; continue; }
+
+		auto first = i, last = i + 1;
+		while (first > 0 && !isInReach[(size_t)first - 1] && isMoving(first - 1)) first--;
+		for (int j = i; j < count; j++)
+		{
+			if (isMoving(j)) last = j + 1;
+			else if (samples[(size_t)j].timestampNs - samples[(size_t)last - 1].timestampNs > ReachMergeNs) break;
+		}
+
+		if (samples[(size_t)last - 1].timestampNs - samples[(size_t)first].timestampNs >= MinimumReachNs)
+		{
+			session.reaches.push_back({ first, last });
+			for (int j = first; j < last; j++) isInReach[(size_t)j] = true;
+		}
+		i = last;
+	}
+
+	for (int i = 0; i < count; i++)
+	{
+		if (!isInReach[(size_t)i] && PointingRate(session.rates[(size_t)i]) < HoldRate && !(session.buttons[(size_t)i] & Input::MiddleMask))
+			session.holds.push_back(i);
+	}
+
+	for (int i = 0; i < count;)
+	{
+		if (!(session.buttons[(size_t)i] & Input::MiddleMask)) { i++; continue; }
+
+		Press press{ { i, i }, false };
+		float peakScroll = 0, peakPointing = 0;
+		for (; i < count && (session.buttons[(size_t)i] & Input::MiddleMask); i++)
+		{
+			peakScroll = std::max(peakScroll, std::abs(session.rates[(size_t)i].Y));
+			peakPointing = std::max(peakPointing, PointingRate(session.rates[(size_t)i]));
+		}
+		press.span.last = i;
+		press.isScroll = peakScroll > peakPointing;
+		session.presses.push_back(press);
+	}
+
+	return session;
+}
+
+// Replays the session through the curve the way Input::HandlePacket does, on an unbounded screen
+// and without prediction
+static void Evaluate(const ResponseCurve::Parameters& parameters, const PreparedSession& session, Objectives& objectives)
+{
+	auto count = session.rates.size();
+	std::vector<float> x(count + 1), y(count + 1); // cursor before each sample
+	std::vector<int8_t> gesture(count, 0); // 1 scroll, 2 drag, per middle press
+
+	float cursorX = 0, cursorY = 0;
+	int middleAction = 0; // 0 undetermined, 1 scroll, 2 drag
+	uint8_t previousButtons = 0;
+
+	for (size_t i = 0; i < count; i++)
+	{
+		x[i] = cursorX;
+		y[i] = cursorY;
+
+		auto buttons = session.buttons[i];
+		if ((buttons ^ previousButtons) & Input::MiddleMask) middleAction = 0;
+		previousButtons = buttons;
+
+		auto motion = ResponseCurve::Apply(parameters, session.rates[i], session.sampleInterval);
+		auto isMiddleDown = (buttons & Input::MiddleMask) != 0;
+		if (isMiddleDown && middleAction == 0)
+		{
+			if (ResponseCurve::IsScrollGesture(parameters, motion)) middleAction = 1;
+			if (ResponseCurve::IsDragGesture(parameters, motion)) middleAction = 2;
+		}
+		if (isMiddleDown) gesture[i] = (int8_t)middleAction;
+		if (isMiddleDown && middleAction == 1) continue; // scrolling holds the cursor
+
+		cursorX += motion.cookedDx;
+		cursorY += motion.cookedDy;
+	}
+	x[count] = cursorX;
+	y[count] = cursorY;
+
+	for (auto& reach : session.reaches)
+	{
+		auto dx = x[(size_t)reach.last] - x[(size_t)reach.first];
+		auto dy = y[(size_t)reach.last] - y[(size_t)reach.first];
+		auto distance = std::sqrt(dx * dx + dy * dy);
+		if (distance < MinimumReachPixels) continue;
+
+		double path = 0, furthest = 0;
+		for (auto i = reach.first; i < reach.last; i++)
+		{
+			path += std::hypot(x[(size_t)i + 1] - x[(size_t)i], y[(size_t)i + 1] - y[(size_t)i]);
+			auto along = ((x[(size_t)i + 1] - x[(size_t)reach.first]) * dx + (y[(size_t)i + 1] - y[(size_t)reach.first]) * dy) / distance;
+			furthest = std::max(furthest, (double)along);
+		}
+
+		objectives.overshoot += (furthest - distance) / distance;
+		objectives.efficiency += distance / path;
+		objectives.reachPixels += distance;
+		objectives.reachCount++;
+	}
+
+	for (auto i : session.holds)
+	{
+		auto dx = x[(size_t)i + 1] - x[(size_t)i], dy = y[(size_t)i + 1] - y[(size_t)i];
+		objectives.jitterSquared += dx * dx + dy * dy;
+		objectives.holdCount++;
+	}
+
+	for (auto& press : session.presses)
+	{
+		auto action = gesture[(size_t)press.span.last - 1];
+		objectives.misclassified += action != 0 && (action == 1) != press.isScroll;
+		objectives.pressCount++;
+	}
+}
+
+static void Score(Candidate& candidate, double referenceReachPixels)
+{
+	auto& o = candidate.objectives;
+	auto overshoot = o.reachCount ? o.overshoot / o.reachCount : 1.0;
+	auto efficiency = o.reachCount ? o.efficiency / o.reachCount : 0.0;
+	auto jitter = o.holdCount ? std::sqrt(o.jitterSquared / o.holdCount) : 0.0;
+	auto gestures = o.pressCount ? (double)o.misclassified / o.pressCount : 0.0;
+	candidate.gain = referenceReachPixels > 0 ? o.reachPixels / referenceReachPixels : 1.0;
+	auto gainError = candidate.gain > 0 ? std::abs(std::log(candidate.gain)) : 10.0;
+
+	candidate.score = OvershootWeight * overshoot + EfficiencyWeight * (1 - efficiency) + JitterWeight * jitter
+		+ GainWeight * gainError + GestureWeight * gestures;
+}
+
+static void EvaluateAll(std::vector<Candidate>& candidates, size_t first, const std::vector<PreparedSession>& sessions,
+	double referenceReachPixels, int threadCount)
+{
+	WorkStealingPool pool(threadCount);
+	pool.Run((int)(candidates.size() - first), [&](int task) {
+		auto& candidate = candidates[first + (size_t)task];
+		candidate.objectives = {};
+		for (auto& session : sessions) Evaluate(candidate.parameters, session, candidate.objectives);
+		Score(candidate, referenceReachPixels);
+	});
+}
+
+static ResponseCurve::Parameters Clamped(ResponseCurve::Parameters parameters)
+{
+	for (auto& dimension : Dimensions)
+		parameters.*dimension.field = std::clamp(parameters.*dimension.field, dimension.minimum, dimension.maximum);
+	return parameters;
+}
+
+static void AddGrid(std::vector<Candidate>& candidates, int budget)
+{
+	auto levels = std::max(2, (int)std::floor(std::pow((double)budget, 1.0 / DimensionCount)));
+	auto total = 1;
+	for (int d = 0; d < DimensionCount; d++) total *= levels;
+
+	for (int index = 0; index < total; index++)
+	{
+		auto parameters = Input::DefaultResponseCurve;
+		auto rest = index;
+		for (auto& dimension : Dimensions)
+		{
+			auto level = rest % levels;
+			rest /= levels;
+			parameters.*dimension.field = dimension.minimum + (dimension.maximum - dimension.minimum) * level / (levels - 1);
+		}
+		candidates.push_back({ parameters, {}, 0, 0 });
+	}
+}
+
+static void AddRandom(std::vector<Candidate>& candidates, int count, std::mt19937& random)
+{
+	for (int i = 0; i < count; i++)
+	{
+		auto parameters = Input::DefaultResponseCurve;
+		for (auto& dimension : Dimensions)
+			parameters.*dimension.field = std::uniform_real_distribution<float>(dimension.minimum, dimension.maximum)(random);
+		candidates.push_back({ parameters, {}, 0, 0 });
+	}
+}
+
+// Separable evolution strategy: each generation is sampled from a normal distribution per
+// dimension, fitted to the best EsParents candidates so far
+static void RunEvolution(std::vector<Candidate>& candidates, int budget, std::mt19937& random,
+	const std::vector<PreparedSession>& sessions, double referenceReachPixels, int threadCount)
+{
+	auto perGeneration = std::max(EsParents, budget / (EsGenerations + 1));
+	AddRandom(candidates, perGeneration, random);
+	EvaluateAll(candidates, 0, sessions, referenceReachPixels, threadCount);
+
+	for (int generation = 0; generation < EsGenerations; generation++)
+	{
+		std::sort(candidates.begin(), candidates.end(), [](const Candidate& a, const Candidate& b) { return a.score < b.score; });
+
+		float mean[DimensionCount] = {}, deviation[DimensionCount] = {};
+		for (int d = 0; d < DimensionCount; d++)
+		{
+			for (int p = 0; p < EsParents; p++) mean[d] += candidates[(size_t)p].parameters.*Dimensions[d].field / EsParents;
+			for (int p = 0; p < EsParents; p++)
+			{
+				auto offset = candidates[(size_t)p].parameters.*Dimensions[d].field - mean[d];
+				deviation[d] += offset * offset / EsParents;
+			}
+			// Keep a floor so that a collapsed dimension can still move
+			deviation[d] = std::max(std::sqrt(deviation[d]), (Dimensions[d].maximum - Dimensions[d].minimum) * 0.01f);
+		}
+
+		auto first = candidates.size();
+		for (int i = 0; i < perGeneration; i++)
+		{
+			auto parameters = Input::DefaultResponseCurve;
+			for (int d = 0; d < DimensionCount; d++)
+				parameters.*Dimensions[d].field = std::normal_distribution<float>(mean[d], deviation[d])(random);
+			candidates.push_back({ Clamped(parameters), {}, 0, 0 });
+		}
+		EvaluateAll(candidates, first, sessions, referenceReachPixels, threadCount);
+	}
+}
+
+// Reaches with a small overshoot and correction, tremor during holds and the odd middle press
+static std::vector<Session::Sample> Synthesize(uint32_t seed)
+{
+	std::mt19937 random(seed);
+	std::uniform_real_distribution<double> amplitude(4, 30); // degrees
+	std::uniform_real_distribution<double> angle(0, 2 * Pi);
+	std::uniform_real_distribution<double> duration(0.3, 0.7);
+	std::uniform_real_distribution<double> hold(0.3, 1.0);
+	std::uniform_real_distribution<double> overshoot(0.0, 0.15);
+	std::uniform_real_distribution<double> unit(0, 1);
+	std::normal_distribution<double> noise(0, 0.6); // degrees per second
+
+	auto dt = 1 / SyntheticRateHz;
+	auto range = (float)RemoteControl::DefaultGyroRange;
+	std::vector<Session::Sample> samples;
+
+	auto emit = [&](double pitchRate, double rollRate, double yawRate, uint8_t buttons) {
+		auto t = samples.size() * dt;
+		auto tremor = 0.8 * std::sin(2 * Pi * 9 * t); // physiological tremor around 9 Hz
+		auto raw = [range](double rate) { return (int16_t)std::clamp(std::lround(rate / range * INT16_MAX), (long)-INT16_MAX, (long)INT16_MAX); };
+		Session::Sample sample{};
+		sample.timestampNs = (int64_t)(t * 1e9);
+		sample.gyro = { raw(pitchRate + tremor + noise(random)), raw(rollRate + noise(random)), raw(yawRate + tremor * 0.7 + noise(random)) };
+		sample.gyroRange = RemoteControl::DefaultGyroRange;
+		sample.buttons = buttons;
+		sample.format = PacketFormat::Standard;
+		samples.push_back(sample);
+	};
+
+	// Minimum jerk velocity profile covering the given angles
+	auto move = [&](double pitch, double roll, double yaw, double seconds, uint8_t buttons) {
+		auto steps = (int)(seconds * SyntheticRateHz);
+		for (int i = 0; i < steps; i++)
+		{
+			auto s = (i + 0.5) / steps;
+			auto speed = 30 * s * s * (1 - s) * (1 - s) / seconds;
+			emit(pitch * speed, roll * speed, yaw * speed, buttons);
+		}
+	};
+
+	while (samples.size() * dt < SyntheticSeconds)
+	{
+		auto size = amplitude(random), direction = angle(random), excess = overshoot(random);
+		auto yaw = size * std::cos(direction), pitch = size * std::sin(direction);
+
+		auto kind = unit(random);
+		if (kind < 0.1) move(pitch * 0.1, 40, yaw * 0.1, 0.6, Input::MiddleMask); // scroll
+		else if (kind < 0.2) move(pitch, 0, yaw, duration(random), Input::MiddleMask); // drag
+		else
+		{
+			move(pitch * (1 + excess), 0, yaw * (1 + excess), duration(random), 0);
+			move(-pitch * excess, 0, -yaw * excess, 0.25, 0); // correction
+		}
+
+		for (auto steps = (int)(hold(random) * SyntheticRateHz); steps > 0; steps--) emit(0, 0, 0, 0);
+	}
+	return samples;
+}
+
+static void PrintCandidate(int rank, const Candidate& candidate)
+{
+	auto& o = candidate.objectives;
+	printf("%4d %8.3f %7.2f %6.2f %6.2f %6.1f %10.3f %10.3f %8.3f %6.2f %5d/%-5d\n", rank, candidate.score,
+		candidate.parameters.mouseSensitivity, candidate.parameters.mousePowerFactor, candidate.parameters.mouseDeadZone,
+		candidate.parameters.dragTolerance,
+		o.reachCount ? o.overshoot / o.reachCount : 0, o.reachCount ? o.efficiency / o.reachCount : 0,
+		o.holdCount ? std::sqrt(o.jitterSquared / o.holdCount) : 0, candidate.gain, o.misclassified, o.pressCount);
+}
+
+static bool WriteProfile(const char* path, const std::vector<Candidate>& ranked, int top)
+{
+	auto file = std::fopen(path, "w");
+	if (!file) return false;
+
+	fprintf(file, "# Written by ResponseTuner. Ranked candidates, best first:\n");
+	for (int rank = 0; rank < top && rank < (int)ranked.size(); rank++)
+	{
+		fprintf(file, "#  %d score %.4f:", rank + 1, ranked[(size_t)rank].score);
+		for (auto& dimension : Dimensions) fprintf(file, " %s=%g", dimension.key, ranked[(size_t)rank].parameters.*dimension.field);
+		fprintf(file, "\n");
+	}
+	for (auto& dimension : Dimensions) fprintf(file, "%s = %g\n", dimension.key, ranked.front().parameters.*dimension.field);
+	return std::fclose(file) == 0;
+}
+
+int main(int argc, char* argv[])
+{
+	std::string search = "es", outputPath, synthesizePath;
+	int budget = 2000, threadCount = (int)std::max(1u, std::thread::hardware_concurrency()), top = 10;
+	uint32_t seed = 1;
+	bool isScaling = false;
+	std::vector<std::string> paths;
+
+	for (int i = 1; i < argc; i++)
+	{
+		auto hasValue = i + 1 < argc;
+		if (std::strcmp(argv[i], "--search") == 0 && hasValue) search = argv[++i];
+		else if (std::strcmp(argv[i], "--candidates") == 0 && hasValue) budget = std::max(1, std::atoi(argv[++i]));
+		else if (std::strcmp(argv[i], "--threads") == 0 && hasValue) threadCount = std::max(1, std::atoi(argv[++i]));
+		else if (std::strcmp(argv[i], "--seed") == 0 && hasValue) seed = (uint32_t)std::atoi(argv[++i]);
+		else if (std::strcmp(argv[i], "--top") == 0 && hasValue) top = std::max(1, std::atoi(argv[++i]));
+		else if (std::strcmp(argv[i], "--output") == 0 && hasValue) outputPath = argv[++i];
+		else if (std::strcmp(argv[i], "--synthesize") == 0 && hasValue) synthesizePath = argv[++i];
+		else if (std::strcmp(argv[i], "--scaling") == 0) isScaling = true;
+		else if (argv[i][0] == '-')
+		{
+			fprintf(stderr, "Unknown option %s\n", argv[i]);
+			return 2;
+		}
+		else paths.push_back(argv[i]);
+	}
+	if (search != "grid" && search != "random" && search != "es")
+	{
+		fprintf(stderr, "Search must be grid, random or es\n");
+		return 2;
+	}
+
+	std::vector<PreparedSession> sessions;
+	for (auto& path : paths)
+	{
+		std::vector<Session::Sample> samples;
+		if (!Session::Load(path.c_str(), samples))
+		{
+			fprintf(stderr, "%s is not a session file\n", path.c_str());
+			return 1;
+		}
+		sessions.push_back(Prepare(path, samples));
+	}
+	if (sessions.empty())
+	{
+		auto samples = Synthesize(seed);
+		if (!synthesizePath.empty() && !Session::Save(synthesizePath.c_str(), samples))
+		{
+			fprintf(stderr, "Could not write %s\n", synthesizePath.c_str());
+			return 1;
+		}
+		sessions.push_back(Prepare("synthetic", samples));
+	}
+
+	size_t sampleCount = 0;
+	for (auto& session : sessions)
+	{
+		printf("%-24s %8zu samples %5zu reaches %6zu hold samples %4zu middle presses\n", session.name.c_str(),
+			session.rates.size(), session.reaches.size(), session.holds.size(), session.presses.size());
+		sampleCount += session.rates.size();
+	}
+
+	// Sessions are assumed to be recorded with the default curve, which anchors the gain objective
+	Objectives reference;
+	for (auto& session : sessions) Evaluate(Input::DefaultResponseCurve, session, reference);
+
+	std::mt19937 random(seed);
+	std::vector<Candidate> candidates;
+	auto start = Clock::now();
+	if (search == "es") RunEvolution(candidates, budget, random, sessions, reference.reachPixels, threadCount);
+	else
+	{
+		if (search == "grid") AddGrid(candidates, budget);
+		else AddRandom(candidates, budget, random);
+		EvaluateAll(candidates, 0, sessions, reference.reachPixels, threadCount);
+	}
+	auto seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+	Candidate defaults{ Input::DefaultResponseCurve, reference };
+	Score(defaults, reference.reachPixels);
+	std::sort(candidates.begin(), candidates.end(), [](const Candidate& a, const Candidate& b) { return a.score < b.score; });
+
+	printf("\n%s search, %zu candidates on %d threads in %.2f s (%.1f M samples/s)\n\n", search.c_str(), candidates.size(),
+		threadCount, seconds, candidates.size() * sampleCount / seconds / 1e6);
+	printf("%4s %8s %7s %6s %6s %6s %10s %10s %8s %6s %11s\n", "rank", "score", "sens", "power", "dead", "drag",
+		"overshoot", "efficiency", "jitter", "gain", "gestures");
+	for (int rank = 0; rank < top && rank < (int)candidates.size(); rank++) PrintCandidate(rank + 1, candidates[(size_t)rank]);
+	printf("\n");
+	PrintCandidate(0, defaults);
+	printf("(rank 0 is Input::DefaultResponseCurve)\n");
+
+	if (!outputPath.empty())
+	{
+		if (!WriteProfile(outputPath.c_str(), candidates, top))
+		{
+			fprintf(stderr, "Could not write %s\n", outputPath.c_str());
+			return 1;
+		}
+		printf("\nBest candidate written to %s\n", outputPath.c_str());
+	}
+
+	if (isScaling)
+	{
+		// The same random batch at each thread count
+		std::vector<Candidate> batch;
+		std::mt19937 batchRandom(seed);
+		AddRandom(batch, budget, batchRandom);
+
+		printf("\n%8s %10s %9s %11s\n", "threads", "seconds", "speedup", "efficiency");
+		std::vector<int> threadCounts;
+		for (int threads = 1; threads < threadCount; threads *= 2) threadCounts.push_back(threads);
+		threadCounts.push_back(threadCount);
+
+		double baseline = 0;
+		for (auto threads : threadCounts)
+		{
+			auto batchStart = Clock::now();
+			EvaluateAll(batch, 0, sessions, reference.reachPixels, threads);
+			auto batchSeconds = std::chrono::duration<double>(Clock::now() - batchStart).count();
+			if (threads == 1) baseline = batchSeconds;
+			printf("%8d %10.3f %8.2fx %10.0f%%\n", threads, batchSeconds, baseline / batchSeconds, 100 * baseline / batchSeconds / threads);
+		}
+	}
+
+	return 0;
+}
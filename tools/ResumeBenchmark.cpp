@@ -0,0 +1,206 @@
+// Measures how soon the cursor moves correctly again after the link to the remote drops and
+// returns, with and without Pipeline::KeepSnapshots. The remote streams extended packets at 200 Hz
+// and 1000 dps, set up the way Input's usage modes do, and keeps that configuration through the
+// dropout, as the firmware does. Host commands reach it one connection interval after they are
+// written, and its answers come back in the next notification.
+//
+// Each run is compared against a reference that loses the same notifications without noticing a
+// disconnect, so the pipeline keeps everything it knew. A move is correct when it matches the
+// reference's move over the same connection interval to within a pixel. Reported per gap: the
+// time from the first notification after the reconnect until every later move is correct, and how
+// far the incorrect moves in the first second strayed from the reference's.
+//
+// Linux: g++ -std=c++17 -O2 -I../src ResumeBenchmark.cpp ../src/PipelineSnapshot.cpp ../src/SimulatedRemote.cpp
+//            ../src/RemoteControl.cpp ../src/PacketParser.cpp ../src/CircularBuffer.cpp ../src/Input.cpp
+//            ../src/PointerOutput.cpp ../src/IdleDetector.cpp ../src/OrientationFilter.cpp ../src/MotionPredictor.cpp
+//            ../src/GyroHistory.cpp ../src/Logger.cpp ../src/Metrics.cpp ../src/NetworkOutput.cpp
+//            ../src/PacketBroadcast.cpp ../src/Trace.cpp ../src/PlotFeed.cpp ../src/ResponseCurve.cpp
+//            ../src/ButtonMapper.cpp ../src/ClickStabilizer.cpp ../src/Startup.cpp ../src/ProcessInfo.cpp
+//            -o ResumeBenchmark -lrt -pthread
+
+#include "CircularBuffer.h"
+#include "Input.h"
+#include "Logger.h"
+#include "PacketParser.h"
+#include "Pipeline.h"
+#include "PointerOutput.h"
+#include "RemoteControl.h"
+#include "SimulatedRemote.h"
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <functional>
+#include <string>
+#include <thread>
+#include <vector>
+
+using Clock = std::chrono::steady_clock;
+
+static constexpr auto Pi = 3.14159265358979;
+static constexpr auto ConnectionIntervalMs = 15;
+static constexpr auto SampleRateHz = 200;
+static constexpr uint16_t GyroRange = 1000;
+static constexpr auto ConfigureMs = 300; // once the parser has locked onto the stream
+static constexpr auto DropMs = 3000;
+static constexpr auto ComparedMs = 1000; // after the link returns
+static constexpr auto TolerancePixels = 1.5f; // both coordinates may round the other way
+static const int GapsMs[] = { 60, 300, 2000 };
+
+// What Pipeline::Connect and KeepSnapshots need from a transport, driven synchronously
+struct ResumeTransport
+{
+	std::function<void()> Connected;
+	std::function<void()> Disconnected;
+	std::function<void()> ReceivedData;
+
+	CircularBuffer buffer;
+	SimulatedRemote* remote = nullptr;
+	bool isLinkUp = true; // the remote's radio drops what it cannot send
+	std::vector<std::array<uint8_t, sizeof(RemoteControl::CommandFrame)>> writes; // in flight to the remote
+
+	bool Write(const uint8_t* data, size_t length)
+	{
+		if (length != sizeof(RemoteControl::CommandFrame)) return false;
+		writes.emplace_back();
+		std::copy(data, data + length, writes.back().begin());
+		return true;
+	}
+
+	std::string DeviceId() const
+	{
+		return "benchmark";
+	}
+
+	// At a connection event: commands written since the last one reach the remote
+	void DeliverWrites()
+	{
+		for (auto& frame : writes) remote->Receive(frame.data(), frame.size());
+		writes.clear();
+	}
+};
+
+// Circles, so the cursor keeps moving in every connection interval without reaching an edge
+static Vector3 HandRates(double t)
+{
+	return { (float)(20 * std::sin(2 * Pi * 0.5 * t)), 0, (float)(20 * std::cos(2 * Pi * 0.5 * t)) };
+}
+
+enum class Mode
+{
+	Reference, // notifications lost, the link never drops
+	Reconnect,
+	Snapshot // reconnect with KeepSnapshots
+};
+
+struct Point
+{
+	float x;
+	float y;
+};
+
+// Cursor position after every connection event from the first one after the gap
+static std::vector<Point> Run(Mode mode, int gapMs)
+{
+	ResumeTransport transport;
+	SimulatedRemote remote([&transport](const uint8_t* data, size_t length) {
+		if (transport.isLinkUp) transport.buffer.WriteBuffer(data, (int)length);
+	}, 1);
+	transport.remote = &remote;
+	RemoteControl::Controller remoteControl([&transport](const uint8_t* data, size_t length) { return transport.Write(data, length); });
+
+	PointerOutput::Move(PointerOutput::ScreenWidth() / 2.0f, PointerOutput::ScreenHeight() / 2.0f);
+	Input::Initialize();
+	Pipeline::Connect(transport, remoteControl);
+	if (mode == Mode::Snapshot) Pipeline::KeepSnapshots(transport, remoteControl);
+	Input::UsageModeRequested = nullptr; // the configuration is set below
+	PacketParser::ResetDataAlignment();
+
+	transport.Connected();
+
+	std::vector<Point> path;
+	double sampleTime = 0;
+	Clock::time_point resumedAt;
+	auto resumeMs = DropMs + gapMs;
+	for (int eventMs = ConnectionIntervalMs; eventMs < resumeMs + ComparedMs; eventMs += ConnectionIntervalMs)
+	{
+		transport.isLinkUp = eventMs <= DropMs || eventMs > resumeMs;
+		// RemoteControl retransmits on the wall clock, so the compared second runs in real time
+		if (eventMs == resumeMs + ConnectionIntervalMs) resumedAt = Clock::now();
+		if (eventMs > resumeMs) std::this_thread::sleep_until(resumedAt + std::chrono::milliseconds(eventMs - resumeMs - ConnectionIntervalMs));
+		if (eventMs == ConfigureMs)
+		{
+			remoteControl.SetSampleRate(SampleRateHz);
+			remoteControl.SetGyroRange(GyroRange);
+		}
+		if (mode != Mode::Reference && eventMs > DropMs && eventMs - ConnectionIntervalMs <= DropMs) transport.Disconnected();
+		if (mode != Mode::Reference && eventMs > resumeMs && eventMs - ConnectionIntervalMs <= resumeMs) transport.Connected();
+
+		if (transport.isLinkUp) transport.DeliverWrites();
+		else transport.writes.clear();
+		for (; sampleTime <= eventMs / 1000.0; sampleTime += 1.0 / remote.Configuration().sampleRateHz)
+		{
+			remote.Step(HandRates(sampleTime), 0);
+		}
+		if (!transport.isLinkUp) continue;
+
+		transport.ReceivedData();
+		remoteControl.CheckTimeouts();
+
+		if (eventMs <= resumeMs) continue;
+		float x, y;
+		PointerOutput::CursorPosition(x, y);
+		path.push_back({ x, y });
+	}
+
+	transport.Disconnected();
+	PacketParser::SetBuffer(nullptr);
+	return path;
+}
+
+struct Result
+{
+	double correctAfterMs; // from the first notification after the reconnect, ComparedMs if never
+	double strayPixels; // summed over the moves that were not correct
+};
+
+static Result Compare(const std::vector<Point>& path, const std::vector<Point>& reference)
+{
+	Result result{ 0, 0 };
+	auto count = std::min(path.size(), reference.size());
+	for (size_t i = 1; i < count; i++)
+	{
+		auto errorX = (path[i].x - path[i - 1].x) - (reference[i].x - reference[i - 1].x);
+		auto errorY = (path[i].y - path[i - 1].y) - (reference[i].y - reference[i - 1].y);
+		auto error = std::hypot(errorX, errorY);
+		if (error <= TolerancePixels) continue;
+		result.strayPixels += error;
+		result.correctAfterMs = i + 1 == count ? ComparedMs : (double)i * ConnectionIntervalMs;
+	}
+	return result;
+}
+
+int main()
+{
+	Logger::MinimumLevel = Logger::Level::Error;
+
+	printf("remote at %d Hz, %d dps, extended packets; %d ms connection interval\n\n", SampleRateHz, GyroRange, ConnectionIntervalMs);
+	printf("%8s %22s %22s\n", "", "reconnect", "with snapshot");
+	printf("%8s %11s %10s %11s %10s\n", "gap ms", "correct ms", "stray px", "correct ms", "stray px");
+
+	auto isFaster = true;
+	for (auto gapMs : GapsMs)
+	{
+		auto reference = Run(Mode::Reference, gapMs);
+		auto reconnect = Compare(Run(Mode::Reconnect, gapMs), reference);
+		auto snapshot = Compare(Run(Mode::Snapshot, gapMs), reference);
+		isFaster &= snapshot.correctAfterMs < reconnect.correctAfterMs;
+
+		printf("%8d %11.0f %10.1f %11.0f %10.1f\n", gapMs, reconnect.correctAfterMs, reconnect.strayPixels,
+			snapshot.correctAfterMs, snapshot.strayPixels);
+	}
+
+	printf("\nsnapshot correct sooner every time: %s\n", isFaster ? "yes" : "NO");
+	return isFaster ? 0 : 1;
+}
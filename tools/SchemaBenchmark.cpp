@@ -0,0 +1,163 @@
+// Checks the decoders generated from PacketSchema layouts against hand-written ones and compares
+// their speed. Besides the two shipped layouts it uses a made up firmware layout with the
+// signature first, the axes reordered and the buttons on different bits, to exercise remapping.
+//
+// Linux: g++ -std=c++17 -O2 -I../src SchemaBenchmark.cpp -o SchemaBenchmark
+
+#include "PacketSchema.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <vector>
+
+static constexpr auto FrameCount = 1 << 16;
+static constexpr auto Passes = 50;
+static constexpr auto Repeats = 5;
+static constexpr uint32_t Seed = 99;
+
+// Signature byte first, then Z, X, Y, then a button byte with left, right and middle on bits 4..6
+inline constexpr PacketSchema::Layout Reordered{
+	8,
+	{ 3, 5, 1 },
+	{ PacketSchema::Absent, PacketSchema::Absent, PacketSchema::Absent },
+	0, 0b01010000, 0b11110000,
+	7, 1 << 5, 1 << 4, 1 << 6,
+	7
+};
+
+// Layouts the schema must refuse
+inline constexpr PacketSchema::Layout OverlappingButtons{
+	7, { 0, 2, 4 }, { -1, -1, -1 }, 6, 0b10101000, 0b11111000, 6, 1 << 0, 1 << 0, 1 << 2, 6
+};
+inline constexpr PacketSchema::Layout ButtonsOnSignature{
+	7, { 0, 2, 4 }, { -1, -1, -1 }, 6, 0b10101000, 0b11111000, 6, 1 << 3, 1 << 1, 1 << 2, 6
+};
+inline constexpr PacketSchema::Layout FieldOutsideFrame{
+	7, { 0, 2, 6 }, { -1, -1, -1 }, 6, 0b10101000, 0b11111000, 6, 1 << 0, 1 << 1, 1 << 2, 6
+};
+static_assert(PacketSchema::IsConsistent(Reordered), "Reordered layout should be accepted");
+static_assert(!PacketSchema::IsConsistent(OverlappingButtons), "Overlapping buttons should be rejected");
+static_assert(!PacketSchema::IsConsistent(ButtonsOnSignature), "Buttons on signature bits should be rejected");
+static_assert(!PacketSchema::IsConsistent(FieldOutsideFrame), "Fields past the frame should be rejected");
+
+// What the parser did before the schema: copy the packed struct
+static ExtendedPacket HandDecodeStandard(const uint8_t* frame)
+{
+	Packet standard;
+	std::memcpy(&standard, frame, sizeof(Packet));
+
+	ExtendedPacket packet;
+	packet.Gyro = standard.Gyro;
+	packet.Accel = { 0, 0, 0 };
+	packet.ButtonData = standard.ButtonData & PacketSchema::ButtonMask;
+	return packet;
+}
+
+static ExtendedPacket HandDecodeExtended(const uint8_t* frame)
+{
+	ExtendedPacket packet;
+	std::memcpy(&packet, frame, sizeof(ExtendedPacket));
+	packet.ButtonData &= PacketSchema::ButtonMask;
+	return packet;
+}
+
+static int16_t Read16(const uint8_t* frame, int offset)
+{
+	int16_t value;
+	std::memcpy(&value, frame + offset, sizeof(value));
+	return value;
+}
+
+static ExtendedPacket HandDecodeReordered(const uint8_t* frame)
+{
+	ExtendedPacket packet;
+	packet.Gyro = { Read16(frame, 3), Read16(frame, 5), Read16(frame, 1) };
+	packet.Accel = { 0, 0, 0 };
+	auto buttons = frame[7]; // right, left and middle on bits 5, 4 and 6
+	packet.ButtonData = (uint8_t)((buttons >> 5 & 1) | (buttons >> 3 & 2) | (buttons >> 4 & 4));
+	return packet;
+}
+
+static bool Equal(const ExtendedPacket& a, const ExtendedPacket& b)
+{
+	return a.Gyro.X == b.Gyro.X && a.Gyro.Y == b.Gyro.Y && a.Gyro.Z == b.Gyro.Z
+		&& a.Accel.X == b.Accel.X && a.Accel.Y == b.Accel.Y && a.Accel.Z == b.Accel.Z
+		&& a.ButtonData == b.ButtonData;
+}
+
+template <typename DecodeFunction>
+static double TimeDecode(const std::vector<uint8_t>& frames, int frameSize, DecodeFunction decode, int64_t& checksum)
+{
+	auto start = std::chrono::steady_clock::now();
+	for (int pass = 0; pass < Passes; pass++)
+	{
+		for (int i = 0; i < FrameCount; i++)
+		{
+			auto packet = decode(&frames[(size_t)i * frameSize]);
+			checksum += packet.Gyro.X + packet.Gyro.Y * 3 + packet.Gyro.Z * 5 + packet.Accel.X + packet.ButtonData;
+		}
+	}
+	auto seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	return seconds * 1e9 / ((double)FrameCount * Passes);
+}
+
+template <const PacketSchema::Layout& layout, typename HandDecode>
+static bool Run(const char* name, HandDecode handDecode)
+{
+	using Decoder = PacketSchema::Decoder<layout>;
+
+	std::mt19937 random(Seed);
+	std::uniform_int_distribution<int> value(INT16_MIN, INT16_MAX);
+	std::vector<ExtendedPacket> packets(FrameCount);
+	std::vector<uint8_t> frames((size_t)FrameCount * Decoder::FrameSize);
+
+	for (int i = 0; i < FrameCount; i++)
+	{
+		auto& packet = packets[i];
+		packet.Gyro = { (int16_t)value(random), (int16_t)value(random), (int16_t)value(random) };
+		packet.Accel = Decoder::HasAccel ? Vector3Int16{ (int16_t)value(random), (int16_t)value(random), (int16_t)value(random) } : Vector3Int16{ 0, 0, 0 };
+		packet.ButtonData = (uint8_t)(value(random) & PacketSchema::ButtonMask);
+		Decoder::Encode(packet, &frames[(size_t)i * Decoder::FrameSize]);
+	}
+
+	// Round trip, agreement with the hand-written decoder, and the validator on good and bad frames
+	auto isCorrect = true;
+	for (int i = 0; i < FrameCount; i++)
+	{
+		auto frame = &frames[(size_t)i * Decoder::FrameSize];
+		isCorrect &= Decoder::IsValid(frame) && !Decoder::IsControlResponse(frame);
+		isCorrect &= Equal(Decoder::Decode(frame), packets[i]) && Equal(handDecode(frame), packets[i]);
+
+		uint8_t corrupted[PacketSchema::MaxFrameSize];
+		std::memcpy(corrupted, frame, Decoder::FrameSize);
+		corrupted[layout.signatureOffset] ^= (uint8_t)(layout.signatureMask & -layout.signatureMask); // lowest signature bit
+		isCorrect &= !Decoder::IsValid(corrupted);
+	}
+
+	// Alternating, best of several, and through lambdas so that both sides can be inlined
+	int64_t handChecksum = 0, generatedChecksum = 0;
+	double handNs = 1e9, generatedNs = 1e9;
+	for (int repeat = 0; repeat < Repeats; repeat++)
+	{
+		handNs = std::min(handNs, TimeDecode(frames, Decoder::FrameSize, [handDecode](const uint8_t* frame) { return handDecode(frame); }, handChecksum));
+		generatedNs = std::min(generatedNs, TimeDecode(frames, Decoder::FrameSize, [](const uint8_t* frame) { return Decoder::Decode(frame); }, generatedChecksum));
+	}
+	isCorrect &= handChecksum == generatedChecksum;
+
+	printf("%-10s %6d %14.2f %14.2f %8.2fx %8s\n", name, Decoder::FrameSize, handNs, generatedNs, generatedNs / handNs, isCorrect ? "yes" : "NO");
+	return isCorrect;
+}
+
+int main()
+{
+	printf("%d frames decoded %d times per layout, best of %d\n\n", FrameCount, Passes, Repeats);
+	printf("%-10s %6s %14s %14s %9s %8s\n", "layout", "bytes", "hand ns", "generated ns", "ratio", "correct");
+
+	auto isCorrect = Run<PacketSchema::Standard>("standard", [](const uint8_t* frame) { return HandDecodeStandard(frame); });
+	isCorrect &= Run<PacketSchema::Extended>("extended", [](const uint8_t* frame) { return HandDecodeExtended(frame); });
+	isCorrect &= Run<Reordered>("reordered", [](const uint8_t* frame) { return HandDecodeReordered(frame); });
+
+	return isCorrect ? 0 : 1;
+}
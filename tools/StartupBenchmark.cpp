@@ -0,0 +1,119 @@
+// Starts the daemon over and over and reports how long its startup milestones took, as it logs
+// them: time to scan (the transport looks for the remote), time to ready (the control endpoint is
+// up) and time to first packet (the first packet reached Input). This is the part of the tray
+// build's startup that does not involve Qt; the tray build logs time to tray as well.
+//
+// Each run waits for the first packet, then stops the daemon with SIGTERM. With the simulated
+// remote the first packet also waits for the parser to realign on extended frames.
+//
+// Linux: g++ -std=c++17 -O2 -I../src StartupBenchmark.cpp -o StartupBenchmark
+// Usage: StartupBenchmark path/to/GestureDaemon [runs]
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <signal.h>
+#include <string>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <vector>
+
+static constexpr auto DefaultRuns = 20;
+
+struct Milestones
+{
+	long long scanUs = -1;
+	long long readyUs = -1;
+	long long firstPacketUs = -1;
+};
+
+// Value of the first "<label> N us" in line, or -1
+static long long Microseconds(const char* line, const char* label)
+{
+	auto found = std::strstr(line, label);
+	if (!found) return -1;
+	return std::strtoll(found + std::strlen(label), nullptr, 10);
+}
+
+static bool Run(const char* daemonPath, Milestones& milestones)
+{
+	int output[2];
+	if (pipe(output) != 0) return false;
+
+	auto child = fork();
+	if (child < 0) return false;
+	if (child == 0)
+	{
+		dup2(output[1], STDOUT_FILENO);
+		dup2(output[1], STDERR_FILENO);
+		close(output[0]);
+		close(output[1]);
+		execl(daemonPath, daemonPath, "--simulate", (char*)nullptr);
+		_exit(127);
+	}
+
+	close(output[1]);
+	auto log = fdopen(output[0], "r");
+	char line[512];
+	while (milestones.firstPacketUs < 0 && std::fgets(line, sizeof(line), log))
+	{
+		auto value = Microseconds(line, "Time to scan: ");
+		if (value >= 0) milestones.scanUs = value;
+		value = Microseconds(line, "Ready in ");
+		if (value >= 0) milestones.readyUs = value;
+		value = Microseconds(line, "Time to first packet: ");
+		if (value >= 0) milestones.firstPacketUs = value;
+	}
+
+	kill(child, SIGTERM);
+	while (std::fgets(line, sizeof(line), log)) {} // until it exits and closes its end
+	std::fclose(log);
+	int status = 0;
+	waitpid(child, &status, 0);
+	return milestones.scanUs >= 0 && milestones.readyUs >= 0 && milestones.firstPacketUs >= 0;
+}
+
+static long long Percentile(std::vector<long long> values, double fraction)
+{
+	std::sort(values.begin(), values.end());
+	return values[std::min(values.size() - 1, (size_t)(fraction * values.size()))];
+}
+
+int main(int argc, char* argv[])
+{
+	if (argc < 2)
+	{
+		printf("usage: %s path/to/GestureDaemon [runs]\n", argv[0]);
+		return 1;
+	}
+	auto runs = argc > 2 ? std::atoi(argv[2]) : DefaultRuns;
+
+	std::vector<long long> scan, ready, firstPacket;
+	for (int i = 0; i < runs; i++)
+	{
+		Milestones milestones;
+		if (!Run(argv[1], milestones))
+		{
+			printf("run %d did not log every milestone\n", i + 1);
+			return 1;
+		}
+		scan.push_back(milestones.scanUs);
+		ready.push_back(milestones.readyUs);
+		firstPacket.push_back(milestones.firstPacketUs);
+	}
+
+	printf("%d runs of %s --simulate\n\n", runs, argv[1]);
+	printf("%14s %10s %10s %10s\n", "", "p50 us", "p90 us", "max us");
+	auto print = [](const char* name, const std::vector<long long>& values) {
+		printf("%14s %10lld %10lld %10lld\n", name, Percentile(values, 0.5), Percentile(values, 0.9), Percentile(values, 1));
+	};
+	print("scan", scan);
+	print("ready", ready);
+	print("first packet", firstPacket);
+
+	auto isScanFirst = true;
+	for (int i = 0; i < runs; i++) isScanFirst &= scan[i] <= ready[i];
+	printf("\nscanning started before the control endpoint was up every time: %s\n", isScanFirst ? "yes" : "NO");
+	return isScanFirst ? 0 : 1;
+}